@@ -0,0 +1,617 @@
+/*
+ * tkCanvAnimate.c --
+ *
+ *	This module implements the "animate" widget command that moves
+ *	numeric style options of items towards new values over time. The
+ *	values are interpolated here and written straight into the item
+ *	records from a timer, once per frame for all running animations,
+ *	so no script runs per step and all damage of a frame is redrawn
+ *	together.
+ *
+ * Copyright (c) 2026  tkpath contributors
+ *
+ * $Id$
+ */
+
+#include "tkIntPath.h"
+#include "tkpCanvas.h"
+#include "tkCanvPathUtil.h"
+
+/*
+ * The animated values are kept in an array of doubles.
+ */
+
+enum {
+    ANIM_FILL_OPACITY,
+    ANIM_STROKE_OPACITY,
+    ANIM_STROKE_WIDTH,
+    ANIM_MATRIX,		/* a b c d tx ty */
+    ANIM_NUM_VALUES = ANIM_MATRIX + 6
+};
+
+#define ANIM_MASK_FILL_OPACITY	    (1L << 0)
+#define ANIM_MASK_STROKE_OPACITY    (1L << 1)
+#define ANIM_MASK_STROKE_WIDTH	    (1L << 2)
+#define ANIM_MASK_MATRIX	    (1L << 3)
+
+/*
+ * These change the bounding box of an item.
+ */
+
+#define ANIM_MASK_GEOMETRY	(ANIM_MASK_STROKE_WIDTH|ANIM_MASK_MATRIX)
+
+#define ANIM_FRAME_MS	16	/* Step interval when -maxfps is not set. */
+
+enum {
+    EASE_LINEAR, EASE_IN, EASE_OUT, EASE_IN_OUT
+};
+
+typedef struct AnimItem {
+    int id;			/* Item id; the item may be gone. */
+    int mask;			/* Values still animated for this item. */
+    double from[ANIM_NUM_VALUES];
+} AnimItem;
+
+/*
+ * One animate command. Its items share the targets and timing.
+ */
+
+struct TkPathAnimation {
+    struct TkPathAnimation *nextPtr;
+    Tcl_Time start;
+    long duration;		/* Milliseconds. */
+    int easing;
+    Tcl_Obj *commandObj;	/* Script run when done, or NULL. */
+    double to[ANIM_NUM_VALUES];
+    int numItems;
+    AnimItem items[1];		/* Actually numItems long. */
+};
+
+static CONST char *easingStrings[] = {
+    "linear", "ease-in", "ease-out", "ease-in-out", NULL
+};
+
+static void	AnimationFree(TkPathAnimation *animPtr);
+static void	AnimationTimerProc(ClientData clientData);
+static void	AnimSchedule(TkPathCanvas *canvasPtr);
+static void	AnimSetValues(TkPathCanvas *canvasPtr, Tk_PathItem *itemPtr,
+		    int mask, double *values);
+static void	AnimGetValues(Tk_PathItem *itemPtr, double *values);
+static void	AnimStopItem(TkPathCanvas *canvasPtr, int id, int mask);
+static int	AnimIsStyledItem(Tk_PathItem *itemPtr);
+
+/*
+ * The item types whose records start with a Tk_PathItemEx, which is
+ * where the animated values live. Others, such as pimage and the light
+ * items, are left alone.
+ */
+
+static Tk_PathItemType *animTypes[] = {
+    &tkCircleType, &tkCirclesType, &tkEllipseType, &tkGroupType,
+    &tkPathType, &tkPlineType, &tkPolylineType, &tkPpolygonType,
+    &tkPrectType, &tkPrectsType, &tkPtextType, &tkUseType, NULL
+};
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathCanvasAnimateCmd --
+ *
+ *	Implements
+ *	    'pathName animate tagOrId ?-duration ms? ?-easing name?
+ *		?-command script? option value ?option value ...?'
+ *	    'pathName animate cancel tagOrId'
+ *	The options that can be animated are -fillopacity, -strokeopacity,
+ *	-strokewidth and -matrix of the tkpath items that have their own
+ *	style. Other items matching tagOrId are left alone. An animation
+ *	replaces any earlier one of the same option on the same item.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	Items change over time.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkPathCanvasAnimateCmd(
+    TkPathCanvas *canvasPtr,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[])	/* Arguments, the first two are pathName
+				 * and "animate". */
+{
+    TkPathAnimation *animPtr;
+    Tk_PathItem **itemPtrs;
+    Tcl_Obj *tagObj, *listObj, **elemv;
+    double to[ANIM_NUM_VALUES];
+    int i, j, index, elemc, numItems, mask = 0;
+    int duration = 300, easing = EASE_LINEAR;
+    Tcl_Obj *commandObj = NULL;
+    static CONST char *optionStrings[] = {
+	"-command", "-duration", "-easing", "-fillopacity", "-matrix",
+	"-strokeopacity", "-strokewidth", NULL
+    };
+    enum options {
+	ANIM_COMMAND, ANIM_DURATION, ANIM_EASING, ANIM_FILLOPACITY,
+	ANIM_OPT_MATRIX, ANIM_STROKEOPACITY, ANIM_STROKEWIDTH
+    };
+
+    if (objc < 3) {
+	Tcl_WrongNumArgs(interp, 2, objv,
+		"tagOrId ?option value ...? | cancel tagOrId");
+	return TCL_ERROR;
+    }
+    memset(to, 0, sizeof(to));
+    if ((objc == 4) && (strcmp(Tcl_GetString(objv[2]), "cancel") == 0)) {
+	tagObj = objv[3];
+	mask = -1;
+    } else {
+	tagObj = objv[2];
+	if ((objc % 2) != 1) {
+	    Tcl_AppendResult(interp, "value for \"",
+		    Tcl_GetString(objv[objc-1]), "\" missing", NULL);
+	    return TCL_ERROR;
+	}
+	for (i = 3; i < objc; i += 2) {
+	    if (Tcl_GetIndexFromObj(interp, objv[i], optionStrings, "option",
+		    0, &index) != TCL_OK) {
+		return TCL_ERROR;
+	    }
+	    switch ((enum options) index) {
+	    case ANIM_COMMAND:
+		commandObj = objv[i+1];
+		break;
+	    case ANIM_DURATION:
+		if (Tcl_GetIntFromObj(interp, objv[i+1], &duration) != TCL_OK) {
+		    return TCL_ERROR;
+		}
+		break;
+	    case ANIM_EASING:
+		if (Tcl_GetIndexFromObj(interp, objv[i+1], easingStrings,
+			"easing", 0, &easing) != TCL_OK) {
+		    return TCL_ERROR;
+		}
+		break;
+	    case ANIM_FILLOPACITY:
+		if (Tcl_GetDoubleFromObj(interp, objv[i+1],
+			&to[ANIM_FILL_OPACITY]) != TCL_OK) {
+		    return TCL_ERROR;
+		}
+		mask |= ANIM_MASK_FILL_OPACITY;
+		break;
+	    case ANIM_OPT_MATRIX: {
+		TMatrix m;
+
+		if (PathGetTMatrix(interp, Tcl_GetString(objv[i+1]), &m)
+			!= TCL_OK) {
+		    return TCL_ERROR;
+		}
+		to[ANIM_MATRIX] = m.a, to[ANIM_MATRIX+1] = m.b;
+		to[ANIM_MATRIX+2] = m.c, to[ANIM_MATRIX+3] = m.d;
+		to[ANIM_MATRIX+4] = m.tx, to[ANIM_MATRIX+5] = m.ty;
+		mask |= ANIM_MASK_MATRIX;
+		break;
+	    }
+	    case ANIM_STROKEOPACITY:
+		if (Tcl_GetDoubleFromObj(interp, objv[i+1],
+			&to[ANIM_STROKE_OPACITY]) != TCL_OK) {
+		    return TCL_ERROR;
+		}
+		mask |= ANIM_MASK_STROKE_OPACITY;
+		break;
+	    case ANIM_STROKEWIDTH:
+		if (Tcl_GetDoubleFromObj(interp, objv[i+1],
+			&to[ANIM_STROKE_WIDTH]) != TCL_OK) {
+		    return TCL_ERROR;
+		}
+		mask |= ANIM_MASK_STROKE_WIDTH;
+		break;
+	    }
+	}
+	if (mask == 0) {
+	    Tcl_AppendResult(interp, "no option to animate", NULL);
+	    return TCL_ERROR;
+	}
+    }
+
+    /*
+     * Collect the items through the search of the find command, which
+     * also gives us the tag expression syntax.
+     */
+
+    listObj = Tcl_NewListObj(0, NULL);
+    Tcl_IncrRefCount(listObj);
+    if (TkPathCanvasFindWithTag(interp, canvasPtr, tagObj, listObj)
+	    != TCL_OK) {
+	Tcl_DecrRefCount(listObj);
+	return TCL_ERROR;
+    }
+    Tcl_ListObjGetElements(NULL, listObj, &elemc, &elemv);
+    itemPtrs = (Tk_PathItem **) ckalloc((elemc + 1) * sizeof(Tk_PathItem *));
+    for (i = 0, numItems = 0; i < elemc; i++) {
+	Tcl_HashEntry *hPtr;
+	Tk_PathItem *itemPtr;
+	int id;
+
+	Tcl_GetIntFromObj(NULL, elemv[i], &id);
+	hPtr = Tcl_FindHashEntry(&canvasPtr->idTable, (char *) INT2PTR(id));
+	if (hPtr == NULL) {
+	    continue;
+	}
+	itemPtr = (Tk_PathItem *) Tcl_GetHashValue(hPtr);
+	if (!AnimIsStyledItem(itemPtr)) {
+	    continue;
+	}
+	AnimStopItem(canvasPtr, id, mask);
+	itemPtrs[numItems++] = itemPtr;
+    }
+    Tcl_DecrRefCount(listObj);
+    if ((mask == -1) || (numItems == 0)) {
+	ckfree((char *) itemPtrs);
+	return TCL_OK;
+    }
+
+    animPtr = (TkPathAnimation *) ckalloc(sizeof(TkPathAnimation)
+	    + (numItems - 1) * sizeof(AnimItem));
+    Tcl_GetTime(&animPtr->start);
+    animPtr->duration = MAX(0, duration);
+    animPtr->easing = easing;
+    animPtr->commandObj = commandObj;
+    if (commandObj != NULL) {
+	Tcl_IncrRefCount(commandObj);
+    }
+    for (j = 0; j < ANIM_NUM_VALUES; j++) {
+	animPtr->to[j] = to[j];
+    }
+    animPtr->numItems = numItems;
+    for (i = 0; i < numItems; i++) {
+	animPtr->items[i].id = itemPtrs[i]->id;
+	animPtr->items[i].mask = mask;
+	AnimGetValues(itemPtrs[i], animPtr->items[i].from);
+    }
+    ckfree((char *) itemPtrs);
+    animPtr->nextPtr = canvasPtr->animPtr;
+    canvasPtr->animPtr = animPtr;
+    AnimSchedule(canvasPtr);
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathCanvasAnimateFree --
+ *
+ *	Stops all animations of a canvas, without running their
+ *	commands, when it is destroyed.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Memory freed.
+ *
+ *--------------------------------------------------------------
+ */
+
+void
+TkPathCanvasAnimateFree(
+    TkPathCanvas *canvasPtr)
+{
+    TkPathAnimation *animPtr, *nextPtr;
+
+    Tcl_DeleteTimerHandler(canvasPtr->animTimer);
+    canvasPtr->animTimer = NULL;
+    for (animPtr = canvasPtr->animPtr; animPtr != NULL; animPtr = nextPtr) {
+	nextPtr = animPtr->nextPtr;
+	AnimationFree(animPtr);
+    }
+    canvasPtr->animPtr = NULL;
+}
+
+static void
+AnimationFree(
+    TkPathAnimation *animPtr)
+{
+    if (animPtr->commandObj != NULL) {
+	Tcl_DecrRefCount(animPtr->commandObj);
+    }
+    ckfree((char *) animPtr);
+}
+
+static int
+AnimIsStyledItem(
+    Tk_PathItem *itemPtr)
+{
+    int i;
+
+    for (i = 0; animTypes[i] != NULL; i++) {
+	if (itemPtr->typePtr == animTypes[i]) {
+	    return 1;
+	}
+    }
+    return 0;
+}
+
+static void
+AnimSchedule(
+    TkPathCanvas *canvasPtr)
+{
+    int ms = ANIM_FRAME_MS;
+
+    if ((canvasPtr->animTimer != NULL) || (canvasPtr->animPtr == NULL)) {
+	return;
+    }
+    if (canvasPtr->maxFps > 0) {
+	ms = MAX(1, 1000 / canvasPtr->maxFps);
+    }
+    canvasPtr->animTimer = Tcl_CreateTimerHandler(ms, AnimationTimerProc,
+	    (ClientData) canvasPtr);
+}
+
+/*
+ * AnimStopItem --
+ *
+ *	Takes the values in mask of an item out of the running animations,
+ *	so that a new animation of them takes over from where they are.
+ *	Animations left with nothing to do are freed without running their
+ *	commands, since they were cancelled rather than finished.
+ */
+
+static void
+AnimStopItem(
+    TkPathCanvas *canvasPtr,
+    int id,
+    int mask)
+{
+    TkPathAnimation *animPtr, **prevPtrPtr;
+    int i, stopped, busy;
+
+    prevPtrPtr = &canvasPtr->animPtr;
+    while ((animPtr = *prevPtrPtr) != NULL) {
+	stopped = busy = 0;
+	for (i = 0; i < animPtr->numItems; i++) {
+	    if ((animPtr->items[i].id == id)
+		    && (animPtr->items[i].mask & mask)) {
+		animPtr->items[i].mask &= ~mask;
+		stopped = 1;
+	    }
+	    if (animPtr->items[i].mask != 0) {
+		busy = 1;
+	    }
+	}
+	if (stopped && !busy) {
+	    *prevPtrPtr = animPtr->nextPtr;
+	    AnimationFree(animPtr);
+	} else {
+	    prevPtrPtr = &animPtr->nextPtr;
+	}
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * AnimationTimerProc --
+ *
+ *	Steps all animations of a canvas to the current time. Finished
+ *	animations are removed and their commands run afterwards, in the
+ *	order they were started.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Items are changed and redrawn, scripts may run.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+AnimationTimerProc(
+    ClientData clientData)
+{
+    TkPathCanvas *canvasPtr = (TkPathCanvas *) clientData;
+    TkPathAnimation *animPtr, **prevPtrPtr, *donePtr = NULL;
+    Tcl_Interp *interp = canvasPtr->interp;
+    Tcl_Time now;
+    double values[ANIM_NUM_VALUES];
+    double t;
+    int i, j, busy;
+
+    canvasPtr->animTimer = NULL;
+    Tcl_GetTime(&now);
+    prevPtrPtr = &canvasPtr->animPtr;
+    while ((animPtr = *prevPtrPtr) != NULL) {
+	if (animPtr->duration > 0) {
+	    t = ((now.sec - animPtr->start.sec) * 1000.0
+		    + (now.usec - animPtr->start.usec) / 1000.0)
+		    / animPtr->duration;
+	    t = MAX(0.0, MIN(1.0, t));
+	} else {
+	    t = 1.0;
+	}
+	switch (animPtr->easing) {
+	case EASE_IN:
+	    t = t*t;
+	    break;
+	case EASE_OUT:
+	    t = 1.0 - (1.0 - t)*(1.0 - t);
+	    break;
+	case EASE_IN_OUT:
+	    t = (t < 0.5) ? 2.0*t*t : 1.0 - 2.0*(1.0 - t)*(1.0 - t);
+	    break;
+	}
+	busy = 0;
+	for (i = 0; i < animPtr->numItems; i++) {
+	    AnimItem *animItemPtr = animPtr->items + i;
+	    Tcl_HashEntry *hPtr;
+
+	    if (animItemPtr->mask == 0) {
+		continue;
+	    }
+	    hPtr = Tcl_FindHashEntry(&canvasPtr->idTable,
+		    (char *) INT2PTR(animItemPtr->id));
+	    if (hPtr == NULL) {
+		animItemPtr->mask = 0;
+		continue;
+	    }
+	    for (j = 0; j < ANIM_NUM_VALUES; j++) {
+		values[j] = animItemPtr->from[j]
+			+ t * (animPtr->to[j] - animItemPtr->from[j]);
+	    }
+	    AnimSetValues(canvasPtr, (Tk_PathItem *) Tcl_GetHashValue(hPtr),
+		    animItemPtr->mask, values);
+	    busy = 1;
+	}
+
+	/*
+	 * Time is checked rather than t since easing may reach 1 early.
+	 */
+
+	if (busy && ((now.sec - animPtr->start.sec) * 1000
+		+ (now.usec - animPtr->start.usec) / 1000 < animPtr->duration)) {
+	    prevPtrPtr = &animPtr->nextPtr;
+	} else {
+	    *prevPtrPtr = animPtr->nextPtr;
+	    animPtr->nextPtr = donePtr;
+	    donePtr = animPtr;
+	}
+    }
+    canvasPtr->flags |= REPICK_NEEDED;
+    AnimSchedule(canvasPtr);
+
+    /*
+     * The commands are run last since they may start new animations or
+     * destroy the canvas. The list is newest first, so reverse it.
+     */
+
+    animPtr = donePtr;
+    donePtr = NULL;
+    while (animPtr != NULL) {
+	TkPathAnimation *nextPtr = animPtr->nextPtr;
+
+	animPtr->nextPtr = donePtr;
+	donePtr = animPtr;
+	animPtr = nextPtr;
+    }
+    Tcl_Preserve((ClientData) interp);
+    for (animPtr = donePtr; animPtr != NULL; animPtr = donePtr) {
+	donePtr = animPtr->nextPtr;
+	if (animPtr->commandObj != NULL) {
+	    if (Tcl_EvalObjEx(interp, animPtr->commandObj, TCL_EVAL_GLOBAL)
+		    != TCL_OK) {
+		Tcl_AddErrorInfo(interp, "\n    (animation command)");
+		Tcl_BackgroundError(interp);
+	    }
+	}
+	AnimationFree(animPtr);
+    }
+    Tcl_Release((ClientData) interp);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * AnimGetValues, AnimSetValues --
+ *
+ *	Read and write the animated values of an item. Writing redraws
+ *	the item and, if its size may change, lets the item recompute its
+ *	bounding box, and those of the descendants of a group.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The item is changed.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+AnimGetValues(
+    Tk_PathItem *itemPtr,
+    double *values)
+{
+    Tk_PathStyle *stylePtr = &((Tk_PathItemEx *) itemPtr)->style;
+    TMatrix m = {1.0, 0.0, 0.0, 1.0, 0.0, 0.0};
+
+    if (stylePtr->matrixPtr != NULL) {
+	m = *stylePtr->matrixPtr;
+    }
+    values[ANIM_FILL_OPACITY] = stylePtr->fillOpacity;
+    values[ANIM_STROKE_OPACITY] = stylePtr->strokeOpacity;
+    values[ANIM_STROKE_WIDTH] = stylePtr->strokeWidth;
+    values[ANIM_MATRIX] = m.a, values[ANIM_MATRIX+1] = m.b;
+    values[ANIM_MATRIX+2] = m.c, values[ANIM_MATRIX+3] = m.d;
+    values[ANIM_MATRIX+4] = m.tx, values[ANIM_MATRIX+5] = m.ty;
+}
+
+static void
+AnimSetValues(
+    TkPathCanvas *canvasPtr,
+    Tk_PathItem *itemPtr,
+    int mask,
+    double *values)
+{
+    Tk_PathCanvas canvas = (Tk_PathCanvas) canvasPtr;
+    Tk_PathStyle *stylePtr = &((Tk_PathItemEx *) itemPtr)->style;
+    Tk_PathItem *walkPtr, *endPtr;
+
+    TkPathCanvasEventuallyRedrawItem(canvas, itemPtr);
+    if (mask & ANIM_MASK_FILL_OPACITY) {
+	stylePtr->fillOpacity =
+		MAX(0.0, MIN(1.0, values[ANIM_FILL_OPACITY]));
+	stylePtr->mask |= PATH_STYLE_OPTION_FILL_OPACITY;
+    }
+    if (mask & ANIM_MASK_STROKE_OPACITY) {
+	stylePtr->strokeOpacity =
+		MAX(0.0, MIN(1.0, values[ANIM_STROKE_OPACITY]));
+	stylePtr->mask |= PATH_STYLE_OPTION_STROKE_OPACITY;
+    }
+    if (mask & ANIM_MASK_STROKE_WIDTH) {
+	stylePtr->strokeWidth = MAX(0.0, values[ANIM_STROKE_WIDTH]);
+	stylePtr->mask |= PATH_STYLE_OPTION_STROKE_WIDTH;
+    }
+    if (mask & ANIM_MASK_MATRIX) {
+	if (stylePtr->matrixPtr == NULL) {
+	    stylePtr->matrixPtr = (TMatrix *) ckalloc(sizeof(TMatrix));
+	}
+	stylePtr->matrixPtr->a = values[ANIM_MATRIX];
+	stylePtr->matrixPtr->b = values[ANIM_MATRIX+1];
+	stylePtr->matrixPtr->c = values[ANIM_MATRIX+2];
+	stylePtr->matrixPtr->d = values[ANIM_MATRIX+3];
+	stylePtr->matrixPtr->tx = values[ANIM_MATRIX+4];
+	stylePtr->matrixPtr->ty = values[ANIM_MATRIX+5];
+	stylePtr->mask |= PATH_STYLE_OPTION_MATRIX;
+    }
+    if (!(mask & ANIM_MASK_GEOMETRY)) {
+	TkPathCanvasEventuallyRedrawItem(canvas, itemPtr);
+	return;
+    }
+
+    /*
+     * Configuring with no options only recomputes the bounding box. The
+     * descendants of a group inherit the values, so they are done too.
+     */
+
+    endPtr = itemPtr->nextPtr;
+    for (walkPtr = itemPtr->parentPtr; (endPtr == NULL) && (walkPtr != NULL);
+	    walkPtr = walkPtr->parentPtr) {
+	endPtr = walkPtr->nextPtr;
+    }
+    for (walkPtr = itemPtr; walkPtr != endPtr;
+	    walkPtr = TkPathCanvasItemIteratorNext(walkPtr)) {
+	if (walkPtr != itemPtr) {
+	    TkPathCanvasEventuallyRedrawItem(canvas, walkPtr);
+	}
+	(*walkPtr->typePtr->configProc)(canvasPtr->interp, canvas, walkPtr,
+		0, NULL, TK_CONFIG_ARGV_ONLY);
+	TkPathCanvasEventuallyRedrawItem(canvas, walkPtr);
+    }
+}
+
+/*----------------------------------------------------------------------*/
+
@@ -43,32 +43,106 @@ MakePathAtomsFromArrow(ArrowDescr *arrowDescr)
     return ret;
 }
 
+/*
+ * Updates the cached atoms after the points changed. The atoms are
+ * only made anew when the arrow changes between filled and unfilled,
+ * which changes their number.
+ */
+
+static void
+UpdateArrowAtoms(ArrowDescr *arrowDescr)
+{
+    PathPoint *coords = arrowDescr->arrowPointsPtr;
+    PathAtom *atomPtr = arrowDescr->arrowAtomsPtr;
+    int i;
+
+    if (coords == NULL) {
+        return;
+    }
+    for (i = 0; i < DRAWABLE_PTS_IN_ARROW; i++) {
+        if (isnan(coords[i].x) || isnan(coords[i].y))
+            continue;
+        if (atomPtr == NULL)
+            break;
+        /* MoveToAtom and LineToAtom have the same layout. */
+        ((LineToAtom *) atomPtr)->x = coords[i].x;
+        ((LineToAtom *) atomPtr)->y = coords[i].y;
+        atomPtr = atomPtr->nextPtr;
+    }
+    if ((i < DRAWABLE_PTS_IN_ARROW) || (atomPtr != NULL)
+            || (arrowDescr->arrowAtomsPtr == NULL)) {
+        if (arrowDescr->arrowAtomsPtr != NULL) {
+            TkPathFreeAtoms(arrowDescr->arrowAtomsPtr);
+        }
+        arrowDescr->arrowAtomsPtr = MakePathAtomsFromArrow(arrowDescr);
+    }
+}
+
+static void
+PaintArrow(TkPathContext context, Drawable drawable, ArrowDescr *arrowDescr,
+        Tk_PathStyle *const style, PathRect *bboxPtr)
+{
+    Tk_PathStyle arrowStyle = *style;
+    TkPathColor fc;
+
+    if (arrowDescr->arrowFillRatio > 0.0 && arrowDescr->arrowLength != 0.0) {
+        // Hack for good arrowheads on linux: draw contour with stroke width=0.1, opacity=0.0 for filled arrowheads instead of stroke width=0.0
+        arrowStyle.strokeWidth = 0.1;       // When this value is 0.0, then Cairo (on Linux) rounding coordinates of fillable object and the zoomed small objects will be drawn with wrong arrowheads.
+        fc.color = arrowStyle.strokeColor;
+        fc.gradientInstPtr = NULL;
+        arrowStyle.fill = &fc;
+        arrowStyle.fillOpacity = arrowStyle.strokeOpacity;
+        arrowStyle.strokeOpacity = 0;
+    } else {
+        arrowStyle.fill = NULL;
+        arrowStyle.fillOpacity = 1.0;
+        arrowStyle.joinStyle = 1;
+        arrowStyle.dashPtr = NULL;
+    }
+    if (drawable == TK_PATH_SVG_DRAWABLE) {
+        TkPathSvgPath(arrowDescr->arrowAtomsPtr, &arrowStyle);
+    } else if (TkPathMakePath(context, arrowDescr->arrowAtomsPtr, &arrowStyle) == TCL_OK) {
+        TkPathPaintPath(context, arrowDescr->arrowAtomsPtr, &arrowStyle, bboxPtr);
+    }
+}
+
+/*
+ * Draws the line and its arrowheads in one context, the arrowheads
+ * being painted on top with the cached atoms.
+ */
+
 void
-DisplayArrow(Tk_PathCanvas canvas, Drawable drawable, ArrowDescr *arrowDescr,
-        Tk_PathStyle *const style, TMatrix *mPtr, PathRect *bboxPtr)
+DisplayPathWithArrows(Tk_PathCanvas canvas, Drawable drawable,
+        PathAtom *atomPtr, Tk_PathStyle *const style, TMatrix *mPtr,
+        PathRect *bboxPtr, ArrowDescr *startarrow, ArrowDescr *endarrow)
 {
-    if (arrowDescr->arrowEnabled && arrowDescr->arrowPointsPtr != NULL) {
-        Tk_PathStyle arrowStyle = *style;
-        TkPathColor fc;
-        PathAtom *atomPtr;
-
-        if (arrowDescr->arrowFillRatio > 0.0 && arrowDescr->arrowLength != 0.0) {
-            // Hack for good arrowheads on linux: draw contour with stroke width=0.1, opacity=0.0 for filled arrowheads instead of stroke width=0.0
-            arrowStyle.strokeWidth = 0.1;       // When this value is 0.0, then Cairo (on Linux) rounding coordinates of fillable object and the zoomed small objects will be drawn with wrong arrowheads.
-            fc.color = arrowStyle.strokeColor;
-            fc.gradientInstPtr = NULL;
-            arrowStyle.fill = &fc;
-            arrowStyle.fillOpacity = arrowStyle.strokeOpacity;
-            arrowStyle.strokeOpacity = 0;
-        } else {
-            arrowStyle.fill = NULL;
-            arrowStyle.fillOpacity = 1.0;
-            arrowStyle.joinStyle = 1;
-            arrowStyle.dashPtr = NULL;
+    TkPathContext context = 0;
+    ArrowDescr *arrows[2];
+    int i;
+
+    arrows[0] = startarrow;
+    arrows[1] = endarrow;
+    if (drawable == TK_PATH_SVG_DRAWABLE) {
+        TkPathSvgPath(atomPtr, style);
+    } else {
+        context = TkPathTimedInit(Tk_PathCanvasTkwin(canvas), drawable);
+        if (mPtr != NULL) {
+            TkPathPushTMatrix(context, mPtr);
+        }
+        if (style->matrixPtr != NULL) {
+            TkPathPushTMatrix(context, style->matrixPtr);
+        }
+        if (TkPathMakePath(context, atomPtr, style) == TCL_OK) {
+            TkPathPaintPath(context, atomPtr, style, bboxPtr);
         }
-        atomPtr = MakePathAtomsFromArrow(arrowDescr);
-        TkPathDrawPath(Tk_PathCanvasTkwin(canvas), drawable, atomPtr, &arrowStyle, mPtr, bboxPtr);
-        TkPathFreeAtoms(atomPtr);
+    }
+    for (i = 0; i < 2; i++) {
+        if (arrows[i]->arrowEnabled && arrows[i]->arrowAtomsPtr != NULL) {
+            PaintArrow(context, drawable, arrows[i], style, bboxPtr);
+        }
+    }
+    if (drawable != TK_PATH_SVG_DRAWABLE) {
+        TkPathTimedFree(context);
     }
 }
 
@@ -79,6 +153,7 @@ void TkPathArrowDescrInit(ArrowDescr *descrPtr)
     descrPtr->arrowWidth = (float)4.0;
     descrPtr->arrowFillRatio = (float)1.0;
     descrPtr->arrowPointsPtr = NULL;
+    descrPtr->arrowAtomsPtr = NULL;
 }
 
 void IncludeArrowPointsInRect(PathRect *bbox, ArrowDescr *arrowDescrPtr)
@@ -105,7 +180,8 @@ void TkPathPreconfigureArrow(PathPoint *pf, ArrowDescr *arrowDescr)
 {
     if (arrowDescr->arrowPointsPtr == NULL) {
         if (arrowDescr->arrowEnabled) {
-            arrowDescr->arrowPointsPtr = (PathPoint *)ckalloc((unsigned)(PTS_IN_ARROW * sizeof(PathPoint)));
+            arrowDescr->arrowPointsPtr = (PathPoint *)TkPathPoolAlloc(TkPathAtomPool(),
+                    (unsigned)(PTS_IN_ARROW * sizeof(PathPoint)));
             arrowDescr->arrowPointsPtr[LINE_PT_IN_ARROW] = *pf;
             arrowDescr->arrowPointsPtr[ORIG_PT_IN_ARROW] = *pf;
         }
@@ -115,8 +191,7 @@ void TkPathPreconfigureArrow(PathPoint *pf, ArrowDescr *arrowDescr)
             *pf = arrowDescr->arrowPointsPtr[ORIG_PT_IN_ARROW];
         }
         if (!arrowDescr->arrowEnabled) {
-            ckfree((char *)arrowDescr->arrowPointsPtr);
-            arrowDescr->arrowPointsPtr = NULL;
+            TkPathFreeArrow(arrowDescr);
         }
     }
 }
@@ -190,6 +265,7 @@ PathPoint TkPathConfigureArrow(PathPoint pf, PathPoint pl, ArrowDescr *arrowDesc
             poly[LINE_PT_IN_ARROW].x -= backup*cosTheta;
             poly[LINE_PT_IN_ARROW].y -= backup*sinTheta;
         }
+        UpdateArrowAtoms(arrowDescr);
 
         return poly[LINE_PT_IN_ARROW];
     }
@@ -204,6 +280,7 @@ void TkPathTranslateArrow(ArrowDescr *arrowDescr, double deltaX, double deltaY)
             arrowDescr->arrowPointsPtr[i].x += deltaX;
             arrowDescr->arrowPointsPtr[i].y += deltaY;
         }
+        TranslatePathAtoms(arrowDescr->arrowAtomsPtr, deltaX, deltaY);
     }
 }
 
@@ -216,15 +293,21 @@ void TkPathScaleArrow(ArrowDescr *arrowDescr, double originX, double originY, do
             pt->x = originX + scaleX*(pt->x - originX);
             pt->y = originX + scaleX*(pt->y - originX);
         }
+        UpdateArrowAtoms(arrowDescr);
     }
 }
 
 void TkPathFreeArrow(ArrowDescr *arrowDescr)
 {
     if (arrowDescr->arrowPointsPtr != NULL) {
-        ckfree((char *)arrowDescr->arrowPointsPtr);
+        TkPathPoolFree(TkPathAtomPool(), (char *)arrowDescr->arrowPointsPtr,
+                (unsigned)(PTS_IN_ARROW * sizeof(PathPoint)));
         arrowDescr->arrowPointsPtr = NULL;
     }
+    if (arrowDescr->arrowAtomsPtr != NULL) {
+        TkPathFreeAtoms(arrowDescr->arrowAtomsPtr);
+        arrowDescr->arrowAtomsPtr = NULL;
+    }
 }
 
 typedef PathPoint *PathPointPtr;
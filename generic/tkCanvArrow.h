@@ -39,6 +39,9 @@ typedef struct ArrowDescr
     PathPoint *arrowPointsPtr;  /* Points to array of PTS_IN_ARROW points
                                  * describing polygon for arrowhead in line.
                                  * NULL means no arrowhead at current point. */
+    PathAtom *arrowAtomsPtr;    /* The drawable part of the polygon as atoms,
+                                 * kept up to date with arrowPointsPtr so
+                                 * that they are not made on each redraw. */
 } ArrowDescr;
 
 void TkPathArrowDescrInit(ArrowDescr *descr);
@@ -65,8 +68,9 @@ int getSegmentsFromPathAtomList(PathAtom *firstAtom,
 
 PathAtom * MakePathAtomsFromArrow(ArrowDescr *arrowDescr);
 
-void DisplayArrow(Tk_PathCanvas canvas, Drawable drawable, ArrowDescr *arrowDescr,
-        Tk_PathStyle *const style, TMatrix *mPtr, PathRect *bboxPtr);
+void DisplayPathWithArrows(Tk_PathCanvas canvas, Drawable drawable,
+        PathAtom *atomPtr, Tk_PathStyle *const style, TMatrix *mPtr,
+        PathRect *bboxPtr, ArrowDescr *startarrow, ArrowDescr *endarrow);
 
 #define PATH_OPTION_SPEC_ARROWLENGTH_DEFAULT  "10.0"
 #define PATH_OPTION_SPEC_ARROWWIDTH_DEFAULT    "5.0"
@@ -152,6 +152,7 @@ Tk_PathItemType tkCircleType = {
     (Tk_PathItemInsertProc *) NULL,	/* insertProc */
     (Tk_PathItemDCharsProc *) NULL,	/* dTextProc */
     (Tk_PathItemType *) NULL,		/* nextPtr */
+    (Tk_PathItemAppendProc *) NULL,	/* appendProc */
 };
 
 Tk_PathItemType tkEllipseType = {
@@ -176,6 +177,7 @@ Tk_PathItemType tkEllipseType = {
     (Tk_PathItemInsertProc *) NULL,	/* insertProc */
     (Tk_PathItemDCharsProc *) NULL,	/* dTextProc */
     (Tk_PathItemType *) NULL,		/* nextPtr */
+    (Tk_PathItemAppendProc *) NULL,	/* appendProc */
 };
                         
 static int		
@@ -440,10 +442,8 @@ EllipseToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *pointPtr)
     EllipseItem *ellPtr = (EllipseItem *) itemPtr;
     Tk_PathStyle style;
     TMatrix *mPtr;
-    double bareOval[4];
-    double width, dist;
-    int rectiLinear = 0;
-    int haveDist = 0;
+    double center[2];
+    double width, dist, scale;
     int filled;
     
     style = TkPathCanvasInheritStyle(itemPtr, 0);
@@ -454,58 +454,44 @@ EllipseToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *pointPtr)
     }
     mPtr = style.matrixPtr;
     if (mPtr == NULL) {
-        rectiLinear = 1;
-        bareOval[0] = ellPtr->center[0] - ellPtr->rx;
-        bareOval[1] = ellPtr->center[1] - ellPtr->ry;
-        bareOval[2] = ellPtr->center[0] + ellPtr->rx;
-        bareOval[3] = ellPtr->center[1] + ellPtr->ry;
-        
-        /* For tiny points make it simple. */
-        if ((ellPtr->rx <= 2.0) && (ellPtr->ry <= 2.0)) {
-            dist = hypot(ellPtr->center[0] - pointPtr[0], ellPtr->center[1] - pointPtr[1]);
-            dist = MAX(0.0, dist - (ellPtr->rx + ellPtr->ry)/2.0);
-            haveDist = 1;
-        }
+        dist = PathEllipseToPoint(ellPtr->center, ellPtr->rx, ellPtr->ry, 
+                width, filled, pointPtr);
     } else if (TMATRIX_IS_RECTILINEAR(mPtr)) {
-        double rx, ry;
     
-        /* This is a situation we can treat in a simplified way. Apply the transform here. */
-        rectiLinear = 1;
-        bareOval[0] = mPtr->a * (ellPtr->center[0] - ellPtr->rx) + mPtr->tx;
-        bareOval[1] = mPtr->d * (ellPtr->center[1] - ellPtr->ry) + mPtr->ty;
-        bareOval[2] = mPtr->a * (ellPtr->center[0] + ellPtr->rx) + mPtr->tx;
-        bareOval[3] = mPtr->d * (ellPtr->center[1] + ellPtr->ry) + mPtr->ty;
-
-        /* For tiny points make it simple. */
-        rx = fabs(bareOval[0] - bareOval[2])/2.0;
-        ry = fabs(bareOval[1] - bareOval[3])/2.0;
-        if ((rx <= 2.0) && (ry <= 2.0)) {
-            dist = hypot((bareOval[0] + bareOval[2]/2.0) - pointPtr[0], 
-                    (bareOval[1] + bareOval[3]/2.0) - pointPtr[1]);
-            dist = MAX(0.0, dist - (rx + ry)/2.0);
-            haveDist = 1;
-        }
-    }
-    if (!haveDist) {
-        if (rectiLinear) {
-            dist = TkOvalToPoint(bareOval, width, filled, pointPtr);
-        } else {
-            PathAtom *atomPtr;
-            EllipseAtom ellAtom;
-        
-            /* 
-            * We create the atom on the fly to save some memory.
-            */    
-            atomPtr = (PathAtom *)&ellAtom;
-            atomPtr->nextPtr = NULL;
-            atomPtr->type = PATH_ATOM_ELLIPSE;
-            ellAtom.cx = ellPtr->center[0];
-            ellAtom.cy = ellPtr->center[1];
-            ellAtom.rx = ellPtr->rx;
-            ellAtom.ry = ellPtr->ry;
-            dist = GenericPathToPoint(canvas, itemPtr, &style, atomPtr, 
-                    kPathNumSegmentsEllipse+1, pointPtr);
-        }
+        /* The ellipse stays axis aligned. Apply the transform here. */
+        center[0] = mPtr->a * ellPtr->center[0] + mPtr->tx;
+        center[1] = mPtr->d * ellPtr->center[1] + mPtr->ty;
+        dist = PathEllipseToPoint(center, fabs(mPtr->a) * ellPtr->rx, 
+                fabs(mPtr->d) * ellPtr->ry, width, filled, pointPtr);
+    } else if (PathTMatrixIsSimilarity(mPtr, &scale)) {
+        TMatrix mi;
+        double point[2];
+    
+        /* 
+         * Rotated: do the test in the item's coordinate system where the
+         * ellipse is axis aligned. All distances scale uniformly but the
+         * stroke width is in canvas units.
+         */
+        PathInverseTMatrix(mPtr, &mi);
+        PathApplyTMatrixToPoint(&mi, pointPtr, point);
+        dist = scale * PathEllipseToPoint(ellPtr->center, ellPtr->rx, ellPtr->ry, 
+                width/scale, filled, point);
+    } else {
+        PathAtom *atomPtr;
+        EllipseAtom ellAtom;
+    
+        /* 
+         * We create the atom on the fly to save some memory.
+         */    
+        atomPtr = (PathAtom *)&ellAtom;
+        atomPtr->nextPtr = NULL;
+        atomPtr->type = PATH_ATOM_ELLIPSE;
+        ellAtom.cx = ellPtr->center[0];
+        ellAtom.cy = ellPtr->center[1];
+        ellAtom.rx = ellPtr->rx;
+        ellAtom.ry = ellPtr->ry;
+        dist = GenericPathToPoint(canvas, itemPtr, &style, atomPtr, 
+                kPathNumSegmentsEllipse+1, pointPtr);
     }
     TkPathCanvasFreeInheritedStyle(&style);
     return dist;
@@ -517,74 +503,42 @@ EllipseToArea(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *areaPtr)
     EllipseItem *ellPtr = (EllipseItem *) itemPtr;
     Tk_PathStyle style;
     TMatrix *mPtr;
-    double bareOval[4], halfWidth;
+    double center[2], rx, ry;
+    double width, scale;
     int rectiLinear = 0;
     int result;
     
     style = TkPathCanvasInheritStyle(itemPtr, 0);
-    halfWidth = 0.0;
+    width = 0.0;
     if (style.strokeColor != NULL) {
-        halfWidth = style.strokeWidth/2.0;
+        width = style.strokeWidth;
     }
     mPtr = style.matrixPtr;
     if (mPtr == NULL) {
         rectiLinear = 1;
-        bareOval[0] = ellPtr->center[0] - ellPtr->rx;
-        bareOval[1] = ellPtr->center[1] - ellPtr->ry;
-        bareOval[2] = ellPtr->center[0] + ellPtr->rx;
-        bareOval[3] = ellPtr->center[1] + ellPtr->ry;
+        center[0] = ellPtr->center[0];
+        center[1] = ellPtr->center[1];
+        rx = ellPtr->rx;
+        ry = ellPtr->ry;
     } else if (TMATRIX_IS_RECTILINEAR(mPtr)) {
     
         /* This is a situation we can treat in a simplified way. Apply the transform here. */
         rectiLinear = 1;
-        bareOval[0] = mPtr->a * (ellPtr->center[0] - ellPtr->rx) + mPtr->tx;
-        bareOval[1] = mPtr->d * (ellPtr->center[1] - ellPtr->ry) + mPtr->ty;
-        bareOval[2] = mPtr->a * (ellPtr->center[0] + ellPtr->rx) + mPtr->tx;
-        bareOval[3] = mPtr->d * (ellPtr->center[1] + ellPtr->ry) + mPtr->ty;
+        center[0] = mPtr->a * ellPtr->center[0] + mPtr->tx;
+        center[1] = mPtr->d * ellPtr->center[1] + mPtr->ty;
+        rx = fabs(mPtr->a) * ellPtr->rx;
+        ry = fabs(mPtr->d) * ellPtr->ry;
+    } else if ((ellPtr->rx == ellPtr->ry) && PathTMatrixIsSimilarity(mPtr, &scale)) {
+    
+        /* A rotated circle is still a circle. */
+        rectiLinear = 1;
+        PathApplyTMatrixToPoint(mPtr, ellPtr->center, center);
+        rx = ry = scale * ellPtr->rx;
     }
     
     if (rectiLinear) {
-        double oval[4];
-        
-        /* @@@ Assuming untransformed strokes */
-        oval[0] = bareOval[0] - halfWidth;
-        oval[1] = bareOval[1] - halfWidth;
-        oval[2] = bareOval[2] + halfWidth;
-        oval[3] = bareOval[3] + halfWidth;
-
-        result = TkOvalToArea(oval, areaPtr);
-    
-        /*
-         * If the rectangle appears to overlap the oval and the oval
-         * isn't filled, do one more check to see if perhaps all four
-         * of the rectangle's corners are totally inside the oval's
-         * unfilled center, in which case we should return "outside".
-         */
-        if ((result == 0) && (style.strokeColor != NULL)
-                && !HaveAnyFillFromPathColor(style.fill)) {
-            double width, height;
-            double xDelta1, yDelta1, xDelta2, yDelta2;
-        
-            width = (bareOval[2] - bareOval[0])/2.0 - halfWidth;
-            height = (bareOval[3] - bareOval[1])/2.0 - halfWidth;
-            if ((width <= 0.0) || (height <= 0.0)) {
-                return 0;
-            }
-            xDelta1 = (areaPtr[0] - ellPtr->center[0])/width;
-            xDelta1 *= xDelta1;
-            yDelta1 = (areaPtr[1] - ellPtr->center[1])/height;
-            yDelta1 *= yDelta1;
-            xDelta2 = (areaPtr[2] - ellPtr->center[0])/width;
-            xDelta2 *= xDelta2;
-            yDelta2 = (areaPtr[3] - ellPtr->center[1])/height;
-            yDelta2 *= yDelta2;
-            if (((xDelta1 + yDelta1) < 1.0)
-                    && ((xDelta1 + yDelta2) < 1.0)
-                    && ((xDelta2 + yDelta1) < 1.0)
-                    && ((xDelta2 + yDelta2) < 1.0)) {
-                result = -1;
-            }
-        }
+        result = PathEllipseToArea(center, rx, ry, width, 
+                HaveAnyFillFromPathColor(style.fill), areaPtr);
     } else {
         PathAtom *atomPtr;
         EllipseAtom ellAtom;
@@ -617,11 +571,47 @@ ScaleEllipse(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double originX, double
         double scaleX, double scaleY)
 {
     EllipseItem *ellPtr = (EllipseItem *) itemPtr;
+    Tk_PathItemEx *itemExPtr = &ellPtr->headerEx;
+    Tk_PathStyle *stylePtr = &itemExPtr->style;
 
+    if ((ellPtr->type == kOvalTypeCircle) && (fabs(scaleX) != fabs(scaleY))) {
+    
+        /*
+         * A circle has a single radius. Put the scale into its matrix,
+         * which is applied after the scale as in the display, so that
+         * it is drawn as an ellipse. If the -style gives the matrix
+         * the radius gets the geometric mean of the scales instead.
+         */
+        if ((itemExPtr->styleInst == NULL) 
+                || !(itemExPtr->styleInst->masterPtr->mask & PATH_STYLE_OPTION_MATRIX)) {
+            TMatrix s = kPathUnitTMatrix, m = kPathUnitTMatrix;
+            
+            s.a = scaleX;
+            s.d = scaleY;
+            s.tx = originX - scaleX*originX;
+            s.ty = originY - scaleY*originY;
+            if (stylePtr->matrixPtr == NULL) {
+                stylePtr->matrixPtr = (TMatrix *) ckalloc(sizeof(TMatrix));
+            } else {
+                m = *stylePtr->matrixPtr;
+            }
+            MMulTMatrix(&s, &m);
+            *stylePtr->matrixPtr = m;
+            stylePtr->mask |= PATH_STYLE_OPTION_MATRIX;
+            ComputeEllipseBbox(canvas, ellPtr);
+            return;
+        }
+        ellPtr->center[0] = originX + scaleX*(ellPtr->center[0] - originX);
+        ellPtr->center[1] = originY + scaleY*(ellPtr->center[1] - originY);
+        ellPtr->rx *= sqrt(fabs(scaleX*scaleY));
+        ellPtr->ry = ellPtr->rx;
+        ComputeEllipseBbox(canvas, ellPtr);
+        return;
+    }
     ellPtr->center[0] = originX + scaleX*(ellPtr->center[0] - originX);
     ellPtr->center[1] = originY + scaleY*(ellPtr->center[1] - originY);
-    ellPtr->rx *= scaleX;
-    ellPtr->ry *= scaleY;
+    ellPtr->rx *= fabs(scaleX);
+    ellPtr->ry *= fabs(scaleY);
     ScalePathRect(&itemPtr->bbox, originX, originY, scaleX, scaleY);
     ScalePathRect(&itemPtr->totalBbox, originX, originY, scaleX, scaleY);
     ScaleItemHeader(itemPtr, originX, originY, scaleX, scaleY);
@@ -35,6 +35,13 @@ typedef struct GroupItem  {
     PathRect totalBbox;		/* Bounding box including stroke.
 				 * Untransformed coordinates. */
     long flags;			/* Various flags, see enum. */
+    int transformOnly;		/* Move and scale only change our
+				 * -matrix and not the children. */
+    int edgeCount[4];		/* Number of children whose bbox touch
+				 * each edge x1, y1, x2, y2 of ours. */
+    Tcl_HashTable childTable;	/* The bbox of each child that is
+				 * accounted for in ours, as int[4], keyed
+				 * by the child item. */
 } GroupItem;
 
 
@@ -83,6 +90,8 @@ static Tk_OptionSpec optionSpecs[] = {
     PATH_OPTION_SPEC_STYLE_FILL(Tk_PathItemEx, ""),
     PATH_OPTION_SPEC_STYLE_MATRIX(Tk_PathItemEx),
     PATH_OPTION_SPEC_STYLE_STROKE(Tk_PathItemEx, "black"),
+    {TK_OPTION_BOOLEAN, "-transformonly", NULL, NULL,
+	"0", -1, Tk_Offset(GroupItem, transformOnly), 0, 0, 0},
     PATH_OPTION_SPEC_END
 };
 
@@ -115,6 +124,7 @@ Tk_PathItemType tkGroupType = {
     (Tk_PathItemInsertProc *) NULL,	/* insertProc */
     (Tk_PathItemDCharsProc *) NULL,	/* dTextProc */
     (Tk_PathItemType *) NULL,		/* nextPtr */
+    (Tk_PathItemAppendProc *) NULL,	/* appendProc */
 };
 
 
@@ -137,6 +147,9 @@ CreateGroup(Tcl_Interp *interp,
     itemExPtr->styleInst = NULL;
     groupPtr->totalBbox = NewEmptyPathRect();
     groupPtr->flags = 0L;
+    groupPtr->transformOnly = 0;
+    memset(groupPtr->edgeCount, 0, sizeof(groupPtr->edgeCount));
+    Tcl_InitHashTable(&groupPtr->childTable, TCL_ONE_WORD_KEYS);
     itemExPtr->header.x1 = itemExPtr->header.x2 =
     itemExPtr->header.y1 = itemExPtr->header.y2 = -1;
     
@@ -252,7 +265,14 @@ DeleteGroup(Tk_PathCanvas canvas,
     GroupItem *groupPtr = (GroupItem *) itemPtr;
     Tk_PathItemEx *itemExPtr = &groupPtr->headerEx;
     Tk_PathStyle *stylePtr = &itemExPtr->style;
+    Tcl_HashEntry *hPtr;
+    Tcl_HashSearch search;
 
+    for (hPtr = Tcl_FirstHashEntry(&groupPtr->childTable, &search);
+	    hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	ckfree((char *) Tcl_GetHashValue(hPtr));
+    }
+    Tcl_DeleteHashTable(&groupPtr->childTable);
     if (stylePtr->fill != NULL) {
 	TkPathFreePathColor(stylePtr->fill);
     }
@@ -318,16 +338,37 @@ ScaleGroup(Tk_PathCanvas canvas,
 	Tk_PathItem *itemPtr, double originX, double originY,
 	double scaleX, double scaleY)
 {
+    GroupItem *groupPtr = (GroupItem *) itemPtr;
+    
+    if (groupPtr->transformOnly) {
+	TMatrix m;
+	
+	m.a = scaleX, m.b = 0.0, m.c = 0.0, m.d = scaleY;
+	m.tx = originX*(1.0 - scaleX);
+	m.ty = originY*(1.0 - scaleY);
+	if (CanvasTransformGroup(canvas, itemPtr, &m) == TCL_OK) {
+	    return;
+	}
+    }
     CanvasScaleGroup(canvas, itemPtr, originX, originY, scaleX, scaleY);
-    /* @@@ TODO: we could handle bbox ourselves? */
 }
 
 static void	
 TranslateGroup(Tk_PathCanvas canvas,
 	Tk_PathItem *itemPtr, double deltaX, double deltaY)
 {
+    GroupItem *groupPtr = (GroupItem *) itemPtr;
+    
+    if (groupPtr->transformOnly) {
+	TMatrix m = kPathUnitTMatrix;
+	
+	m.tx = deltaX;
+	m.ty = deltaY;
+	if (CanvasTransformGroup(canvas, itemPtr, &m) == TCL_OK) {
+	    return;
+	}
+    }
     CanvasTranslateGroup(canvas, itemPtr, deltaX, deltaY);
-    /* @@@ TODO: we could handle bbox ourselves? */
 }
 
 /*
@@ -338,7 +379,7 @@ TranslateGroup(Tk_PathCanvas canvas,
  *	This function is invoked by canvas code to tell us that one or
  *	more of our childrens have changed somehow so that our bbox
  *	need to be recomputed next time TkPathCanvasUpdateGroupBbox
- *	is called.
+ *	is called. The caller must mark our ancestors as well.
  *
  * Results:
  *	None.
@@ -353,19 +394,283 @@ void
 TkPathCanvasSetGroupDirtyBbox(Tk_PathItem *itemPtr)
 {
     GroupItem *groupPtr = (GroupItem *) itemPtr;
-    groupPtr->flags &= GROUP_FLAG_DIRTY_BBOX;
+    groupPtr->flags |= GROUP_FLAG_DIRTY_BBOX;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * GroupChildRect, TkPathCanvasGroupChildBbox --
+ *
+ *	Finds the bbox of a child that its group has accounted for, which
+ *	is made if create is set. TkPathCanvasGroupChildBbox is the same
+ *	for the parent of any item.
+ *
+ * Results:
+ *	Pointer to x1, y1, x2, y2, or NULL if there is none.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int *
+GroupChildRect(GroupItem *groupPtr, Tk_PathItem *childPtr, int create)
+{
+    Tcl_HashEntry *hPtr;
+    int *rectPtr, isNew;
+
+    if (!create) {
+	hPtr = Tcl_FindHashEntry(&groupPtr->childTable, (char *) childPtr);
+	return (hPtr == NULL) ? NULL : (int *) Tcl_GetHashValue(hPtr);
+    }
+    hPtr = Tcl_CreateHashEntry(&groupPtr->childTable, (char *) childPtr,
+	    &isNew);
+    if (isNew) {
+	rectPtr = (int *) ckalloc(4 * sizeof(int));
+	rectPtr[0] = rectPtr[1] = rectPtr[2] = rectPtr[3] = -1;
+	Tcl_SetHashValue(hPtr, rectPtr);
+    }
+    return (int *) Tcl_GetHashValue(hPtr);
 }
 
+int *
+TkPathCanvasGroupChildBbox(Tk_PathItem *itemPtr)
+{
+    if (itemPtr->parentPtr == NULL) {
+	return NULL;
+    }
+    return GroupChildRect((GroupItem *) itemPtr->parentPtr, itemPtr, 0);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkPathCanvasUpdateGroupBbox --
+ *
+ *	Rescans the children of a dirty group to find its bbox and how
+ *	many children touch each of its edges. Dirty sub groups are
+ *	rescanned first.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The group's bbox is updated and the children's bboxes are
+ *	recorded as accounted for.
+ *
+ *----------------------------------------------------------------------
+ */
+
 void	
 TkPathCanvasUpdateGroupBbox(Tk_PathCanvas canvas, Tk_PathItem *itemPtr)
 {
     GroupItem *groupPtr = (GroupItem *) itemPtr;
+    Tk_PathItem *walkPtr;
+    int *countPtr = groupPtr->edgeCount;
+    int *rectPtr;
+    int gotAny = 0;
+    int x1 = -1, y1 = -1, x2 = -1, y2 = -1;
+
+    if (!(groupPtr->flags & GROUP_FLAG_DIRTY_BBOX)) {
+	return;
+    }
+    memset(countPtr, 0, sizeof(groupPtr->edgeCount));
+    for (walkPtr = itemPtr->firstChildPtr; walkPtr != NULL; 
+	    walkPtr = walkPtr->nextPtr) {
+	if (walkPtr->typePtr == &tkGroupType) {
+	    TkPathCanvasUpdateGroupBbox(canvas, walkPtr);
+	}
+	rectPtr = GroupChildRect(groupPtr, walkPtr, 1);
+	rectPtr[0] = walkPtr->x1, rectPtr[1] = walkPtr->y1;
+	rectPtr[2] = walkPtr->x2, rectPtr[3] = walkPtr->y2;
+	if ((walkPtr->x1 >= walkPtr->x2) || (walkPtr->y1 >= walkPtr->y2)) {
+	    continue;
+	}
+	if (!gotAny) {
+	    x1 = walkPtr->x1;
+	    y1 = walkPtr->y1;
+	    x2 = walkPtr->x2;
+	    y2 = walkPtr->y2;
+	    countPtr[0] = countPtr[1] = countPtr[2] = countPtr[3] = 1;
+	    gotAny = 1;
+	    continue;
+	}
+	if (walkPtr->x1 < x1) {
+	    x1 = walkPtr->x1, countPtr[0] = 1;
+	} else if (walkPtr->x1 == x1) {
+	    countPtr[0]++;
+	}
+	if (walkPtr->y1 < y1) {
+	    y1 = walkPtr->y1, countPtr[1] = 1;
+	} else if (walkPtr->y1 == y1) {
+	    countPtr[1]++;
+	}
+	if (walkPtr->x2 > x2) {
+	    x2 = walkPtr->x2, countPtr[2] = 1;
+	} else if (walkPtr->x2 == x2) {
+	    countPtr[2]++;
+	}
+	if (walkPtr->y2 > y2) {
+	    y2 = walkPtr->y2, countPtr[3] = 1;
+	} else if (walkPtr->y2 == y2) {
+	    countPtr[3]++;
+	}
+    }
+    itemPtr->x1 = x1, itemPtr->y1 = y1, itemPtr->x2 = x2, itemPtr->y2 = y2;
+    groupPtr->flags &= ~GROUP_FLAG_DIRTY_BBOX;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * GroupAccountChild --
+ *
+ *	Replaces the bbox r that a child contributed to our bbox with
+ *	its new bbox n, either of which may be empty. Edges that grow
+ *	are moved directly. An edge only needs a rescan when the last
+ *	child touching it moves inwards.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The group's bbox or edge counts change, or it is set dirty.
+ *
+ *----------------------------------------------------------------------
+ */
 
-    if (groupPtr->flags & GROUP_FLAG_DIRTY_BBOX) {
-	TkPathCanvasGroupBbox(canvas, itemPtr,
-		&itemPtr->x1, &itemPtr->y1, &itemPtr->x2, &itemPtr->y2);    
-	groupPtr->flags &= ~GROUP_FLAG_DIRTY_BBOX;
+static void
+GroupAccountChild(GroupItem *groupPtr, int r[4], int n[4])
+{
+    Tk_PathItem *itemPtr = &groupPtr->headerEx.header;
+    int *edgePtr[4];
+    int *countPtr = groupPtr->edgeCount;
+    int rEmpty = ((r[0] >= r[2]) || (r[1] >= r[3]));
+    int nEmpty = ((n[0] >= n[2]) || (n[1] >= n[3]));
+    int i, sign, wasOn;
+
+    if ((itemPtr->x1 >= itemPtr->x2) || (itemPtr->y1 >= itemPtr->y2)) {
+	if (!rEmpty) {
+	    groupPtr->flags |= GROUP_FLAG_DIRTY_BBOX;
+	} else if (!nEmpty) {
+	    itemPtr->x1 = n[0], itemPtr->y1 = n[1];
+	    itemPtr->x2 = n[2], itemPtr->y2 = n[3];
+	    countPtr[0] = countPtr[1] = countPtr[2] = countPtr[3] = 1;
+	}
+	return;
+    }
+    edgePtr[0] = &itemPtr->x1, edgePtr[1] = &itemPtr->y1;
+    edgePtr[2] = &itemPtr->x2, edgePtr[3] = &itemPtr->y2;
+    for (i = 0; i < 4; i++) {
+	/* sign is -1 for the lower edges and 1 for the upper ones. */
+	sign = (i < 2) ? -1 : 1;
+	wasOn = (!rEmpty && (r[i] == *edgePtr[i]));
+	if (!nEmpty && (sign*(n[i] - *edgePtr[i]) > 0)) {
+	    *edgePtr[i] = n[i];
+	    countPtr[i] = 1;
+	} else if (!nEmpty && (n[i] == *edgePtr[i])) {
+	    if (!wasOn) {
+		countPtr[i]++;
+	    }
+	} else if (wasOn) {
+	    if (--countPtr[i] <= 0) {
+		groupPtr->flags |= GROUP_FLAG_DIRTY_BBOX;
+	    }
+	}
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkPathCanvasGroupChildChanged, TkPathCanvasGroupChildRemoved --
+ *
+ *	Tells the parent group of an item that its bbox may have changed
+ *	or that it is going away. The group's bbox is maintained
+ *	incrementally and any change of it is passed on to its parent
+ *	in turn. If a group ends up needing a rescan, it and all its
+ *	ancestors are set dirty instead.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Group bboxes updated or set dirty.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+GroupChildBboxChanged(Tk_PathItem *itemPtr, int removed)
+{
+    Tk_PathItem *parentPtr, *walkPtr;
+    GroupItem *groupPtr;
+    int r[4], n[4], old[4] = {0, 0, 0, 0};
+    int *rectPtr;
+    
+    while ((parentPtr = itemPtr->parentPtr) != NULL) {
+	groupPtr = (GroupItem *) parentPtr;
+	if (groupPtr->flags & GROUP_FLAG_DIRTY_BBOX) {
+	    /* The rescan picks this up. The ancestors are dirty already. */
+	    break;
+	}
+	if (!removed && (itemPtr->typePtr == &tkGroupType)
+		&& (((GroupItem *) itemPtr)->flags & GROUP_FLAG_DIRTY_BBOX)) {
+	    groupPtr->flags |= GROUP_FLAG_DIRTY_BBOX;
+	} else {
+	    rectPtr = GroupChildRect(groupPtr, itemPtr, 1);
+	    r[0] = rectPtr[0], r[1] = rectPtr[1];
+	    r[2] = rectPtr[2], r[3] = rectPtr[3];
+	    if (removed) {
+		n[0] = n[1] = n[2] = n[3] = -1;
+	    } else {
+		n[0] = itemPtr->x1, n[1] = itemPtr->y1;
+		n[2] = itemPtr->x2, n[3] = itemPtr->y2;
+	    }
+	    old[0] = parentPtr->x1, old[1] = parentPtr->y1;
+	    old[2] = parentPtr->x2, old[3] = parentPtr->y2;
+	    GroupAccountChild(groupPtr, r, n);
+	    rectPtr[0] = n[0], rectPtr[1] = n[1];
+	    rectPtr[2] = n[2], rectPtr[3] = n[3];
+	}
+	if (groupPtr->flags & GROUP_FLAG_DIRTY_BBOX) {
+	    for (walkPtr = parentPtr->parentPtr; walkPtr != NULL; 
+		    walkPtr = walkPtr->parentPtr) {
+		TkPathCanvasSetGroupDirtyBbox(walkPtr);
+	    }
+	    break;
+	}
+	if ((old[0] == parentPtr->x1) && (old[1] == parentPtr->y1)
+		&& (old[2] == parentPtr->x2) && (old[3] == parentPtr->y2)) {
+	    break;
+	}
+	itemPtr = parentPtr;
+	removed = 0;
+    }
+}
+
+void
+TkPathCanvasGroupChildChanged(Tk_PathItem *itemPtr)
+{
+    GroupChildBboxChanged(itemPtr, 0);
+}
+
+void
+TkPathCanvasGroupChildRemoved(Tk_PathItem *itemPtr)
+{
+    Tcl_HashEntry *hPtr;
+
+    GroupChildBboxChanged(itemPtr, 1);
+    if (itemPtr->parentPtr != NULL) {
+	hPtr = Tcl_FindHashEntry(
+		&((GroupItem *) itemPtr->parentPtr)->childTable,
+		(char *) itemPtr);
+	if (hPtr != NULL) {
+	    ckfree((char *) Tcl_GetHashValue(hPtr));
+	    Tcl_DeleteHashEntry(hPtr);
+	}
+    }
+}
 
@@ -0,0 +1,565 @@
+/*
+ * tkCanvLight.c --
+ *
+ *	This file implements the lightweight lcircle, lrect and lline
+ *	canvas items. They have no style options of their own but only
+ *	a -style name, and their record holds just the geometry as a
+ *	single path atom, which saves the Tk_PathStyle of ordinary items.
+ *
+ * Copyright (c) 2026  tkpath contributors
+ *
+ * $Id$
+ */
+
+#include "tkIntPath.h"
+#include "tkpCanvas.h"
+#include "tkCanvPathUtil.h"
+#include "tkPathStyle.h"
+
+typedef struct LightLine {
+    MoveToAtom moveTo;
+    LineToAtom lineTo;
+} LightLine;
+
+/*
+ * The structure below defines the record for each lightweight item.
+ * Only the part of the geom union that the item type uses is allocated.
+ */
+
+typedef struct LightItem  {
+    Tk_PathItemLight headerLight;
+			    /* Generic stuff that's the same for all
+                             * lightweight types.  MUST BE FIRST IN STRUCTURE. */
+    union {
+	PathAtom pathAtom;
+	EllipseAtom ellipse;
+	RectAtom rect;
+	LightLine line;
+    } geom;		    /* The geometry as path atoms. */
+} LightItem;
+
+#define LIGHT_ITEM_SIZE(geomType) \
+    (Tk_Offset(LightItem, geom) + sizeof(geomType))
+
+/*
+ * Prototypes for procedures defined in this file:
+ */
+
+static void	ComputeLightBbox(Tk_PathCanvas canvas, LightItem *lightPtr);
+static int	ConfigureLight(Tcl_Interp *interp, Tk_PathCanvas canvas,
+		    Tk_PathItem *itemPtr, int objc,
+		    Tcl_Obj *CONST objv[], int flags);
+static int	CreateAny(Tcl_Interp *interp, Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
+		    int objc, Tcl_Obj *CONST objv[], int atomType);
+static int	CreateLcircle(Tcl_Interp *interp,
+		    Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
+		    int objc, Tcl_Obj *CONST objv[]);
+static int	CreateLline(Tcl_Interp *interp,
+		    Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
+		    int objc, Tcl_Obj *CONST objv[]);
+static int	CreateLrect(Tcl_Interp *interp,
+		    Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
+		    int objc, Tcl_Obj *CONST objv[]);
+static void	DeleteLight(Tk_PathCanvas canvas,
+		    Tk_PathItem *itemPtr, Display *display);
+static void	DisplayLight(Tk_PathCanvas canvas,
+		    Tk_PathItem *itemPtr, Display *display, Drawable drawable,
+		    int x, int y, int width, int height);
+static void	LightBbox(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+		    int mask);
+static int	LightCoords(Tcl_Interp *interp,
+		    Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+		    int objc, Tcl_Obj *CONST objv[]);
+static int	LightToArea(Tk_PathCanvas canvas,
+		    Tk_PathItem *itemPtr, double *rectPtr);
+static double	LightToPoint(Tk_PathCanvas canvas,
+		    Tk_PathItem *itemPtr, double *coordPtr);
+static int	LightToPostscript(Tcl_Interp *interp,
+		    Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int prepass);
+static void	ScaleLight(Tk_PathCanvas canvas,
+		    Tk_PathItem *itemPtr, double originX, double originY,
+		    double scaleX, double scaleY);
+static void	TranslateLight(Tk_PathCanvas canvas,
+		    Tk_PathItem *itemPtr, double deltaX, double deltaY);
+
+PATH_CUSTOM_OPTION_TAGS
+PATH_OPTION_STRING_TABLES_STATE
+
+static Tk_OptionSpec optionSpecs[] = {
+    PATH_OPTION_SPEC_CORE(Tk_PathItemLight),
+    PATH_OPTION_SPEC_PARENT,
+    PATH_OPTION_SPEC_END
+};
+
+static Tk_OptionTable optionTable = NULL;
+
+/*
+ * The structures below define the lightweight item types by means
+ * of procedures that can be invoked by generic item code.
+ */
+
+Tk_PathItemType tkLcircleType = {
+    "lcircle",				/* name */
+    LIGHT_ITEM_SIZE(EllipseAtom),	/* itemSize */
+    CreateLcircle,			/* createProc */
+    optionSpecs,			/* optionSpecs */
+    ConfigureLight,			/* configureProc */
+    LightCoords,			/* coordProc */
+    DeleteLight,			/* deleteProc */
+    DisplayLight,			/* displayProc */
+    0,					/* alwaysRedraw */
+    LightBbox,				/* bboxProc */
+    LightToPoint,			/* pointProc */
+    LightToArea,			/* areaProc */
+    LightToPostscript,			/* postscriptProc */
+    ScaleLight,				/* scaleProc */
+    TranslateLight,			/* translateProc */
+    (Tk_PathItemIndexProc *) NULL,	/* indexProc */
+    (Tk_PathItemCursorProc *) NULL,	/* icursorProc */
+    (Tk_PathItemSelectionProc *) NULL,	/* selectionProc */
+    (Tk_PathItemInsertProc *) NULL,	/* insertProc */
+    (Tk_PathItemDCharsProc *) NULL,	/* dTextProc */
+    (Tk_PathItemType *) NULL,		/* nextPtr */
+    (Tk_PathItemAppendProc *) NULL,	/* appendProc */
+    TK_PATH_ITEMTYPE_LIGHT,		/* flags */
+};
+
+Tk_PathItemType tkLrectType = {
+    "lrect",				/* name */
+    LIGHT_ITEM_SIZE(RectAtom),		/* itemSize */
+    CreateLrect,			/* createProc */
+    optionSpecs,			/* optionSpecs */
+    ConfigureLight,			/* configureProc */
+    LightCoords,			/* coordProc */
+    DeleteLight,			/* deleteProc */
+    DisplayLight,			/* displayProc */
+    0,					/* alwaysRedraw */
+    LightBbox,				/* bboxProc */
+    LightToPoint,			/* pointProc */
+    LightToArea,			/* areaProc */
+    LightToPostscript,			/* postscriptProc */
+    ScaleLight,				/* scaleProc */
+    TranslateLight,			/* translateProc */
+    (Tk_PathItemIndexProc *) NULL,	/* indexProc */
+    (Tk_PathItemCursorProc *) NULL,	/* icursorProc */
+    (Tk_PathItemSelectionProc *) NULL,	/* selectionProc */
+    (Tk_PathItemInsertProc *) NULL,	/* insertProc */
+    (Tk_PathItemDCharsProc *) NULL,	/* dTextProc */
+    (Tk_PathItemType *) NULL,		/* nextPtr */
+    (Tk_PathItemAppendProc *) NULL,	/* appendProc */
+    TK_PATH_ITEMTYPE_LIGHT,		/* flags */
+};
+
+Tk_PathItemType tkLlineType = {
+    "lline",				/* name */
+    LIGHT_ITEM_SIZE(LightLine),		/* itemSize */
+    CreateLline,			/* createProc */
+    optionSpecs,			/* optionSpecs */
+    ConfigureLight,			/* configureProc */
+    LightCoords,			/* coordProc */
+    DeleteLight,			/* deleteProc */
+    DisplayLight,			/* displayProc */
+    0,					/* alwaysRedraw */
+    LightBbox,				/* bboxProc */
+    LightToPoint,			/* pointProc */
+    LightToArea,			/* areaProc */
+    LightToPostscript,			/* postscriptProc */
+    ScaleLight,				/* scaleProc */
+    TranslateLight,			/* translateProc */
+    (Tk_PathItemIndexProc *) NULL,	/* indexProc */
+    (Tk_PathItemCursorProc *) NULL,	/* icursorProc */
+    (Tk_PathItemSelectionProc *) NULL,	/* selectionProc */
+    (Tk_PathItemInsertProc *) NULL,	/* insertProc */
+    (Tk_PathItemDCharsProc *) NULL,	/* dTextProc */
+    (Tk_PathItemType *) NULL,		/* nextPtr */
+    (Tk_PathItemAppendProc *) NULL,	/* appendProc */
+    TK_PATH_ITEMTYPE_LIGHT,		/* flags */
+};
+
+static int
+CreateLcircle(Tcl_Interp *interp, Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
+        int objc, Tcl_Obj *CONST objv[])
+{
+    return CreateAny(interp, canvas, itemPtr, objc, objv, PATH_ATOM_ELLIPSE);
+}
+
+static int
+CreateLrect(Tcl_Interp *interp, Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
+        int objc, Tcl_Obj *CONST objv[])
+{
+    return CreateAny(interp, canvas, itemPtr, objc, objv, PATH_ATOM_RECT);
+}
+
+static int
+CreateLline(Tcl_Interp *interp, Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
+        int objc, Tcl_Obj *CONST objv[])
+{
+    return CreateAny(interp, canvas, itemPtr, objc, objv, PATH_ATOM_M);
+}
+
+static int
+CreateAny(Tcl_Interp *interp, Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
+        int objc, Tcl_Obj *CONST objv[], int atomType)
+{
+    LightItem *lightPtr = (LightItem *) itemPtr;
+    Tk_PathItemLight *itemLightPtr = &lightPtr->headerLight;
+    int	i;
+
+    if (objc == 0) {
+        Tcl_Panic("canvas did not pass any coords\n");
+    }
+
+    /*
+     * Carry out initialization that is needed to set defaults and to
+     * allow proper cleanup after errors during the the remainder of
+     * this procedure.
+     */
+    itemLightPtr->canvas = canvas;
+    itemLightPtr->styleObj = NULL;
+    itemLightPtr->styleInst = NULL;
+    lightPtr->geom.pathAtom.type = atomType;
+    lightPtr->geom.pathAtom.nextPtr = NULL;
+    if (atomType == PATH_ATOM_M) {
+        lightPtr->geom.line.moveTo.pathAtom.nextPtr =
+                (PathAtom *) &lightPtr->geom.line.lineTo;
+        lightPtr->geom.line.lineTo.pathAtom.type = PATH_ATOM_L;
+        lightPtr->geom.line.lineTo.pathAtom.nextPtr = NULL;
+    }
+    itemPtr->bbox = NewEmptyPathRect();
+    itemPtr->totalBbox = NewEmptyPathRect();
+
+    if (optionTable == NULL) {
+	optionTable = Tk_CreateOptionTable(interp, optionSpecs);
+    }
+    itemPtr->optionTable = optionTable;
+    if (Tk_InitOptions(interp, (char *) lightPtr, optionTable,
+	    Tk_PathCanvasTkwin(canvas)) != TCL_OK) {
+        goto error;
+    }
+
+    for (i = 1; i < objc; i++) {
+        char *arg = Tcl_GetString(objv[i]);
+        if ((arg[0] == '-') && (arg[1] >= 'a') && (arg[1] <= 'z')) {
+            break;
+        }
+    }
+    if (LightCoords(interp, canvas, itemPtr, i, objv) != TCL_OK) {
+        goto error;
+    }
+    if (ConfigureLight(interp, canvas, itemPtr, objc-i, objv+i, 0) == TCL_OK) {
+        return TCL_OK;
+    }
+
+    error:
+    /*
+     * NB: We must unlink the item here since the TkPathCanvasItemLightConfigure()
+     *     link it to the root by default.
+     */
+    TkPathCanvasItemDetach(itemPtr);
+    DeleteLight(canvas, itemPtr, Tk_Display(Tk_PathCanvasTkwin(canvas)));
+    return TCL_ERROR;
+}
+
+static int
+LightCoords(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+        int objc, Tcl_Obj *CONST objv[])
+{
+    LightItem *lightPtr = (LightItem *) itemPtr;
+    double c[4];
+    int i, n;
+
+    n = (lightPtr->geom.pathAtom.type == PATH_ATOM_ELLIPSE) ? 3 : 4;
+    if (objc == 0) {
+        Tcl_Obj *obj = Tcl_NewObj();
+
+        switch (lightPtr->geom.pathAtom.type) {
+            case PATH_ATOM_ELLIPSE: {
+                EllipseAtom *ell = &lightPtr->geom.ellipse;
+                c[0] = ell->cx, c[1] = ell->cy, c[2] = ell->rx;
+                break;
+            }
+            case PATH_ATOM_RECT: {
+                RectAtom *rect = &lightPtr->geom.rect;
+                c[0] = rect->x, c[1] = rect->y;
+                c[2] = rect->x + rect->width, c[3] = rect->y + rect->height;
+                break;
+            }
+            default: {
+                c[0] = lightPtr->geom.line.moveTo.x;
+                c[1] = lightPtr->geom.line.moveTo.y;
+                c[2] = lightPtr->geom.line.lineTo.x;
+                c[3] = lightPtr->geom.line.lineTo.y;
+                break;
+            }
+        }
+        for (i = 0; i < n; i++) {
+            Tcl_ListObjAppendElement(interp, obj, Tcl_NewDoubleObj(c[i]));
+        }
+        Tcl_SetObjResult(interp, obj);
+        return TCL_OK;
+    }
+    if (objc == 1) {
+        if (Tcl_ListObjGetElements(interp, objv[0], &objc,
+            (Tcl_Obj ***) &objv) != TCL_OK) {
+            return TCL_ERROR;
+        }
+    }
+    if (objc != n) {
+        char buf[64 + TCL_INTEGER_SPACE];
+        sprintf(buf, "wrong # coordinates: expected %d, got %d", n, objc);
+        Tcl_SetResult(interp, buf, TCL_VOLATILE);
+        return TCL_ERROR;
+    }
+    for (i = 0; i < n; i++) {
+        if (Tk_PathCanvasGetCoordFromObj(interp, canvas, objv[i],
+                &c[i]) != TCL_OK) {
+            return TCL_ERROR;
+        }
+    }
+    switch (lightPtr->geom.pathAtom.type) {
+        case PATH_ATOM_ELLIPSE: {
+            EllipseAtom *ell = &lightPtr->geom.ellipse;
+            ell->cx = c[0];
+            ell->cy = c[1];
+            ell->rx = ell->ry = MAX(0.0, c[2]);
+            break;
+        }
+        case PATH_ATOM_RECT: {
+            RectAtom *rect = &lightPtr->geom.rect;
+            rect->x = MIN(c[0], c[2]);
+            rect->y = MIN(c[1], c[3]);
+            rect->width = fabs(c[2] - c[0]);
+            rect->height = fabs(c[3] - c[1]);
+            break;
+        }
+        default: {
+            lightPtr->geom.line.moveTo.x = c[0];
+            lightPtr->geom.line.moveTo.y = c[1];
+            lightPtr->geom.line.lineTo.x = c[2];
+            lightPtr->geom.line.lineTo.y = c[3];
+            break;
+        }
+    }
+    ComputeLightBbox(canvas, lightPtr);
+    return TCL_OK;
+}
+
+static void
+ComputeLightBbox(Tk_PathCanvas canvas, LightItem *lightPtr)
+{
+    Tk_PathItem *itemPtr = &lightPtr->headerLight.header;
+    Tk_PathStyle style;
+    Tk_PathState state = itemPtr->state;
+    PathAtom *atomPtr = &lightPtr->geom.pathAtom;
+
+    if (state == TK_PATHSTATE_NULL) {
+	state = TkPathCanvasState(canvas);
+    }
+    if (state == TK_PATHSTATE_HIDDEN) {
+        itemPtr->x1 = itemPtr->x2 = itemPtr->y1 = itemPtr->y2 = -1;
+        return;
+    }
+    style = TkPathCanvasInheritStyle(itemPtr, kPathMergeStyleNotFill);
+    itemPtr->bbox = GetGenericBarePathBbox(atomPtr);
+    itemPtr->totalBbox = GetGenericPathTotalBboxFromBare(
+            (atomPtr->type == PATH_ATOM_M) ? atomPtr : NULL,
+            &style, &itemPtr->bbox);
+    SetGenericPathHeaderBbox(itemPtr, style.matrixPtr, &itemPtr->totalBbox);
+    TkPathCanvasFreeInheritedStyle(&style);
+}
+
+static int
+ConfigureLight(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+        int objc, Tcl_Obj *CONST objv[], int flags)
+{
+    LightItem *lightPtr = (LightItem *) itemPtr;
+    Tk_Window tkwin;
+    Tk_SavedOptions savedOptions;
+    Tcl_Obj *errorResult = NULL;
+    int mask, error;
+
+    tkwin = Tk_PathCanvasTkwin(canvas);
+    for (error = 0; error <= 1; error++) {
+	if (!error) {
+	    if (Tk_SetOptions(interp, (char *) lightPtr, optionTable,
+		    objc, objv, tkwin, &savedOptions, &mask) != TCL_OK) {
+		continue;
+	    }
+	} else {
+	    errorResult = Tcl_GetObjResult(interp);
+	    Tcl_IncrRefCount(errorResult);
+	    Tk_RestoreSavedOptions(&savedOptions);
+	}
+	if (TkPathCanvasItemLightConfigure(interp, canvas,
+		&lightPtr->headerLight, mask) != TCL_OK) {
+	    continue;
+	}
+
+	/*
+	 * If we reach this on the first pass we are OK and continue below.
+	 */
+	break;
+    }
+    if (!error) {
+	Tk_FreeSavedOptions(&savedOptions);
+    }
+    if (error) {
+	Tcl_SetObjResult(interp, errorResult);
+	Tcl_DecrRefCount(errorResult);
+	return TCL_ERROR;
+    } else {
+	ComputeLightBbox(canvas, lightPtr);
+	return TCL_OK;
+    }
+}
+
+static void
+DeleteLight(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display)
+{
+    Tk_PathItemLight *itemLightPtr = (Tk_PathItemLight *) itemPtr;
+
+    if (itemLightPtr->styleInst != NULL) {
+	TkPathFreeStyle(itemLightPtr->styleInst);
+    }
+    Tk_FreeConfigOptions((char *) itemPtr, optionTable, Tk_PathCanvasTkwin(canvas));
+}
+
+static void
+DisplayLight(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display, Drawable drawable,
+        int x, int y, int width, int height)
+{
+    LightItem *lightPtr = (LightItem *) itemPtr;
+    TMatrix m = GetCanvasTMatrix(canvas);
+    Tk_PathStyle style;
+
+    /* === EB - 23-apr-2010: register coordinate offsets */
+    TkPathSetCoordOffsets(m.tx, m.ty);
+    /* === */
+
+    style = TkPathCanvasInheritStyle(itemPtr,
+            (lightPtr->geom.pathAtom.type == PATH_ATOM_M) ? kPathMergeStyleNotFill : 0);
+    TkPathDrawPath(Tk_PathCanvasTkwin(canvas), drawable, &lightPtr->geom.pathAtom,
+            &style, &m, &itemPtr->bbox);
+    TkPathCanvasFreeInheritedStyle(&style);
+}
+
+static void
+LightBbox(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int mask)
+{
+    LightItem *lightPtr = (LightItem *) itemPtr;
+    ComputeLightBbox(canvas, lightPtr);
+}
+
+static double
+LightToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *pointPtr)
+{
+    LightItem *lightPtr = (LightItem *) itemPtr;
+    PathAtom *atomPtr = &lightPtr->geom.pathAtom;
+    Tk_PathStyle style;
+    double dist;
+
+    if (atomPtr->type == PATH_ATOM_M) {
+        style = TkPathCanvasInheritStyle(itemPtr, kPathMergeStyleNotFill);
+        dist = GenericPathToPoint(canvas, itemPtr, &style, atomPtr, 2, pointPtr);
+    } else {
+        style = TkPathCanvasInheritStyle(itemPtr, 0);
+        dist = PathShapeToPoint(canvas, itemPtr, &style, atomPtr, pointPtr);
+    }
+    TkPathCanvasFreeInheritedStyle(&style);
+    return dist;
+}
+
+static int
+LightToArea(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *areaPtr)
+{
+    LightItem *lightPtr = (LightItem *) itemPtr;
+    PathAtom *atomPtr = &lightPtr->geom.pathAtom;
+    Tk_PathStyle style;
+    int area;
+
+    if (atomPtr->type == PATH_ATOM_M) {
+        style = TkPathCanvasInheritStyle(itemPtr, kPathMergeStyleNotFill);
+        area = GenericPathToArea(canvas, itemPtr, &style, atomPtr, 2, areaPtr);
+    } else {
+        style = TkPathCanvasInheritStyle(itemPtr, 0);
+        area = PathShapeToArea(canvas, itemPtr, &style, atomPtr, areaPtr);
+    }
+    TkPathCanvasFreeInheritedStyle(&style);
+    return area;
+}
+
+static int
+LightToPostscript(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int prepass)
+{
+    return TCL_ERROR;
+}
+
+static void
+ScaleLight(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double originX, double originY,
+        double scaleX, double scaleY)
+{
+    LightItem *lightPtr = (LightItem *) itemPtr;
+
+    switch (lightPtr->geom.pathAtom.type) {
+        case PATH_ATOM_ELLIPSE: {
+            EllipseAtom *ell = &lightPtr->geom.ellipse;
+
+            ell->cx = originX + scaleX*(ell->cx - originX);
+            ell->cy = originY + scaleY*(ell->cy - originY);
+            ell->rx *= fabs(scaleX);
+            ell->ry *= fabs(scaleY);
+            break;
+        }
+        case PATH_ATOM_RECT: {
+            RectAtom *rect = &lightPtr->geom.rect;
+            double x1, y1, x2, y2;
+
+            x1 = originX + scaleX*(rect->x - originX);
+            y1 = originY + scaleY*(rect->y - originY);
+            x2 = originX + scaleX*(rect->x + rect->width - originX);
+            y2 = originY + scaleY*(rect->y + rect->height - originY);
+            rect->x = MIN(x1, x2);
+            rect->y = MIN(y1, y2);
+            rect->width = fabs(x2 - x1);
+            rect->height = fabs(y2 - y1);
+            break;
+        }
+        default: {
+            ScalePathAtoms(&lightPtr->geom.pathAtom, originX, originY,
+                    scaleX, scaleY);
+            break;
+        }
+    }
+    ScalePathRect(&itemPtr->bbox, originX, originY, scaleX, scaleY);
+    ScalePathRect(&itemPtr->totalBbox, originX, originY, scaleX, scaleY);
+    ScaleItemHeader(itemPtr, originX, originY, scaleX, scaleY);
+}
+
+static void
+TranslateLight(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double deltaX, double deltaY)
+{
+    LightItem *lightPtr = (LightItem *) itemPtr;
+
+    switch (lightPtr->geom.pathAtom.type) {
+        case PATH_ATOM_ELLIPSE: {
+            lightPtr->geom.ellipse.cx += deltaX;
+            lightPtr->geom.ellipse.cy += deltaY;
+            break;
+        }
+        case PATH_ATOM_RECT: {
+            lightPtr->geom.rect.x += deltaX;
+            lightPtr->geom.rect.y += deltaY;
+            break;
+        }
+        default: {
+            TranslatePathAtoms(&lightPtr->geom.pathAtom, deltaX, deltaY);
+            break;
+        }
+    }
+    TranslatePathRect(&itemPtr->bbox, deltaX, deltaY);
+    TranslatePathRect(&itemPtr->totalBbox, deltaX, deltaY);
+    TranslateItemHeader(itemPtr, deltaX, deltaY);
+}
+
+/*----------------------------------------------------------------------*/
+
@@ -0,0 +1,700 @@
+/*
+ * tkCanvMulti.c --
+ *
+ *	This file implements the circles and prects canvas items which
+ *	hold many shapes with a common style in a single item. The
+ *	shapes are kept as one packed array of ellipse or rect atoms
+ *	which is drawn as one path.
+ *
+ * Copyright (c) 2026  tkpath contributors
+ *
+ * $Id$
+ */
+
+#include "tkIntPath.h"
+#include "tkpCanvas.h"
+#include "tkCanvPathUtil.h"
+#include "tkPathStyle.h"
+
+/*
+ * EllipseAtom and RectAtom have the same layout, so both kinds of shapes
+ * are stored in one array of these.
+ */
+
+typedef union MultiShape {
+    PathAtom pathAtom;
+    EllipseAtom ellipse;
+    RectAtom rect;
+} MultiShape;
+
+/*
+ * The structure below defines the record for each circles and prects item.
+ */
+
+typedef struct MultiItem  {
+    Tk_PathItemEx headerEx; /* Generic stuff that's the same for all
+                             * path types.  MUST BE FIRST IN STRUCTURE. */
+    char type;		    /* Circles or prects. */
+    PathAtom *atomPtr;	    /* The shapes linked as atoms, or NULL. */
+    MultiShape *shapesPtr;  /* One block for all shapes. */
+    int numShapes;	    /* Number of shapes in shapesPtr. */
+} MultiItem;
+
+enum {
+    kMultiTypeCircles,
+    kMultiTypePrects
+};
+
+/*
+ * Number of coordinates for each shape.
+ */
+
+#define MULTI_STRIDE(multiPtr) \
+    (((multiPtr)->type == kMultiTypeCircles) ? 3 : 4)
+
+/*
+ * Prototypes for procedures defined in this file:
+ */
+
+static void	ComputeMultiBbox(Tk_PathCanvas canvas, MultiItem *multiPtr);
+static int	ConfigureMulti(Tcl_Interp *interp, Tk_PathCanvas canvas,
+		    Tk_PathItem *itemPtr, int objc,
+		    Tcl_Obj *CONST objv[], int flags);
+static int	CreateAny(Tcl_Interp *interp, Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
+		    int objc, Tcl_Obj *CONST objv[], char type);
+static int	CreateCircles(Tcl_Interp *interp,
+		    Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
+		    int objc, Tcl_Obj *CONST objv[]);
+static int	CreatePrects(Tcl_Interp *interp,
+		    Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
+		    int objc, Tcl_Obj *CONST objv[]);
+static void	DeleteMulti(Tk_PathCanvas canvas,
+		    Tk_PathItem *itemPtr, Display *display);
+static void	DisplayMulti(Tk_PathCanvas canvas,
+		    Tk_PathItem *itemPtr, Display *display, Drawable drawable,
+		    int x, int y, int width, int height);
+static void	MultiBbox(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+		    int mask);
+static int	MultiCoords(Tcl_Interp *interp,
+		    Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+		    int objc, Tcl_Obj *CONST objv[]);
+static int	MultiIndex(Tcl_Interp *interp, Tk_PathCanvas canvas,
+		    Tk_PathItem *itemPtr, char *indexString, int *indexPtr);
+static int	MultiToArea(Tk_PathCanvas canvas,
+		    Tk_PathItem *itemPtr, double *rectPtr);
+static double	MultiToPoint(Tk_PathCanvas canvas,
+		    Tk_PathItem *itemPtr, double *coordPtr);
+static int	MultiToPostscript(Tcl_Interp *interp,
+		    Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int prepass);
+static void	ScaleMulti(Tk_PathCanvas canvas,
+		    Tk_PathItem *itemPtr, double originX, double originY,
+		    double scaleX, double scaleY);
+static void	TranslateMulti(Tk_PathCanvas canvas,
+		    Tk_PathItem *itemPtr, double deltaX, double deltaY);
+
+PATH_STYLE_CUSTOM_OPTION_RECORDS
+PATH_CUSTOM_OPTION_TAGS
+PATH_OPTION_STRING_TABLES_FILL
+PATH_OPTION_STRING_TABLES_STROKE
+PATH_OPTION_STRING_TABLES_STATE
+
+static Tk_OptionSpec optionSpecs[] = {
+    PATH_OPTION_SPEC_CORE(Tk_PathItemEx),
+    PATH_OPTION_SPEC_PARENT,
+    PATH_OPTION_SPEC_STYLE_FILL(Tk_PathItemEx, ""),
+    PATH_OPTION_SPEC_STYLE_MATRIX(Tk_PathItemEx),
+    PATH_OPTION_SPEC_STYLE_STROKE(Tk_PathItemEx, "black"),
+    PATH_OPTION_SPEC_END
+};
+
+static Tk_OptionTable optionTable = NULL;
+
+/*
+ * The structures below define the 'circles' and 'prects' item types by means
+ * of procedures that can be invoked by generic item code.
+ */
+
+Tk_PathItemType tkCirclesType = {
+    "circles",				/* name */
+    sizeof(MultiItem),			/* itemSize */
+    CreateCircles,			/* createProc */
+    optionSpecs,			/* optionSpecs */
+    ConfigureMulti,			/* configureProc */
+    MultiCoords,			/* coordProc */
+    DeleteMulti,			/* deleteProc */
+    DisplayMulti,			/* displayProc */
+    0,					/* flags */
+    MultiBbox,				/* bboxProc */
+    MultiToPoint,			/* pointProc */
+    MultiToArea,			/* areaProc */
+    MultiToPostscript,			/* postscriptProc */
+    ScaleMulti,				/* scaleProc */
+    TranslateMulti,			/* translateProc */
+    MultiIndex,				/* indexProc */
+    (Tk_PathItemCursorProc *) NULL,	/* icursorProc */
+    (Tk_PathItemSelectionProc *) NULL,	/* selectionProc */
+    (Tk_PathItemInsertProc *) NULL,	/* insertProc */
+    (Tk_PathItemDCharsProc *) NULL,	/* dTextProc */
+    (Tk_PathItemType *) NULL,		/* nextPtr */
+    (Tk_PathItemAppendProc *) NULL,	/* appendProc */
+};
+
+Tk_PathItemType tkPrectsType = {
+    "prects",				/* name */
+    sizeof(MultiItem),			/* itemSize */
+    CreatePrects,			/* createProc */
+    optionSpecs,			/* optionSpecs */
+    ConfigureMulti,			/* configureProc */
+    MultiCoords,			/* coordProc */
+    DeleteMulti,			/* deleteProc */
+    DisplayMulti,			/* displayProc */
+    0,					/* flags */
+    MultiBbox,				/* bboxProc */
+    MultiToPoint,			/* pointProc */
+    MultiToArea,			/* areaProc */
+    MultiToPostscript,			/* postscriptProc */
+    ScaleMulti,				/* scaleProc */
+    TranslateMulti,			/* translateProc */
+    MultiIndex,				/* indexProc */
+    (Tk_PathItemCursorProc *) NULL,	/* icursorProc */
+    (Tk_PathItemSelectionProc *) NULL,	/* selectionProc */
+    (Tk_PathItemInsertProc *) NULL,	/* insertProc */
+    (Tk_PathItemDCharsProc *) NULL,	/* dTextProc */
+    (Tk_PathItemType *) NULL,		/* nextPtr */
+    (Tk_PathItemAppendProc *) NULL,	/* appendProc */
+};
+
+static int
+CreateCircles(Tcl_Interp *interp, Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
+        int objc, Tcl_Obj *CONST objv[])
+{
+    return CreateAny(interp, canvas, itemPtr, objc, objv, kMultiTypeCircles);
+}
+
+static int
+CreatePrects(Tcl_Interp *interp, Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
+        int objc, Tcl_Obj *CONST objv[])
+{
+    return CreateAny(interp, canvas, itemPtr, objc, objv, kMultiTypePrects);
+}
+
+static int
+CreateAny(Tcl_Interp *interp, Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
+        int objc, Tcl_Obj *CONST objv[], char type)
+{
+    MultiItem *multiPtr = (MultiItem *) itemPtr;
+    Tk_PathItemEx *itemExPtr = &multiPtr->headerEx;
+    int	i;
+
+    if (objc == 0) {
+        Tcl_Panic("canvas did not pass any coords\n");
+    }
+
+    /*
+     * Carry out initialization that is needed to set defaults and to
+     * allow proper cleanup after errors during the the remainder of
+     * this procedure.
+     */
+    TkPathInitStyle(&itemExPtr->style);
+    itemExPtr->canvas = canvas;
+    itemExPtr->styleObj = NULL;
+    itemExPtr->styleInst = NULL;
+    multiPtr->type = type;
+    multiPtr->atomPtr = NULL;
+    multiPtr->shapesPtr = NULL;
+    multiPtr->numShapes = 0;
+    itemPtr->bbox = NewEmptyPathRect();
+    itemPtr->totalBbox = NewEmptyPathRect();
+
+    if (optionTable == NULL) {
+	optionTable = Tk_CreateOptionTable(interp, optionSpecs);
+    }
+    itemPtr->optionTable = optionTable;
+    if (Tk_InitOptions(interp, (char *) multiPtr, optionTable,
+	    Tk_PathCanvasTkwin(canvas)) != TCL_OK) {
+        goto error;
+    }
+
+    for (i = 1; i < objc; i++) {
+        char *arg = Tcl_GetString(objv[i]);
+        if ((arg[0] == '-') && (arg[1] >= 'a') && (arg[1] <= 'z')) {
+            break;
+        }
+    }
+    if (MultiCoords(interp, canvas, itemPtr, i, objv) != TCL_OK) {
+        goto error;
+    }
+    if (ConfigureMulti(interp, canvas, itemPtr, objc-i, objv+i, 0) == TCL_OK) {
+        return TCL_OK;
+    }
+
+    error:
+    /*
+     * NB: We must unlink the item here since the TkPathCanvasItemExConfigure()
+     *     link it to the root by default.
+     */
+    TkPathCanvasItemDetach(itemPtr);
+    DeleteMulti(canvas, itemPtr, Tk_Display(Tk_PathCanvasTkwin(canvas)));
+    return TCL_ERROR;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * MultiCoords --
+ *
+ *	Gets or sets the shapes: x y r for each circle and x1 y1 x2 y2
+ *	for each rectangle. Coordinates are parsed before the item is
+ *	changed so that it is intact on errors.
+ *
+ * Results:
+ *	Standard tcl result.
+ *
+ * Side effects:
+ *	The shapes may be replaced.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+MultiCoords(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+        int objc, Tcl_Obj *CONST objv[])
+{
+    MultiItem *multiPtr = (MultiItem *) itemPtr;
+    MultiShape *shapePtr;
+    double *coords, *p;
+    int i, stride = MULTI_STRIDE(multiPtr);
+
+    if (objc == 0) {
+        Tcl_Obj **objs;
+        Tcl_Obj *obj;
+        int n = 0;
+
+        objs = (Tcl_Obj **) ckalloc((unsigned)
+                ((stride * multiPtr->numShapes + 1) * sizeof(Tcl_Obj *)));
+        for (i = 0, shapePtr = multiPtr->shapesPtr; i < multiPtr->numShapes;
+                i++, shapePtr++) {
+            if (multiPtr->type == kMultiTypeCircles) {
+                objs[n++] = Tcl_NewDoubleObj(shapePtr->ellipse.cx);
+                objs[n++] = Tcl_NewDoubleObj(shapePtr->ellipse.cy);
+                objs[n++] = Tcl_NewDoubleObj(shapePtr->ellipse.rx);
+            } else {
+                objs[n++] = Tcl_NewDoubleObj(shapePtr->rect.x);
+                objs[n++] = Tcl_NewDoubleObj(shapePtr->rect.y);
+                objs[n++] = Tcl_NewDoubleObj(shapePtr->rect.x + shapePtr->rect.width);
+                objs[n++] = Tcl_NewDoubleObj(shapePtr->rect.y + shapePtr->rect.height);
+            }
+        }
+        obj = Tcl_NewListObj(n, objs);
+        ckfree((char *) objs);
+        Tcl_SetObjResult(interp, obj);
+        return TCL_OK;
+    }
+    if (objc == 1) {
+        if (Tcl_ListObjGetElements(interp, objv[0], &objc,
+            (Tcl_Obj ***) &objv) != TCL_OK) {
+            return TCL_ERROR;
+        }
+    }
+    if (objc % stride != 0) {
+        char buf[64 + TCL_INTEGER_SPACE];
+        sprintf(buf, "wrong # coordinates: expected a multiple of %d, got %d",
+                stride, objc);
+        Tcl_SetResult(interp, buf, TCL_VOLATILE);
+        return TCL_ERROR;
+    }
+    coords = (double *) ckalloc((unsigned) ((objc + 1) * sizeof(double)));
+    for (i = 0; i < objc; i++) {
+        if ((Tcl_GetDoubleFromObj(NULL, objv[i], &coords[i]) != TCL_OK)
+                && (Tk_PathCanvasGetCoordFromObj(interp, canvas, objv[i],
+                &coords[i]) != TCL_OK)) {
+            ckfree((char *) coords);
+            return TCL_ERROR;
+        }
+    }
+    if (multiPtr->shapesPtr != NULL) {
+        ckfree((char *) multiPtr->shapesPtr);
+    }
+    multiPtr->numShapes = objc/stride;
+    multiPtr->shapesPtr = (MultiShape *) ckalloc((unsigned)
+            (MAX(1, multiPtr->numShapes) * sizeof(MultiShape)));
+    for (i = 0, p = coords, shapePtr = multiPtr->shapesPtr;
+            i < multiPtr->numShapes; i++, p += stride, shapePtr++) {
+        shapePtr->pathAtom.nextPtr = (PathAtom *) (shapePtr + 1);
+        if (multiPtr->type == kMultiTypeCircles) {
+            shapePtr->pathAtom.type = PATH_ATOM_ELLIPSE;
+            shapePtr->ellipse.cx = p[0];
+            shapePtr->ellipse.cy = p[1];
+            shapePtr->ellipse.rx = shapePtr->ellipse.ry = MAX(0.0, p[2]);
+        } else {
+            shapePtr->pathAtom.type = PATH_ATOM_RECT;
+            shapePtr->rect.x = MIN(p[0], p[2]);
+            shapePtr->rect.y = MIN(p[1], p[3]);
+            shapePtr->rect.width = fabs(p[2] - p[0]);
+            shapePtr->rect.height = fabs(p[3] - p[1]);
+        }
+    }
+    ckfree((char *) coords);
+    if (multiPtr->numShapes > 0) {
+        multiPtr->shapesPtr[multiPtr->numShapes-1].pathAtom.nextPtr = NULL;
+        multiPtr->atomPtr = (PathAtom *) multiPtr->shapesPtr;
+    } else {
+        multiPtr->atomPtr = NULL;
+    }
+    ComputeMultiBbox(canvas, multiPtr);
+    return TCL_OK;
+}
+
+static void
+ComputeMultiBbox(Tk_PathCanvas canvas, MultiItem *multiPtr)
+{
+    Tk_PathItemEx *itemExPtr = &multiPtr->headerEx;
+    Tk_PathItem *itemPtr = &itemExPtr->header;
+    Tk_PathStyle style;
+    Tk_PathState state = itemExPtr->header.state;
+
+    if (state == TK_PATHSTATE_NULL) {
+	state = TkPathCanvasState(canvas);
+    }
+    if ((multiPtr->atomPtr == NULL) || (state == TK_PATHSTATE_HIDDEN)) {
+        itemExPtr->header.x1 = itemExPtr->header.x2 =
+        itemExPtr->header.y1 = itemExPtr->header.y2 = -1;
+        return;
+    }
+    style = TkPathCanvasInheritStyle(itemPtr, kPathMergeStyleNotFill);
+    itemPtr->bbox = GetGenericBarePathBbox(multiPtr->atomPtr);
+    itemPtr->totalBbox = GetGenericPathTotalBboxFromBare(NULL,
+            &style, &itemPtr->bbox);
+    SetGenericPathHeaderBbox(&itemExPtr->header, style.matrixPtr, &itemPtr->totalBbox);
+    TkPathCanvasFreeInheritedStyle(&style);
+}
+
+static int
+ConfigureMulti(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+        int objc, Tcl_Obj *CONST objv[], int flags)
+{
+    MultiItem *multiPtr = (MultiItem *) itemPtr;
+    Tk_PathItemEx *itemExPtr = &multiPtr->headerEx;
+    Tk_PathStyle *stylePtr = &itemExPtr->style;
+    Tk_Window tkwin;
+    Tk_SavedOptions savedOptions;
+    Tcl_Obj *errorResult = NULL;
+    int mask, error;
+
+    tkwin = Tk_PathCanvasTkwin(canvas);
+    for (error = 0; error <= 1; error++) {
+	if (!error) {
+	    if (Tk_SetOptions(interp, (char *) multiPtr, optionTable,
+		    objc, objv, tkwin, &savedOptions, &mask) != TCL_OK) {
+		continue;
+	    }
+	} else {
+	    errorResult = Tcl_GetObjResult(interp);
+	    Tcl_IncrRefCount(errorResult);
+	    Tk_RestoreSavedOptions(&savedOptions);
+	}
+	if (TkPathCanvasItemExConfigure(interp, canvas, itemExPtr, mask) != TCL_OK) {
+	    continue;
+	}
+
+	/*
+	 * If we reach this on the first pass we are OK and continue below.
+	 */
+	break;
+    }
+    if (!error) {
+	Tk_FreeSavedOptions(&savedOptions);
+	stylePtr->mask |= mask;
+    }
+
+    stylePtr->strokeOpacity = MAX(0.0, MIN(1.0, stylePtr->strokeOpacity));
+    stylePtr->fillOpacity   = MAX(0.0, MIN(1.0, stylePtr->fillOpacity));
+    if (error) {
+	Tcl_SetObjResult(interp, errorResult);
+	Tcl_DecrRefCount(errorResult);
+	return TCL_ERROR;
+    } else {
+	ComputeMultiBbox(canvas, multiPtr);
+	return TCL_OK;
+    }
+}
+
+static void
+DeleteMulti(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display)
+{
+    MultiItem *multiPtr = (MultiItem *) itemPtr;
+    Tk_PathItemEx *itemExPtr = &multiPtr->headerEx;
+    Tk_PathStyle *stylePtr = &itemExPtr->style;
+
+    if (stylePtr->fill != NULL) {
+	TkPathFreePathColor(stylePtr->fill);
+    }
+    if (itemExPtr->styleInst != NULL) {
+	TkPathFreeStyle(itemExPtr->styleInst);
+    }
+    if (multiPtr->shapesPtr != NULL) {
+        ckfree((char *) multiPtr->shapesPtr);
+        multiPtr->shapesPtr = NULL;
+        multiPtr->atomPtr = NULL;
+    }
+    Tk_FreeConfigOptions((char *) itemPtr, optionTable, Tk_PathCanvasTkwin(canvas));
+}
+
+static void
+DisplayMulti(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display, Drawable drawable,
+        int x, int y, int width, int height)
+{
+    MultiItem *multiPtr = (MultiItem *) itemPtr;
+    TMatrix m = GetCanvasTMatrix(canvas);
+    Tk_PathStyle style;
+
+    /* === EB - 23-apr-2010: register coordinate offsets */
+    TkPathSetCoordOffsets(m.tx, m.ty);
+    /* === */
+
+    if (multiPtr->atomPtr == NULL) {
+        return;
+    }
+
+    /* All shapes go into a single path. */
+    style = TkPathCanvasInheritStyle(itemPtr, 0);
+    TkPathDrawPath(Tk_PathCanvasTkwin(canvas), drawable, multiPtr->atomPtr,
+            &style, &m, &itemPtr->bbox);
+    TkPathCanvasFreeInheritedStyle(&style);
+}
+
+static void
+MultiBbox(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int mask)
+{
+    MultiItem *multiPtr = (MultiItem *) itemPtr;
+    ComputeMultiBbox(canvas, multiPtr);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * MultiToPoint --
+ *
+ *	Computes the distance from a given point to the closest shape
+ *	of the item. Shapes whose bounding box is further away than
+ *	the best distance so far are skipped.
+ *
+ * Results:
+ *	The distance in canvas units.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static double
+MultiToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *pointPtr)
+{
+    MultiItem *multiPtr = (MultiItem *) itemPtr;
+    MultiShape *shapePtr;
+    Tk_PathStyle style;
+    double dist, best = 1.0e36;
+    int i;
+
+    style = TkPathCanvasInheritStyle(itemPtr, 0);
+    for (i = 0, shapePtr = multiPtr->shapesPtr; i < multiPtr->numShapes;
+            i++, shapePtr++) {
+        if (style.matrixPtr == NULL) {
+            double half = (style.strokeColor != NULL) ? style.strokeWidth/2.0 : 0.0;
+            double dx, dy;
+            PathRect r;
+
+            if (multiPtr->type == kMultiTypeCircles) {
+                r.x1 = shapePtr->ellipse.cx - shapePtr->ellipse.rx;
+                r.x2 = shapePtr->ellipse.cx + shapePtr->ellipse.rx;
+                r.y1 = shapePtr->ellipse.cy - shapePtr->ellipse.ry;
+                r.y2 = shapePtr->ellipse.cy + shapePtr->ellipse.ry;
+            } else {
+                r.x1 = shapePtr->rect.x;
+                r.x2 = shapePtr->rect.x + shapePtr->rect.width;
+                r.y1 = shapePtr->rect.y;
+                r.y2 = shapePtr->rect.y + shapePtr->rect.height;
+            }
+            dx = MAX(0.0, MAX(r.x1 - half - pointPtr[0], pointPtr[0] - r.x2 - half));
+            dy = MAX(0.0, MAX(r.y1 - half - pointPtr[1], pointPtr[1] - r.y2 - half));
+            if (dx*dx + dy*dy >= best*best) {
+                continue;
+            }
+        }
+        dist = PathShapeToPoint(canvas, itemPtr, &style, &shapePtr->pathAtom,
+                pointPtr);
+        if (dist < best) {
+            best = dist;
+            if (best <= 0.0) {
+                break;
+            }
+        }
+    }
+    TkPathCanvasFreeInheritedStyle(&style);
+    return best;
+}
+
+static int
+MultiToArea(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *areaPtr)
+{
+    MultiItem *multiPtr = (MultiItem *) itemPtr;
+    MultiShape *shapePtr;
+    Tk_PathStyle style;
+    int i, area, result = -1;
+
+    style = TkPathCanvasInheritStyle(itemPtr, 0);
+    for (i = 0, shapePtr = multiPtr->shapesPtr; i < multiPtr->numShapes;
+            i++, shapePtr++) {
+        area = PathShapeToArea(canvas, itemPtr, &style, &shapePtr->pathAtom,
+                areaPtr);
+        if (i == 0) {
+            result = area;
+        } else if (area != result) {
+            result = 0;
+        }
+        if (result == 0) {
+            break;
+        }
+    }
+    TkPathCanvasFreeInheritedStyle(&style);
+    return result;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * MultiIndex --
+ *
+ *	Parses an index into the shapes of the item: an integer,
+ *	"end", or "@x,y" for the topmost shape within the canvas
+ *	-closeenough distance of the canvas point x,y, or -1 if none.
+ *
+ * Results:
+ *	Standard tcl result.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+MultiIndex(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+        char *indexString, int *indexPtr)
+{
+    MultiItem *multiPtr = (MultiItem *) itemPtr;
+    Tcl_Obj *obj = (Tcl_Obj *) indexString;
+    char *string = Tcl_GetString(obj);
+
+    if (strcmp(string, "end") == 0) {
+        *indexPtr = multiPtr->numShapes - 1;
+    } else if (string[0] == '@') {
+        TkPathCanvas *canvasPtr = (TkPathCanvas *) canvas;
+        Tk_PathStyle style;
+        double point[2];
+        char *end, *p;
+        int i;
+
+        p = string+1;
+        point[0] = strtod(p, &end);
+        if ((end == p) || (*end != ',')) {
+            goto badIndex;
+        }
+        p = end+1;
+        point[1] = strtod(p, &end);
+        if ((end == p) || (*end != 0)) {
+            goto badIndex;
+        }
+        *indexPtr = -1;
+        style = TkPathCanvasInheritStyle(itemPtr, 0);
+        for (i = multiPtr->numShapes - 1; i >= 0; i--) {
+            if (PathShapeToPoint(canvas, itemPtr, &style,
+                    &multiPtr->shapesPtr[i].pathAtom, point)
+                    <= canvasPtr->closeEnough) {
+                *indexPtr = i;
+                break;
+            }
+        }
+        TkPathCanvasFreeInheritedStyle(&style);
+    } else if (Tcl_GetIntFromObj(NULL, obj, indexPtr) == TCL_OK) {
+        if (*indexPtr < 0) {
+            *indexPtr = 0;
+        } else if (*indexPtr >= multiPtr->numShapes) {
+            *indexPtr = multiPtr->numShapes - 1;
+        }
+    } else {
+    badIndex:
+	Tcl_SetResult(interp, NULL, TCL_STATIC);
+	Tcl_AppendResult(interp, "bad index \"", string, "\"", NULL);
+	return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+static int
+MultiToPostscript(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int prepass)
+{
+    return TCL_ERROR;
+}
+
+static void
+ScaleMulti(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double originX, double originY,
+        double scaleX, double scaleY)
+{
+    MultiItem *multiPtr = (MultiItem *) itemPtr;
+    MultiShape *shapePtr;
+    double x1, y1, x2, y2;
+    int i;
+
+    for (i = 0, shapePtr = multiPtr->shapesPtr; i < multiPtr->numShapes;
+            i++, shapePtr++) {
+        if (multiPtr->type == kMultiTypeCircles) {
+            EllipseAtom *ell = &shapePtr->ellipse;
+
+            ell->cx = originX + scaleX*(ell->cx - originX);
+            ell->cy = originY + scaleY*(ell->cy - originY);
+            ell->rx *= fabs(scaleX);
+            ell->ry *= fabs(scaleY);
+        } else {
+            RectAtom *rect = &shapePtr->rect;
+
+            x1 = originX + scaleX*(rect->x - originX);
+            y1 = originY + scaleY*(rect->y - originY);
+            x2 = originX + scaleX*(rect->x + rect->width - originX);
+            y2 = originY + scaleY*(rect->y + rect->height - originY);
+            rect->x = MIN(x1, x2);
+            rect->y = MIN(y1, y2);
+            rect->width = fabs(x2 - x1);
+            rect->height = fabs(y2 - y1);
+        }
+    }
+    ScalePathRect(&itemPtr->bbox, originX, originY, scaleX, scaleY);
+    ScalePathRect(&itemPtr->totalBbox, originX, originY, scaleX, scaleY);
+    ScaleItemHeader(itemPtr, originX, originY, scaleX, scaleY);
+}
+
+static void
+TranslateMulti(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double deltaX, double deltaY)
+{
+    MultiItem *multiPtr = (MultiItem *) itemPtr;
+    MultiShape *shapePtr;
+    int i;
+
+    for (i = 0, shapePtr = multiPtr->shapesPtr; i < multiPtr->numShapes;
+            i++, shapePtr++) {
+        if (multiPtr->type == kMultiTypeCircles) {
+            shapePtr->ellipse.cx += deltaX;
+            shapePtr->ellipse.cy += deltaY;
+        } else {
+            shapePtr->rect.x += deltaX;
+            shapePtr->rect.y += deltaY;
+        }
+    }
+    TranslatePathRect(&itemPtr->bbox, deltaX, deltaY);
+    TranslatePathRect(&itemPtr->totalBbox, deltaX, deltaY);
+    TranslateItemHeader(itemPtr, deltaX, deltaY);
+}
+
+/*----------------------------------------------------------------------*/
+
@@ -41,6 +41,8 @@ typedef struct PathItem  {
     ArrowDescr startarrow;
     ArrowDescr endarrow;
     long flags;             /* Various flags, see enum. */
+    int lod;                /* Draw simplified atoms. */
+    PathLodCache lodCache;  /* The simplified atoms for -lod. */
 } PathItem;
 
 
@@ -83,7 +85,6 @@ static int      ConfigureArrows(Tk_PathCanvas canvas, PathItem *pathPtr);
 
 /* Support functions. */
 
-static int		GetSubpathMaxNumSegments(PathAtom *atomPtr);
 
 
 PATH_STYLE_CUSTOM_OPTION_RECORDS
@@ -100,6 +101,7 @@ static Tk_OptionSpec optionSpecs[] = {
     PATH_OPTION_SPEC_STYLE_STROKE(Tk_PathItemEx, "black"),
     PATH_OPTION_SPEC_STARTARROW_GRP(PathItem),
     PATH_OPTION_SPEC_ENDARROW_GRP(PathItem),
+    PATH_OPTION_SPEC_LOD(PathItem),
     PATH_OPTION_SPEC_END
 };
 
@@ -132,6 +134,7 @@ Tk_PathItemType tkPathType = {
     (Tk_PathItemInsertProc *) NULL,	/* insertProc */
     (Tk_PathItemDCharsProc *) NULL,	/* dTextProc */
     (Tk_PathItemType *) NULL,		/* nextPtr */
+    (Tk_PathItemAppendProc *) NULL,	/* appendProc */
 };
 
 void
@@ -223,6 +226,8 @@ CreatePath(
     TkPathArrowDescrInit(&pathPtr->startarrow);
     TkPathArrowDescrInit(&pathPtr->endarrow);
     pathPtr->flags = 0L;
+    pathPtr->lod = 0;
+    PathLodInit(&pathPtr->lodCache);
     
     /* Forces a computation of the normalized path in PathCoords. */
     pathPtr->flags |= kPathItemNeedNewNormalizedPath;
@@ -312,6 +317,7 @@ ProcessPath(
             if (pathPtr->atomPtr != NULL) {
                 TkPathFreeAtoms(pathPtr->atomPtr);
             }
+            PathLodFree(&pathPtr->lodCache);
             pathPtr->atomPtr = atomPtr;
             pathPtr->pathLen = len;
             if (pathPtr->pathObjPtr != NULL) {
@@ -524,6 +530,8 @@ ConfigurePath(
     }
 #endif    
 
+    /* Arrows or -lod may have changed. */
+    PathLodFree(&pathPtr->lodCache);
     ConfigureArrows(canvas, pathPtr);
 
     /*
@@ -583,6 +591,7 @@ DeletePath(
         TkPathFreeAtoms(pathPtr->atomPtr);
         pathPtr->atomPtr = NULL;
     }
+    PathLodFree(&pathPtr->lodCache);
     TkPathFreeArrow(&pathPtr->startarrow);
     TkPathFreeArrow(&pathPtr->endarrow);
     Tk_FreeConfigOptions((char *) pathPtr, optionTable, Tk_PathCanvasTkwin(canvas));
@@ -625,14 +634,18 @@ DisplayPath(
     /* === */
     
     if (pathPtr->pathLen > 2) {
+        PathAtom *atomPtr = pathPtr->atomPtr;
+        
         style = TkPathCanvasInheritStyle(itemPtr, 0);
-        TkPathDrawPath(Tk_PathCanvasTkwin(canvas), drawable, pathPtr->atomPtr, 
-                &style, &m, &itemPtr->bbox);
+        if (pathPtr->lod) {
+            atomPtr = PathLodGetAtoms(canvas, &pathPtr->lodCache, atomPtr,
+                    style.matrixPtr);
+        }
         /*
-         * Display arrowheads, if they are wanted.
+         * Display arrowheads, if they are wanted, in the same context.
          */
-        DisplayArrow(canvas, drawable, &pathPtr->startarrow, &style, &m, &itemPtr->bbox);
-        DisplayArrow(canvas, drawable, &pathPtr->endarrow, &style, &m, &itemPtr->bbox);
+        DisplayPathWithArrows(canvas, drawable, atomPtr, &style, &m,
+                &itemPtr->bbox, &pathPtr->startarrow, &pathPtr->endarrow);
 
         TkPathCanvasFreeInheritedStyle(&style);
     }
@@ -789,7 +802,7 @@ GetArcNumSegments(double currentX, double currentY, ArcAtom *arc)
     return numSteps;
 }
 
-static int
+int
 GetSubpathMaxNumSegments(PathAtom *atomPtr)
 {
     int			num;
@@ -942,6 +955,7 @@ ScalePath(
     /* @@@ TODO: Arc atoms with nonzero rotation angle is WRONG! */
 
     ScalePathAtoms(atomPtr, originX, originY, scaleX, scaleY);
+    PathLodFree(&pathPtr->lodCache);
     
     /* 
      * Set flags bit so we know that PathCoords need to update the
@@ -990,6 +1004,7 @@ TranslatePath(
     PathAtom *atomPtr = pathPtr->atomPtr;
     
     TranslatePathAtoms(atomPtr, deltaX, deltaY);
+    PathLodFree(&pathPtr->lodCache);
     
     /* 
      * Set flags bit so we know that PathCoords need to update the
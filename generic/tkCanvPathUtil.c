@@ -31,6 +31,13 @@ static void		MakeSubPathSegments(PathAtom **atomPtrPtr, double *polyPtr,
                         int *numPointsPtr, int *numStrokesPtr, TMatrix *matrixPtr);
 static int		SubPathToArea(Tk_PathStyle *stylePtr, double *polyPtr, int numPoints,
                         int	numStrokes,	double *rectPtr, int inside);
+static double		SubPathToPoint(Tk_PathStyle *stylePtr, double *polyPtr, int numPoints,
+                        int numStrokes, double *pointPtr, int *intersectionsPtr,
+                        int *nonzerorulePtr);
+static double		EllipseCurveDist(double x, double y, double a, double b);
+static double		SegmentToEllipseDist(double x1, double y1, double x2, double y2,
+                        double a, double b);
+static double		RoundRectSignedDist(double rectPtr[], double r, double pointPtr[]);
 
 
 /*
@@ -820,11 +827,10 @@ GenericPathToPoint(
     double *pointPtr)		/* Pointer to x and y coordinates. */
 {
     int		    numPoints, numStrokes;
-    int		    isclosed;
     int		    intersections, nonzerorule;
     int		    sumIntersections = 0, sumNonzerorule = 0;
     double	    *polyPtr;
-    double	    bestDist, radius, width, dist;
+    double	    bestDist, dist;
     Tk_PathState    state = itemPtr->state;
     TMatrix	    *matrixPtr = stylePtr->matrixPtr;
 
@@ -848,11 +854,6 @@ GenericPathToPoint(
     } else {
         polyPtr = staticSpace;
     }
-    width = stylePtr->strokeWidth;
-    if (width < 1.0) {
-        width = 1.0;
-    }
-    radius = width/2.0;
 
     /*
      * Loop through each subpath, creating the approximate polyline,
@@ -865,27 +866,10 @@ GenericPathToPoint(
      
     while (atomPtr != NULL) {
         MakeSubPathSegments(&atomPtr, polyPtr, &numPoints, &numStrokes, matrixPtr);
-        isclosed = 0;
-        if (numStrokes == numPoints) {
-            isclosed = 1;
-        }        
-
-        /*
-         * This gives the min distance to the *stroke* AND the
-         * number of intersections of the two types.
-         */
-        dist = PathPolygonToPointEx(polyPtr, numPoints, pointPtr, 
-                &intersections, &nonzerorule);
+        dist = SubPathToPoint(stylePtr, polyPtr, numPoints, numStrokes,
+                pointPtr, &intersections, &nonzerorule);
         sumIntersections += intersections;
         sumNonzerorule += nonzerorule;
-        if ((stylePtr->strokeColor != NULL) && (stylePtr->strokeWidth <= kPathStrokeThicknessLimit)) {
-        
-            /*
-             * This gives the distance to a zero width polyline.
-             * Use a simple scheme to adjust for a small width.
-             */
-            dist -= radius;
-        }
         if (dist < bestDist) {
             bestDist = dist;
         }
@@ -893,23 +877,6 @@ GenericPathToPoint(
             bestDist = 0.0;
             goto done;
         }
-
-        /*
-         * For wider strokes we must make a more detailed analysis.
-         * Yes, there is an infinitesimal overlap to the above just
-         * to be on the safe side.
-         */
-        if ((stylePtr->strokeColor != NULL) && (stylePtr->strokeWidth >= kPathStrokeThicknessLimit)) {
-            dist = PathThickPolygonToPoint(stylePtr->joinStyle, stylePtr->capStyle, 
-                    width, isclosed, polyPtr, numPoints, pointPtr);
-            if (dist < bestDist) {
-                bestDist = dist;
-            }
-            if (bestDist <= 0.0) {
-                bestDist = 0.0;
-                goto done;
-            }
-        }
     }        
 
     /*
@@ -934,6 +901,82 @@ done:
     return bestDist;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * SubPathToPoint --
+ *
+ *	Computes the distance from a point to the stroke of one
+ *	subpath made into segments, and counts the crossings needed
+ *	to tell if the point is inside the fill.
+ *
+ * Results:
+ *	The distance, zero or less if the point is on the stroke.
+ *	The crossings for the two fill rules are left in
+ *	*intersectionsPtr and *nonzerorulePtr.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static double
+SubPathToPoint(
+    Tk_PathStyle *stylePtr,
+    double	*polyPtr,
+    int		numPoints,
+    int		numStrokes,
+    double	*pointPtr,
+    int		*intersectionsPtr,
+    int		*nonzerorulePtr)
+{
+    int		isclosed;
+    double	dist, thickDist, radius, width;
+
+    width = stylePtr->strokeWidth;
+    if (width < 1.0) {
+        width = 1.0;
+    }
+    radius = width/2.0;
+    isclosed = 0;
+    if (numStrokes == numPoints) {
+        isclosed = 1;
+    }        
+
+    /*
+     * This gives the min distance to the *stroke* AND the
+     * number of intersections of the two types.
+     */
+    dist = PathPolygonToPointEx(polyPtr, numPoints, pointPtr, 
+            intersectionsPtr, nonzerorulePtr);
+    if ((stylePtr->strokeColor != NULL) && (stylePtr->strokeWidth <= kPathStrokeThicknessLimit)) {
+    
+        /*
+         * This gives the distance to a zero width polyline.
+         * Use a simple scheme to adjust for a small width.
+         */
+        dist -= radius;
+    }
+    if (dist <= 0.0) {
+        return dist;
+    }
+
+    /*
+     * For wider strokes we must make a more detailed analysis.
+     * Yes, there is an infinitesimal overlap to the above just
+     * to be on the safe side.
+     */
+    if ((stylePtr->strokeColor != NULL) && (stylePtr->strokeWidth >= kPathStrokeThicknessLimit)) {
+        thickDist = PathThickPolygonToPoint(stylePtr->joinStyle, stylePtr->capStyle, 
+                width, isclosed, polyPtr, numPoints, pointPtr);
+        if (thickDist < dist) {
+            dist = thickDist;
+        }
+    }
+    return dist;
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -1046,6 +1089,238 @@ done:
     return inside;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * PathPolysMake, PathPolysFree --
+ *
+ *	Makes the subpaths of some atoms into polygons, in the
+ *	coordinates of the atoms, and frees them again. Atoms that
+ *	are hit tested under many matrices, such as those of a
+ *	symbol, need only be made into segments once this way, since
+ *	the segments of lines, arcs and curves transform as the atoms.
+ *
+ * Results:
+ *	The polygons.
+ *
+ * Side effects:
+ *	Memory allocated or freed.
+ *
+ *--------------------------------------------------------------
+ */
+
+PathPolys *
+PathPolysMake(
+    PathAtom *atomPtr,
+    int maxNumSegments)		/* Max segments in a subpath. */
+{
+    PathPolys *polysPtr;
+    int numPoints, numStrokes;
+    int used = 0, space = 0, polySpace = 0;
+
+    polysPtr = (PathPolys *) ckalloc(sizeof(PathPolys));
+    polysPtr->numPolys = 0;
+    polysPtr->numPoints = NULL;
+    polysPtr->numStrokes = NULL;
+    polysPtr->maxNumPoints = 0;
+    polysPtr->coords = NULL;
+
+    while (atomPtr != NULL) {
+        if (used + 2*maxNumSegments > space) {
+            space = MAX(2*space, used + 2*maxNumSegments);
+            polysPtr->coords = (double *) ckrealloc((char *) polysPtr->coords,
+                    (unsigned) (space*sizeof(double)));
+        }
+        if (polysPtr->numPolys >= polySpace) {
+            polySpace = MAX(8, 2*polySpace);
+            polysPtr->numPoints = (int *) ckrealloc((char *) polysPtr->numPoints,
+                    (unsigned) (polySpace*sizeof(int)));
+            polysPtr->numStrokes = (int *) ckrealloc((char *) polysPtr->numStrokes,
+                    (unsigned) (polySpace*sizeof(int)));
+        }
+        MakeSubPathSegments(&atomPtr, polysPtr->coords + used,
+                &numPoints, &numStrokes, NULL);
+        polysPtr->numPoints[polysPtr->numPolys] = numPoints;
+        polysPtr->numStrokes[polysPtr->numPolys] = numStrokes;
+        polysPtr->numPolys++;
+        polysPtr->maxNumPoints = MAX(polysPtr->maxNumPoints, numPoints);
+        used += 2*numPoints;
+    }
+    return polysPtr;
+}
+
+void
+PathPolysFree(PathPolys *polysPtr)
+{
+    if (polysPtr->coords != NULL) {
+        ckfree((char *) polysPtr->coords);
+    }
+    if (polysPtr->numPoints != NULL) {
+        ckfree((char *) polysPtr->numPoints);
+        ckfree((char *) polysPtr->numStrokes);
+    }
+    ckfree((char *) polysPtr);
+}
+
+/*
+ * Returns the points of polygon i transformed by matrixPtr, in
+ * polyPtr unless there is no matrix. coordPtr points at its first
+ * point in the polygons.
+ */
+
+static double *
+PathPolysTransform(
+    PathPolys *polysPtr,
+    int i,
+    double *coordPtr,
+    TMatrix *matrixPtr,
+    double *polyPtr)
+{
+    int j;
+
+    if (matrixPtr == NULL) {
+        return coordPtr;
+    }
+    for (j = 0; j < polysPtr->numPoints[i]; j++) {
+        PathApplyTMatrixToPoint(matrixPtr, coordPtr + 2*j, polyPtr + 2*j);
+    }
+    return polyPtr;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * GenericPolysToPoint, GenericPolysToArea --
+ *
+ *	Same as GenericPathToPoint and GenericPathToArea but for
+ *	polygons made with PathPolysMake, which are transformed by
+ *	the matrix of the style instead of made anew.
+ *
+ * Results:
+ *	See GenericPathToPoint and GenericPathToArea.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+double
+GenericPolysToPoint(
+    Tk_PathCanvas canvas,	/* Canvas containing item. */
+    Tk_PathItem *itemPtr,	/* Item to check against point. */
+    Tk_PathStyle *stylePtr,
+    PathPolys *polysPtr,
+    double *pointPtr)		/* Pointer to x and y coordinates. */
+{
+    int		    i, intersections, nonzerorule;
+    int		    sumIntersections = 0, sumNonzerorule = 0;
+    double	    *coordPtr, *polyPtr, *spacePtr;
+    double	    bestDist, dist;
+
+    bestDist = 1.0e36;
+
+    if (itemPtr->state == TK_PATHSTATE_HIDDEN) {
+        return bestDist;
+    }
+    if (!HaveAnyFillFromPathColor(stylePtr->fill) && (stylePtr->strokeColor == NULL)) {
+        return bestDist;
+    }
+    if (polysPtr->maxNumPoints > MAX_NUM_STATIC_SEGMENTS) {
+        spacePtr = (double *) ckalloc((unsigned)
+                (2*polysPtr->maxNumPoints*sizeof(double)));
+    } else {
+        spacePtr = staticSpace;
+    }
+    coordPtr = polysPtr->coords;
+    for (i = 0; i < polysPtr->numPolys; i++) {
+        polyPtr = PathPolysTransform(polysPtr, i, coordPtr,
+                stylePtr->matrixPtr, spacePtr);
+        coordPtr += 2*polysPtr->numPoints[i];
+        dist = SubPathToPoint(stylePtr, polyPtr, polysPtr->numPoints[i],
+                polysPtr->numStrokes[i], pointPtr, &intersections, &nonzerorule);
+        sumIntersections += intersections;
+        sumNonzerorule += nonzerorule;
+        if (dist < bestDist) {
+            bestDist = dist;
+        }
+        if (bestDist <= 0.0) {
+            bestDist = 0.0;
+            goto done;
+        }
+    }
+    if (HaveAnyFillFromPathColor(stylePtr->fill)) {
+        if ((stylePtr->fillRule == EvenOddRule) && (sumIntersections & 0x1)) {
+            bestDist = 0.0;
+        } else if ((stylePtr->fillRule == WindingRule) && (sumNonzerorule != 0)) {
+            bestDist = 0.0;
+        }
+    }
+
+done:
+    if (spacePtr != staticSpace) {
+        ckfree((char *) spacePtr);
+    }
+    return bestDist;
+}
+
+int
+GenericPolysToArea(
+    Tk_PathCanvas canvas,   /* Canvas containing item. */
+    Tk_PathItem *itemPtr,   /* Item to check against line. */
+    Tk_PathStyle *stylePtr,
+    PathPolys *polysPtr,
+    double *areaPtr)	    /* Pointer to array of four coordinates
+                             * (x1, y1, x2, y2) describing rectangular
+                             * area.  */
+{
+    int		    i, inside;
+    double	    *coordPtr, *polyPtr, *spacePtr;
+    double	    currentT[2];
+
+    if (itemPtr->state == TK_PATHSTATE_HIDDEN) {
+        return -1;
+    }
+    if ((GetColorFromPathColor(stylePtr->fill) == NULL) && (stylePtr->strokeColor == NULL)) {
+        return -1;
+    }
+    if ((polysPtr->numPolys == 0) || (polysPtr->numPoints[0] == 0)) {
+        return -1;
+    }
+    if (polysPtr->maxNumPoints > MAX_NUM_STATIC_SEGMENTS) {
+        spacePtr = (double *) ckalloc((unsigned)
+                (2*polysPtr->maxNumPoints*sizeof(double)));
+    } else {
+        spacePtr = staticSpace;
+    }
+
+    /*
+     * The first point decides the starting 'inside', see
+     * GenericPathToArea.
+     */
+    PathApplyTMatrixToPoint(stylePtr->matrixPtr, polysPtr->coords, currentT);
+    inside = -1;
+    if ((currentT[0] >= areaPtr[0]) && (currentT[0] <= areaPtr[2])
+            && (currentT[1] >= areaPtr[1]) && (currentT[1] <= areaPtr[3])) {
+        inside = 1;
+    }
+    coordPtr = polysPtr->coords;
+    for (i = 0; i < polysPtr->numPolys; i++) {
+        polyPtr = PathPolysTransform(polysPtr, i, coordPtr,
+                stylePtr->matrixPtr, spacePtr);
+        coordPtr += 2*polysPtr->numPoints[i];
+        if (SubPathToArea(stylePtr, polyPtr, polysPtr->numPoints[i],
+                polysPtr->numStrokes[i], areaPtr, inside) != inside) {
+            inside = 0;
+            break;
+        }
+    }
+    if (spacePtr != staticSpace) {
+        ckfree((char *) spacePtr);
+    }
+    return inside;
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -1891,72 +2166,447 @@ ScalePathAtoms(
     }
 }
 
-/*------------------*/
-
-TMatrix
-GetCanvasTMatrix(Tk_PathCanvas canvas)
-{
-    short originX, originY;
-    TMatrix m = kPathUnitTMatrix;
-    
-    /* @@@ Any scaling involved as well??? */
-    Tk_PathCanvasDrawableCoords(canvas, 0.0, 0.0, &originX, &originY);
-    m.tx = originX;
-    m.ty = originY;    
-    return m;
-}
+/*
+ *--------------------------------------------------------------
+ *
+ * PathLodInit, PathLodFree --
+ *
+ *	Initializes and frees a level of detail cache. Items must
+ *	free it whenever their atoms change.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Memory freed.
+ *
+ *--------------------------------------------------------------
+ */
 
-PathRect
-NewEmptyPathRect(void)
+void
+PathLodInit(PathLodCache *lodPtr)
 {
-    PathRect r;
-    
-    r.x1 = 1.0e36;
-    r.y1 = 1.0e36;
-    r.x2 = -1.0e36;
-    r.y2 = -1.0e36;
-    return r;
+    lodPtr->valid = 0;
+    lodPtr->atomsPtr = NULL;
 }
 
-int
-IsPathRectEmpty(PathRect *r)
+void
+PathLodFree(PathLodCache *lodPtr)
 {
-    if ((r->x2 >= r->x1) && (r->y2 >= r->y1)) {
-        return 0;
-    } else {
-        return 1;
+    if (lodPtr->atomsPtr != NULL) {
+        ckfree((char *) lodPtr->atomsPtr);
     }
+    PathLodInit(lodPtr);
 }
 
-void
-IncludePointInRect(PathRect *r, double x, double y)
-{
-    r->x1 = MIN(r->x1, x);
-    r->y1 = MIN(r->y1, y);
-    r->x2 = MAX(r->x2, x);
-    r->y2 = MAX(r->y2, y);
-}
+/*
+ * Growable output block for the simplified atoms.
+ */
 
-void
-TranslatePathRect(PathRect *r, double deltaX, double deltaY)
-{
-    r->x1 += deltaX;
-    r->x2 += deltaX;
-    r->y1 += deltaY;
-    r->y2 += deltaY;
-}
+typedef struct LodOutput {
+    LineToAtom *atomsPtr;
+    int num;
+    int space;
+} LodOutput;
 
-void
-ScalePathRect(PathRect *r, double originX, double originY,
-        double scaleX, double scaleY)
+static void
+LodEmit(LodOutput *outPtr, int type, double x, double y)
 {
-    r->x1 = originX + scaleX*(r->x1 - originX);
-    r->x2 = originX + scaleX*(r->x2 - originX);
-    r->y1 = originY + scaleY*(r->y1 - originY);
-    r->y2 = originY + scaleY*(r->y2 - originY);
+    LineToAtom *atomPtr;
+    
+    if (outPtr->num >= outPtr->space) {
+        outPtr->space = MAX(256, 2*outPtr->space);
+        outPtr->atomsPtr = (LineToAtom *) ckrealloc((char *) outPtr->atomsPtr,
+                (unsigned) (outPtr->space * sizeof(LineToAtom)));
+    }
+    atomPtr = outPtr->atomsPtr + outPtr->num++;
+    atomPtr->pathAtom.type = type;
+    atomPtr->x = x;
+    atomPtr->y = y;
 }
 
-void
+#define LOD_DEVICE_X(m, p) ((m)->a * (p)->x + (m)->c * (p)->y + (m)->tx)
+#define LOD_DEVICE_Y(m, p) ((m)->b * (p)->x + (m)->d * (p)->y + (m)->ty)
+
+/*
+ *--------------------------------------------------------------
+ *
+ * LodMinMax --
+ *
+ *	Decimates a subpath that is monotone in device x. For each
+ *	device pixel column only the first, last, lowest and highest
+ *	points are kept, in their original order, which draws the
+ *	same pixels as the full subpath. The first point keeps the
+ *	atom type it had, since a subpath after a close may begin
+ *	with a line to.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Atoms are added to the output.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+LodMinMax(LineToAtom *firstPtr, int numPoints, TMatrix *mPtr, LodOutput *outPtr)
+{
+    int firstType = firstPtr->pathAtom.type;
+    LineToAtom *atomPtr = firstPtr;
+    LineToAtom *group[4];	/* first, min, max, last */
+    int index[4];
+    double minY = 0.0, maxY = 0.0, y, col, groupCol = 0.0;
+    int i, j, k, n, numOut = 0;
+    
+    for (i = 0; i <= numPoints; i++) {
+        if (i < numPoints) {
+            col = floor(LOD_DEVICE_X(mPtr, atomPtr));
+            y = LOD_DEVICE_Y(mPtr, atomPtr);
+        }
+        if ((i > 0) && ((i == numPoints) || (col != groupCol))) {
+        
+            /* Flush group in original order without duplicates. */
+            for (j = 0; j < 4; j++) {
+                k = -1;
+                for (n = 0; n < 4; n++) {
+                    if ((index[n] >= 0) && ((k < 0) || (index[n] < index[k]))) {
+                        k = n;
+                    }
+                }
+                if (k < 0) {
+                    break;
+                }
+                LodEmit(outPtr, (numOut++ == 0) ? firstType : PATH_ATOM_L, 
+                        group[k]->x, group[k]->y);
+                for (n = 0; n < 4; n++) {
+                    if ((n != k) && (index[n] == index[k])) {
+                        index[n] = -1;
+                    }
+                }
+                index[k] = -1;
+            }
+        }
+        if (i == numPoints) {
+            break;
+        }
+        if ((i == 0) || (col != groupCol)) {
+            groupCol = col;
+            minY = maxY = y;
+            for (n = 0; n < 4; n++) {
+                group[n] = atomPtr;
+                index[n] = i;
+            }
+        } else {
+            if (y < minY) {
+                minY = y;
+                group[1] = atomPtr;
+                index[1] = i;
+            } else if (y > maxY) {
+                maxY = y;
+                group[2] = atomPtr;
+                index[2] = i;
+            }
+            group[3] = atomPtr;
+            index[3] = i;
+        }
+        atomPtr = (LineToAtom *) atomPtr->pathAtom.nextPtr;
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * LodDouglasPeucker --
+ *
+ *	Simplifies a general subpath with the Douglas-Peucker
+ *	algorithm, using a half pixel tolerance in device space.
+ *	An explicit stack is used to handle degenerate input. As in
+ *	LodMinMax the first point keeps its atom type.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Atoms are added to the output.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+LodDouglasPeucker(LineToAtom *firstPtr, int numPoints, TMatrix *mPtr, 
+        LodOutput *outPtr)
+{
+    LineToAtom **ptsPtr;
+    char *keepPtr;
+    int *stackPtr;
+    int stackSpace = 256, top = 0;
+    int i, start, end, maxIndex, numOut = 0;
+    double x1, y1, x2, y2, dx, dy, len2, t, ex, ey, dist2, maxDist2;
+    double tol2 = 0.25;
+    int firstType = firstPtr->pathAtom.type;
+    
+    ptsPtr = (LineToAtom **) ckalloc((unsigned) (numPoints * sizeof(LineToAtom *)));
+    keepPtr = (char *) ckalloc((unsigned) numPoints);
+    stackPtr = (int *) ckalloc((unsigned) (stackSpace * sizeof(int)));
+    for (i = 0; i < numPoints; i++) {
+        ptsPtr[i] = firstPtr;
+        keepPtr[i] = 0;
+        firstPtr = (LineToAtom *) firstPtr->pathAtom.nextPtr;
+    }
+    keepPtr[0] = keepPtr[numPoints-1] = 1;
+    stackPtr[top++] = 0;
+    stackPtr[top++] = numPoints-1;
+    
+    while (top > 0) {
+        end = stackPtr[--top];
+        start = stackPtr[--top];
+        if (end - start < 2) {
+            continue;
+        }
+        x1 = LOD_DEVICE_X(mPtr, ptsPtr[start]);
+        y1 = LOD_DEVICE_Y(mPtr, ptsPtr[start]);
+        x2 = LOD_DEVICE_X(mPtr, ptsPtr[end]);
+        y2 = LOD_DEVICE_Y(mPtr, ptsPtr[end]);
+        dx = x2 - x1;
+        dy = y2 - y1;
+        len2 = dx*dx + dy*dy;
+        maxDist2 = -1.0;
+        maxIndex = start;
+        for (i = start + 1; i < end; i++) {
+            ex = LOD_DEVICE_X(mPtr, ptsPtr[i]) - x1;
+            ey = LOD_DEVICE_Y(mPtr, ptsPtr[i]) - y1;
+            if (len2 > 0.0) {
+                t = (ex*dx + ey*dy)/len2;
+                t = MAX(0.0, MIN(1.0, t));
+                ex -= t*dx;
+                ey -= t*dy;
+            }
+            dist2 = ex*ex + ey*ey;
+            if (dist2 > maxDist2) {
+                maxDist2 = dist2;
+                maxIndex = i;
+            }
+        }
+        if (maxDist2 > tol2) {
+            keepPtr[maxIndex] = 1;
+            if (top + 4 > stackSpace) {
+                stackSpace *= 2;
+                stackPtr = (int *) ckrealloc((char *) stackPtr, 
+                        (unsigned) (stackSpace * sizeof(int)));
+            }
+            stackPtr[top++] = start;
+            stackPtr[top++] = maxIndex;
+            stackPtr[top++] = maxIndex;
+            stackPtr[top++] = end;
+        }
+    }
+    for (i = 0; i < numPoints; i++) {
+        if (keepPtr[i]) {
+            LodEmit(outPtr, (numOut++ == 0) ? firstType : PATH_ATOM_L, 
+                    ptsPtr[i]->x, ptsPtr[i]->y);
+        }
+    }
+    ckfree((char *) ptsPtr);
+    ckfree((char *) keepPtr);
+    ckfree((char *) stackPtr);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * PathLodGetAtoms --
+ *
+ *	Returns the atoms to draw for an item with level of detail
+ *	enabled. Paths made of only move, line and close atoms are
+ *	simplified in device space, that is through the item matrix
+ *	and then the canvas one: subpaths monotone in x with per pixel
+ *	min/max decimation and others with Douglas-Peucker. The result
+ *	is cached and reused as long as the device matrix stays within
+ *	the same zoom bucket (a quarter octave of scale) and orientation
+ *	and the drawable scale, as set by snapshot -scale, is the same.
+ *
+ * Results:
+ *	The simplified atoms, or atomPtr if simplifying doesn't pay.
+ *
+ * Side effects:
+ *	The cache may be rebuilt.
+ *
+ *--------------------------------------------------------------
+ */
+
+PathAtom *
+PathLodGetAtoms(
+    Tk_PathCanvas canvas,
+    PathLodCache *lodPtr, 
+    PathAtom *atomPtr,		/* The full atoms of the item. */
+    TMatrix *mPtr)		/* The item matrix, or NULL. */
+{
+    TkPathCanvas *canvasPtr = (TkPathCanvas *) canvas;
+    TMatrix m = GetCanvasTMatrix(canvas);
+    PathAtom *walkPtr, *startPtr;
+    LodOutput out;
+    double scale, x;
+    int i, bucket, numPoints, numAtoms, increasing, decreasing;
+    
+    /* The item matrix applies first. */
+    MMulTMatrix(mPtr, &m);
+    scale = sqrt(fabs(m.a*m.d - m.b*m.c));
+    if (scale <= 0.0) {
+        return atomPtr;
+    }
+    bucket = (int) floor(4.0 * log(scale)/log(2.0));
+    if (lodPtr->valid && (lodPtr->bucket == bucket) 
+            && (lodPtr->drawableScale == canvasPtr->drawableScale)
+            && (fabs(lodPtr->a - m.a/scale) < 1e-6) 
+            && (fabs(lodPtr->b - m.b/scale) < 1e-6)
+            && (fabs(lodPtr->c - m.c/scale) < 1e-6) 
+            && (fabs(lodPtr->d - m.d/scale) < 1e-6)) {
+        return (lodPtr->atomsPtr != NULL) ? (PathAtom *) lodPtr->atomsPtr : atomPtr;
+    }
+    PathLodFree(lodPtr);
+    lodPtr->valid = 1;
+    lodPtr->bucket = bucket;
+    lodPtr->drawableScale = canvasPtr->drawableScale;
+    lodPtr->a = m.a/scale;
+    lodPtr->b = m.b/scale;
+    lodPtr->c = m.c/scale;
+    lodPtr->d = m.d/scale;
+    
+    numAtoms = 0;
+    for (walkPtr = atomPtr; walkPtr != NULL; walkPtr = walkPtr->nextPtr) {
+        if ((walkPtr->type != PATH_ATOM_M) && (walkPtr->type != PATH_ATOM_L)
+                && (walkPtr->type != PATH_ATOM_Z)) {
+            return atomPtr;
+        }
+        numAtoms++;
+    }
+    if (numAtoms < 64) {
+        return atomPtr;
+    }
+    
+    out.atomsPtr = NULL;
+    out.num = out.space = 0;
+    walkPtr = atomPtr;
+    while (walkPtr != NULL) {
+        if (walkPtr->type == PATH_ATOM_Z) {
+            CloseAtom *closePtr = (CloseAtom *) walkPtr;
+            
+            LodEmit(&out, PATH_ATOM_Z, closePtr->x, closePtr->y);
+            walkPtr = walkPtr->nextPtr;
+            continue;
+        }
+        
+        /* A subpath is a move to followed by line tos. */
+        startPtr = walkPtr;
+        increasing = decreasing = 1;
+        x = LOD_DEVICE_X(&m, (LineToAtom *) walkPtr);
+        numPoints = 0;
+        do {
+            double nx = LOD_DEVICE_X(&m, (LineToAtom *) walkPtr);
+            
+            if (nx < x) {
+                increasing = 0;
+            } else if (nx > x) {
+                decreasing = 0;
+            }
+            x = nx;
+            numPoints++;
+            walkPtr = walkPtr->nextPtr;
+        } while ((walkPtr != NULL) && (walkPtr->type == PATH_ATOM_L));
+        
+        if (increasing || decreasing) {
+            LodMinMax((LineToAtom *) startPtr, numPoints, &m, &out);
+        } else {
+            LodDouglasPeucker((LineToAtom *) startPtr, numPoints, &m, &out);
+        }
+    }
+    if (4*out.num > 3*numAtoms) {
+        ckfree((char *) out.atomsPtr);
+        return atomPtr;
+    }
+    for (i = 0; i < out.num; i++) {
+        out.atomsPtr[i].pathAtom.nextPtr = (i == out.num - 1) ? NULL :
+                (PathAtom *) (out.atomsPtr + i + 1);
+    }
+    lodPtr->atomsPtr = out.atomsPtr;
+    return (PathAtom *) lodPtr->atomsPtr;
+}
+
+/*------------------*/
+
+TMatrix
+GetCanvasTMatrix(Tk_PathCanvas canvas)
+{
+    TkPathCanvas *canvasPtr = (TkPathCanvas *) canvas;
+    short originX, originY;
+    TMatrix m = kPathUnitTMatrix;
+    
+    if (canvasPtr->drawableScale != 1.0) {
+	double s = canvasPtr->drawableScale;
+
+	m.a = m.d = s;
+	m.tx = -s * canvasPtr->drawableXOrigin;
+	m.ty = -s * canvasPtr->drawableYOrigin;
+	return m;
+    }
+    Tk_PathCanvasDrawableCoords(canvas, 0.0, 0.0, &originX, &originY);
+    m.tx = originX;
+    m.ty = originY;    
+    return m;
+}
+
+PathRect
+NewEmptyPathRect(void)
+{
+    PathRect r;
+    
+    r.x1 = 1.0e36;
+    r.y1 = 1.0e36;
+    r.x2 = -1.0e36;
+    r.y2 = -1.0e36;
+    return r;
+}
+
+int
+IsPathRectEmpty(PathRect *r)
+{
+    if ((r->x2 >= r->x1) && (r->y2 >= r->y1)) {
+        return 0;
+    } else {
+        return 1;
+    }
+}
+
+void
+IncludePointInRect(PathRect *r, double x, double y)
+{
+    r->x1 = MIN(r->x1, x);
+    r->y1 = MIN(r->y1, y);
+    r->x2 = MAX(r->x2, x);
+    r->y2 = MAX(r->y2, y);
+}
+
+void
+TranslatePathRect(PathRect *r, double deltaX, double deltaY)
+{
+    r->x1 += deltaX;
+    r->x2 += deltaX;
+    r->y1 += deltaY;
+    r->y2 += deltaY;
+}
+
+void
+ScalePathRect(PathRect *r, double originX, double originY,
+        double scaleX, double scaleY)
+{
+    r->x1 = originX + scaleX*(r->x1 - originX);
+    r->x2 = originX + scaleX*(r->x2 - originX);
+    r->y1 = originY + scaleY*(r->y1 - originY);
+    r->y2 = originY + scaleY*(r->y2 - originY);
+}
+
+void
 TranslateItemHeader(Tk_PathItem *itemPtr, double deltaX, double deltaY)
 {
     /* @@@ TODO: Beware for cumulated round-off errors! */
@@ -2632,10 +3282,626 @@ PathRectToPointWithMatrix(PathRect bbox, TMatrix *mPtr, double *pointPtr)
 /*
  *--------------------------------------------------------------
  *
- * TkPathCanvasItemExConfigure --
+ * PathTMatrixIsSimilarity --
  *
- *      Takes care of the custom item configuration of the Tk_PathItemEx
- *	part of any item with style.
+ *	Checks if a matrix is a similarity transform, that is, a
+ *	combination of rotation, uniform scaling, reflection and
+ *	translation. Such a transform maps circles to circles and
+ *	preserves ratios of distances, which lets the point and area
+ *	functions work in the item's own coordinate system.
+ *
+ * Results:
+ *	1 if similarity (or NULL, which is identity), 0 otherwise.
+ *	The scale factor is returned in *scalePtr.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+PathTMatrixIsSimilarity(TMatrix *mPtr, double *scalePtr)
+{
+    double eps;
+    
+    if (mPtr == NULL) {
+        *scalePtr = 1.0;
+        return 1;
+    }
+    eps = 1e-9 * (fabs(mPtr->a) + fabs(mPtr->b) + fabs(mPtr->c) + fabs(mPtr->d));
+    *scalePtr = hypot(mPtr->a, mPtr->b);
+    if (*scalePtr <= 0.0) {
+        return 0;
+    }
+    if ((fabs(mPtr->a - mPtr->d) <= eps) && (fabs(mPtr->b + mPtr->c) <= eps)) {
+        return 1;
+    }
+    if ((fabs(mPtr->a + mPtr->d) <= eps) && (fabs(mPtr->b - mPtr->c) <= eps)) {
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * EllipseCurveDist --
+ *
+ *	Computes the distance from a point, relative the center of an
+ *	axis aligned ellipse with radii a and b, to the ellipse curve.
+ *	Circles are done in closed form. For true ellipses the closest
+ *	point is found by the evolute method, iterated until the point
+ *	moves less than ELLIPSE_DIST_TOL or ELLIPSE_DIST_ITERS is reached.
+ *	Most points settle in 3-6 iterations; points close to the curve
+ *	of a very eccentric ellipse need a few more.
+ *
+ * Results:
+ *	The distance to the curve (not to the interior).
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+#define ELLIPSE_DIST_TOL	1e-12
+#define ELLIPSE_DIST_ITERS	32
+
+static double
+EllipseCurveDist(double x, double y, double a, double b)
+{
+    double px = fabs(x), py = fabs(y);
+    double tx = 0.70710678118654752, ty = 0.70710678118654752;
+    double ex, ey, rx, ry, qx, qy, r, q, t, ox, oy;
+    int i;
+    
+    if (a <= 0.0 || b <= 0.0) {
+    
+        /* Degenerate to a line segment. */
+        a = MAX(0.0, a);
+        b = MAX(0.0, b);
+        return hypot(MAX(0.0, px - a), MAX(0.0, py - b));
+    }
+    if (a == b) {
+        return fabs(hypot(px, py) - a);
+    }
+    for (i = 0; i < ELLIPSE_DIST_ITERS; i++) {
+        ex = (a*a - b*b) * tx*tx*tx / a;
+        ey = (b*b - a*a) * ty*ty*ty / b;
+        rx = a*tx - ex;
+        ry = b*ty - ey;
+        qx = px - ex;
+        qy = py - ey;
+        r = hypot(rx, ry);
+        q = hypot(qx, qy);
+        if (q <= 0.0) {
+            break;
+        }
+        ox = tx;
+        oy = ty;
+        tx = MIN(1.0, MAX(0.0, (qx * r/q + ex)/a));
+        ty = MIN(1.0, MAX(0.0, (qy * r/q + ey)/b));
+        t = hypot(tx, ty);
+        tx /= t;
+        ty /= t;
+        if ((fabs(tx - ox) <= ELLIPSE_DIST_TOL)
+                && (fabs(ty - oy) <= ELLIPSE_DIST_TOL)) {
+            break;
+        }
+    }
+    return hypot(px - a*tx, py - b*ty);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SegmentToEllipseDist --
+ *
+ *	Computes the distance from a line segment that lies entirely
+ *	outside a filled ellipse centered at the origin to that ellipse.
+ *	The distance to a convex set is a convex function along the
+ *	segment, so a golden section search finds the exact minimum.
+ *
+ * Results:
+ *	The distance.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static double
+SegmentToEllipseDist(double x1, double y1, double x2, double y2, 
+        double a, double b)
+{
+    const double g = 0.6180339887498949;
+    double lo = 0.0, hi = 1.0, m1, m2, d1, d2;
+    int i;
+    
+    m1 = hi - g*(hi - lo);
+    m2 = lo + g*(hi - lo);
+    d1 = EllipseCurveDist(x1 + m1*(x2-x1), y1 + m1*(y2-y1), a, b);
+    d2 = EllipseCurveDist(x1 + m2*(x2-x1), y1 + m2*(y2-y1), a, b);
+    for (i = 0; i < 40; i++) {
+        if (d1 < d2) {
+            hi = m2;
+            m2 = m1;
+            d2 = d1;
+            m1 = hi - g*(hi - lo);
+            d1 = EllipseCurveDist(x1 + m1*(x2-x1), y1 + m1*(y2-y1), a, b);
+        } else {
+            lo = m1;
+            m1 = m2;
+            d1 = d2;
+            m2 = lo + g*(hi - lo);
+            d2 = EllipseCurveDist(x1 + m2*(x2-x1), y1 + m2*(y2-y1), a, b);
+        }
+    }
+    d1 = MIN(d1, d2);
+    d1 = MIN(d1, EllipseCurveDist(x1, y1, a, b));
+    return MIN(d1, EllipseCurveDist(x2, y2, a, b));
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * PathEllipseToPoint --
+ *
+ *	Computes the exact distance from a given point to an axis
+ *	aligned ellipse, in canvas units. Stroke is the band of half
+ *	the stroke width on each side of the ellipse curve.
+ *
+ * Results:
+ *	The return value is 0 if the point whose x and y coordinates
+ *	are pointPtr[0] and pointPtr[1] is inside the ellipse. If the
+ *	point isn't inside the ellipse then the return value is the
+ *	distance from the point to the ellipse. If the item is filled,
+ *	then anywhere in the interior is considered "inside"; if the
+ *	item isn't filled, then "inside" means only the area occupied
+ *	by the stroke.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+double
+PathEllipseToPoint(
+    double center[],	/* Center of ellipse. */
+    double rx, 		/* Radii. */
+    double ry,
+    double width, 	/* Width of stroke, or 0. */
+    int filled, 	/* Is ellipse filled. */
+    double pointPtr[])	/* Pointer to x and y coordinates. */
+{
+    double x = pointPtr[0] - center[0];
+    double y = pointPtr[1] - center[1];
+    double dist;
+    
+    dist = EllipseCurveDist(x, y, rx, ry) - width/2.0;
+    if (filled && (rx > 0.0) && (ry > 0.0)
+            && ((x*x)/(rx*rx) + (y*y)/(ry*ry) <= 1.0)) {
+        return 0.0;
+    }
+    return MAX(0.0, dist);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * PathEllipseToArea --
+ *
+ *	This procedure is called to determine whether an axis aligned
+ *	ellipse lies entirely inside, entirely outside, or overlapping
+ *	a given rectangle. The stroke width is handled exactly.
+ *
+ * Results:
+ *	-1 is returned if the ellipse is entirely outside the area
+ *	given by areaPtr, 0 if it overlaps, and 1 if it is entirely
+ *	inside the given area.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+PathEllipseToArea(
+    double center[],	/* Center of ellipse. */
+    double rx, 		/* Radii. */
+    double ry,
+    double width, 	/* Width of stroke, or 0. */
+    int filled, 	/* Is ellipse filled. */
+    double *areaPtr)	/* Pointer to array of four coordinates
+                         * (x1, y1, x2, y2) describing rectangular
+                         * area.  */
+{
+    double halfWidth = width/2.0;
+    double x1 = areaPtr[0] - center[0], y1 = areaPtr[1] - center[1];
+    double x2 = areaPtr[2] - center[0], y2 = areaPtr[3] - center[1];
+    double dx, dy, dist;
+
+    if ((x1 >= rx + halfWidth) || (x2 <= -(rx + halfWidth))
+            || (y1 >= ry + halfWidth) || (y2 <= -(ry + halfWidth))) {
+        return -1;
+    }
+    if ((x1 <= -(rx + halfWidth)) && (x2 >= rx + halfWidth)
+            && (y1 <= -(ry + halfWidth)) && (y2 >= ry + halfWidth)) {
+        return 1;
+    }
+    if ((rx <= 0.0) || (ry <= 0.0)) {
+        return 0;
+    }
+    
+    /*
+     * Does the area intersect the filled ellipse? Scaling the axes maps
+     * the ellipse to a unit circle and the area to another rectangle, so
+     * clamping the center into the area gives the closest point.
+     */
+    dx = MAX(x1, MIN(0.0, x2));
+    dy = MAX(y1, MIN(0.0, y2));
+    if ((dx*dx)/(rx*rx) + (dy*dy)/(ry*ry) > 1.0) {
+        if (halfWidth <= 0.0) {
+            return -1;
+        }
+        if (rx == ry) {
+            dist = hypot(dx, dy) - rx;
+        } else {
+            dist = SegmentToEllipseDist(x1, y1, x2, y1, rx, ry);
+            dist = MIN(dist, SegmentToEllipseDist(x2, y1, x2, y2, rx, ry));
+            dist = MIN(dist, SegmentToEllipseDist(x2, y2, x1, y2, rx, ry));
+            dist = MIN(dist, SegmentToEllipseDist(x1, y2, x1, y1, rx, ry));
+        }
+        return (dist <= halfWidth) ? 0 : -1;
+    }
+    
+    /*
+     * The area may lie entirely within the unfilled center. The
+     * distance to the curve is concave inside the ellipse, so it is
+     * enough to check the four corners.
+     */
+    if (!filled && (width > 0.0)) {
+        double xs[2], ys[2];
+        int i, j;
+        
+        xs[0] = x1, xs[1] = x2;
+        ys[0] = y1, ys[1] = y2;
+        for (i = 0; i < 2; i++) {
+            for (j = 0; j < 2; j++) {
+                if ((xs[i]*xs[i])/(rx*rx) + (ys[j]*ys[j])/(ry*ry) >= 1.0) {
+                    return 0;
+                }
+                if (EllipseCurveDist(xs[i], ys[j], rx, ry) <= halfWidth) {
+                    return 0;
+                }
+            }
+        }
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * PathShapeToPoint, PathShapeToArea --
+ *
+ *	Point and area tests for a single ellipse or rect atom, as
+ *	used by items that hold such shapes without a full path.
+ *	Axis aligned and, for ellipses, similarity transforms are
+ *	done analytically, other transforms through the generic
+ *	polygon code. The atoms nextPtr is ignored.
+ *
+ * Results:
+ *	The distance, or -1, 0, 1 as for the areaProc.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+MakeRectPolygonAtoms(double rect[], LineToAtom atoms[], CloseAtom *closePtr)
+{
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        atoms[i].pathAtom.type = (i == 0) ? PATH_ATOM_M : PATH_ATOM_L;
+        atoms[i].pathAtom.nextPtr = (i == 3) ? (PathAtom *) closePtr :
+                (PathAtom *) &atoms[i+1];
+        atoms[i].x = (i == 1 || i == 2) ? rect[2] : rect[0];
+        atoms[i].y = (i >= 2) ? rect[3] : rect[1];
+    }
+    closePtr->pathAtom.type = PATH_ATOM_Z;
+    closePtr->pathAtom.nextPtr = NULL;
+    closePtr->x = rect[0];
+    closePtr->y = rect[1];
+}
+
+/*
+ * Applies a rectilinear matrix to x1 y1 x2 y2 in place.
+ */
+
+static void
+RectilinearTransformRect(TMatrix *mPtr, double rect[])
+{
+    double x1 = mPtr->a * rect[0] + mPtr->tx;
+    double y1 = mPtr->d * rect[1] + mPtr->ty;
+    double x2 = mPtr->a * rect[2] + mPtr->tx;
+    double y2 = mPtr->d * rect[3] + mPtr->ty;
+
+    rect[0] = MIN(x1, x2);
+    rect[1] = MIN(y1, y2);
+    rect[2] = MAX(x1, x2);
+    rect[3] = MAX(y1, y2);
+}
+
+double
+PathShapeToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, 
+        Tk_PathStyle *stylePtr, PathAtom *atomPtr, double *pointPtr)
+{
+    TMatrix *mPtr = stylePtr->matrixPtr;
+    double width = (stylePtr->strokeColor != NULL) ? stylePtr->strokeWidth : 0.0;
+    int filled = HaveAnyFillFromPathColor(stylePtr->fill);
+    double scale;
+
+    if (atomPtr->type == PATH_ATOM_ELLIPSE) {
+        EllipseAtom *ell = (EllipseAtom *) atomPtr;
+        double center[2];
+
+        center[0] = ell->cx;
+        center[1] = ell->cy;
+        if (mPtr == NULL) {
+            return PathEllipseToPoint(center, ell->rx, ell->ry, width, filled,
+                    pointPtr);
+        } else if (TMATRIX_IS_RECTILINEAR(mPtr)) {
+            center[0] = mPtr->a * ell->cx + mPtr->tx;
+            center[1] = mPtr->d * ell->cy + mPtr->ty;
+            return PathEllipseToPoint(center, fabs(mPtr->a) * ell->rx,
+                    fabs(mPtr->d) * ell->ry, width, filled, pointPtr);
+        } else if (PathTMatrixIsSimilarity(mPtr, &scale)) {
+            TMatrix mi;
+            double point[2];
+
+            PathInverseTMatrix(mPtr, &mi);
+            PathApplyTMatrixToPoint(&mi, pointPtr, point);
+            return scale * PathEllipseToPoint(center, ell->rx, ell->ry,
+                    width/scale, filled, point);
+        } else {
+            EllipseAtom ellAtom = *ell;
+
+            ellAtom.pathAtom.nextPtr = NULL;
+            return GenericPathToPoint(canvas, itemPtr, stylePtr,
+                    (PathAtom *) &ellAtom, kPathNumSegmentsEllipse+1, pointPtr);
+        }
+    } else {
+        RectAtom *rectAtom = (RectAtom *) atomPtr;
+        double rect[4];
+
+        rect[0] = rectAtom->x;
+        rect[1] = rectAtom->y;
+        rect[2] = rectAtom->x + rectAtom->width;
+        rect[3] = rectAtom->y + rectAtom->height;
+        if (mPtr == NULL) {
+            return PathRectToPoint(rect, width, filled, pointPtr);
+        } else if (TMATRIX_IS_RECTILINEAR(mPtr)) {
+            RectilinearTransformRect(mPtr, rect);
+            return PathRectToPoint(rect, width, filled, pointPtr);
+        } else {
+            LineToAtom atoms[4];
+            CloseAtom closeAtom;
+
+            MakeRectPolygonAtoms(rect, atoms, &closeAtom);
+            return GenericPathToPoint(canvas, itemPtr, stylePtr,
+                    (PathAtom *) atoms, 6, pointPtr);
+        }
+    }
+}
+
+int
+PathShapeToArea(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, 
+        Tk_PathStyle *stylePtr, PathAtom *atomPtr, double *areaPtr)
+{
+    TMatrix *mPtr = stylePtr->matrixPtr;
+    double width = (stylePtr->strokeColor != NULL) ? stylePtr->strokeWidth : 0.0;
+    int filled = HaveAnyFillFromPathColor(stylePtr->fill);
+    double scale;
+
+    if (atomPtr->type == PATH_ATOM_ELLIPSE) {
+        EllipseAtom *ell = (EllipseAtom *) atomPtr;
+        double center[2];
+
+        center[0] = ell->cx;
+        center[1] = ell->cy;
+        if (mPtr == NULL) {
+            return PathEllipseToArea(center, ell->rx, ell->ry, width, filled,
+                    areaPtr);
+        } else if (TMATRIX_IS_RECTILINEAR(mPtr)) {
+            center[0] = mPtr->a * ell->cx + mPtr->tx;
+            center[1] = mPtr->d * ell->cy + mPtr->ty;
+            return PathEllipseToArea(center, fabs(mPtr->a) * ell->rx,
+                    fabs(mPtr->d) * ell->ry, width, filled, areaPtr);
+        } else if ((ell->rx == ell->ry) && PathTMatrixIsSimilarity(mPtr, &scale)) {
+            double c[2];
+
+            PathApplyTMatrixToPoint(mPtr, center, c);
+            return PathEllipseToArea(c, scale * ell->rx, scale * ell->rx,
+                    width, filled, areaPtr);
+        } else {
+            EllipseAtom ellAtom = *ell;
+
+            ellAtom.pathAtom.nextPtr = NULL;
+            return GenericPathToArea(canvas, itemPtr, stylePtr,
+                    (PathAtom *) &ellAtom, kPathNumSegmentsEllipse+1, areaPtr);
+        }
+    } else {
+        RectAtom *rectAtom = (RectAtom *) atomPtr;
+        double rect[4];
+
+        rect[0] = rectAtom->x;
+        rect[1] = rectAtom->y;
+        rect[2] = rectAtom->x + rectAtom->width;
+        rect[3] = rectAtom->y + rectAtom->height;
+        if (mPtr == NULL) {
+            return PathRectToArea(rect, width, filled, areaPtr);
+        } else if (TMATRIX_IS_RECTILINEAR(mPtr)) {
+            RectilinearTransformRect(mPtr, rect);
+            return PathRectToArea(rect, width, filled, areaPtr);
+        } else {
+            LineToAtom atoms[4];
+            CloseAtom closeAtom;
+
+            MakeRectPolygonAtoms(rect, atoms, &closeAtom);
+            return GenericPathToArea(canvas, itemPtr, stylePtr,
+                    (PathAtom *) atoms, 6, areaPtr);
+        }
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * RoundRectSignedDist --
+ *
+ *	Signed distance from a point to the outline of an axis aligned
+ *	rectangle with circular corners of radius r.
+ *
+ * Results:
+ *	The distance, negative inside.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static double
+RoundRectSignedDist(double rectPtr[], double r, double pointPtr[])
+{
+    double hx = (rectPtr[2] - rectPtr[0])/2.0;
+    double hy = (rectPtr[3] - rectPtr[1])/2.0;
+    double qx, qy;
+    
+    qx = fabs(pointPtr[0] - (rectPtr[0] + hx)) - (hx - r);
+    qy = fabs(pointPtr[1] - (rectPtr[1] + hy)) - (hy - r);
+    return hypot(MAX(qx, 0.0), MAX(qy, 0.0)) + MIN(MAX(qx, qy), 0.0) - r;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * PathRoundRectToPoint --
+ *
+ *	Computes the exact distance from a given point to an axis
+ *	aligned rectangle with circular corners of radius r.
+ *	The rectangle must be normalized, x1 <= x2 and y1 <= y2,
+ *	and r no larger than half its width or height.
+ *
+ * Results:
+ *	Same as for PathRectToPoint.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+double
+PathRoundRectToPoint(
+    double rectPtr[], 	/* Bare rectangle. */
+    double r,		/* Radius of corners. */
+    double width, 	/* Width of stroke, or 0. */
+    int filled, 	/* Is rectangle filled. */
+    double pointPtr[])	/* Pointer to x and y coordinates. */
+{
+    double dist = RoundRectSignedDist(rectPtr, r, pointPtr);
+    
+    if ((dist <= 0.0) && filled) {
+        return 0.0;
+    }
+    return MAX(0.0, fabs(dist) - width/2.0);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * PathRoundRectToArea --
+ *
+ *	This procedure is called to determine whether an axis aligned
+ *	rectangle with circular corners lies entirely inside, entirely
+ *	outside, or overlapping a given rectangle. Same constraints on
+ *	rectPtr and r as for PathRoundRectToPoint.
+ *
+ * Results:
+ *	-1 is returned if the rectangle is entirely outside the area
+ *	given by areaPtr, 0 if it overlaps, and 1 if it is entirely
+ *	inside the given area.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+PathRoundRectToArea(
+    double rectPtr[], 	/* Bare rectangle. */
+    double r,		/* Radius of corners. */
+    double width, 	/* Width of stroke, or 0. */
+    int filled, 	/* Is rectangle filled. */
+    double *areaPtr)	/* Pointer to array of four coordinates
+                         * (x1, y1, x2, y2) describing rectangular
+                         * area.  */
+{
+    double halfWidth = width/2.0;
+    double dx, dy;
+    
+    if ((areaPtr[0] <= (rectPtr[0] - halfWidth))
+            && (areaPtr[1] <= (rectPtr[1] - halfWidth))
+            && (areaPtr[2] >= (rectPtr[2] + halfWidth))
+            && (areaPtr[3] >= (rectPtr[3] + halfWidth))) {
+        return 1;
+    }
+    
+    /*
+     * The outline is the inner "core" rectangle grown by r, and the
+     * stroke grows it further by halfWidth.
+     */
+    dx = MAX(0.0, MAX((rectPtr[0] + r) - areaPtr[2], areaPtr[0] - (rectPtr[2] - r)));
+    dy = MAX(0.0, MAX((rectPtr[1] + r) - areaPtr[3], areaPtr[1] - (rectPtr[3] - r)));
+    if (hypot(dx, dy) >= r + halfWidth) {
+        return -1;
+    }
+    if (!filled && (width > 0.0)) {
+        double corner[2];
+        int i, j;
+        
+        for (i = 0; i < 2; i++) {
+            for (j = 0; j < 2; j++) {
+                corner[0] = areaPtr[2*i];
+                corner[1] = areaPtr[2*j+1];
+                if (RoundRectSignedDist(rectPtr, r, corner) > -halfWidth) {
+                    return 0;
+                }
+            }
+        }
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathCanvasItemLightConfigure --
+ *
+ *      Takes care of the custom item configuration of the
+ *	Tk_PathItemLight part of any item: its parent and style name.
  *
  * Results:
  *	Standard Tcl result.
@@ -2647,14 +3913,11 @@ PathRectToPointWithMatrix(PathRect bbox, TMatrix *mPtr, double *pointPtr)
  */
 
 int
-TkPathCanvasItemExConfigure(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItemEx *itemExPtr, int mask)
+TkPathCanvasItemLightConfigure(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItemLight *itemLightPtr, int mask)
 {
-    Tk_Window tkwin;
     Tk_PathItem *parentPtr;
-    Tk_PathItem *itemPtr = (Tk_PathItem *) itemExPtr;
-    Tk_PathStyle *stylePtr = &itemExPtr->style;
+    Tk_PathItem *itemPtr = (Tk_PathItem *) itemLightPtr;
 
-    tkwin = Tk_PathCanvasTkwin(canvas);
     if (mask & PATH_CORE_OPTION_PARENT) {
 	if (TkPathCanvasFindGroup(interp, canvas, itemPtr->parentObj, &parentPtr) != TCL_OK) {
 	    return TCL_ERROR;
@@ -2675,21 +3938,52 @@ TkPathCanvasItemExConfigure(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathIte
     if (mask & PATH_CORE_OPTION_STYLENAME) {
 	TkPathStyleInst *styleInst = NULL;
 	
-	if (itemExPtr->styleObj != NULL) {
-	    styleInst = TkPathGetStyle(interp, Tcl_GetString(itemExPtr->styleObj),
+	if (itemLightPtr->styleObj != NULL) {
+	    styleInst = TkPathGetStyle(interp, Tcl_GetString(itemLightPtr->styleObj),
 		    TkPathCanvasStyleTable(canvas), PathStyleChangedProc,
-		    (ClientData) itemExPtr);
+		    (ClientData) itemLightPtr);
 	    if (styleInst == NULL) {
 		return TCL_ERROR;
 	    }
 	} else {
 	    styleInst = NULL;
 	}
-	if (itemExPtr->styleInst != NULL) {
-	    TkPathFreeStyle(itemExPtr->styleInst);
+	if (itemLightPtr->styleInst != NULL) {
+	    TkPathFreeStyle(itemLightPtr->styleInst);
 	}
-	itemExPtr->styleInst = styleInst;    
+	itemLightPtr->styleInst = styleInst;    
     } 
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathCanvasItemExConfigure --
+ *
+ *      Takes care of the custom item configuration of the Tk_PathItemEx
+ *	part of any item with style.
+ *
+ * Results:
+ *	Standard Tcl result.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkPathCanvasItemExConfigure(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItemEx *itemExPtr, int mask)
+{
+    Tk_Window tkwin;
+    Tk_PathStyle *stylePtr = &itemExPtr->style;
+
+    tkwin = Tk_PathCanvasTkwin(canvas);
+    if (TkPathCanvasItemLightConfigure(interp, canvas, 
+	    (Tk_PathItemLight *) itemExPtr, mask) != TCL_OK) {
+	return TCL_ERROR;
+    }
     
     /*
      * Just translate the 'fillObj' (string) to a TkPathColor.
@@ -2745,23 +4039,24 @@ PathGradientChangedProc(ClientData clientData, int flags)
 void	
 PathStyleChangedProc(ClientData clientData, int flags)
 {
-    Tk_PathItemEx *itemExPtr = (Tk_PathItemEx *)clientData;
-    Tk_PathItem *itemPtr = (Tk_PathItem *) itemExPtr;
+    /* Also used for lightweight items, so only the shared part. */
+    Tk_PathItemLight *itemLightPtr = (Tk_PathItemLight *)clientData;
+    Tk_PathItem *itemPtr = (Tk_PathItem *) itemLightPtr;
         
     if (flags) {
 	if (flags & PATH_STYLE_FLAG_DELETE) {
-	    TkPathFreeStyle(itemExPtr->styleInst);	
-	    itemExPtr->styleInst = NULL;
-	    Tcl_DecrRefCount(itemExPtr->styleObj);
-	    itemExPtr->styleObj = NULL;
+	    TkPathFreeStyle(itemLightPtr->styleInst);	
+	    itemLightPtr->styleInst = NULL;
+	    Tcl_DecrRefCount(itemLightPtr->styleObj);
+	    itemLightPtr->styleObj = NULL;
 	}
 	if (itemPtr->typePtr == &tkGroupType) {
-	    GroupItemConfigured(itemExPtr->canvas, itemPtr, 
+	    GroupItemConfigured(itemLightPtr->canvas, itemPtr, 
 		    PATH_CORE_OPTION_STYLENAME); // Not completely correct...
 	} else {
-	    Tk_PathCanvasEventuallyRedraw(itemExPtr->canvas,
-		    itemExPtr->header.x1, itemExPtr->header.y1,
-		    itemExPtr->header.x2, itemExPtr->header.y2);
+	    Tk_PathCanvasEventuallyRedraw(itemLightPtr->canvas,
+		    itemLightPtr->header.x1, itemLightPtr->header.y1,
+		    itemLightPtr->header.x2, itemLightPtr->header.y2);
 	    }
     }
 }
@@ -17,6 +17,34 @@
 extern "C" {
 #endif
 
+/*
+ * Cache for the simplified atoms that items with -lod draw instead of
+ * their full geometry.
+ */
+
+typedef struct PathLodCache {
+    int valid;			/* Non-zero if the fields below are set. */
+    LineToAtom *atomsPtr;	/* Block of simplified M, L and Z atoms, or
+				 * NULL to draw the original atoms. */
+    int bucket;			/* Zoom bucket the atoms were made for. */
+    double drawableScale;	/* Scale of the canvas drawable then. */
+    double a, b, c, d;		/* Device matrix they were made for,
+				 * normalized to unit scale. */
+} PathLodCache;
+
+/*
+ * The subpaths of some atoms as polygons in their own coordinates, for
+ * hit tests of geometry that many items share under other matrices.
+ */
+
+typedef struct PathPolys {
+    int numPolys;		/* Number of subpaths. */
+    int *numPoints;		/* Points of each polygon, */
+    int *numStrokes;		/* and strokes between them. */
+    int maxNumPoints;		/* Most points in any polygon. */
+    double *coords;		/* The polygons one after another. */
+} PathPolys;
+
 int	    CoordsForPointItems(Tcl_Interp *interp, Tk_PathCanvas canvas, 
                     double *pointPtr, int objc, Tcl_Obj *CONST objv[]);
 int	    CoordsForRectangularItems(Tcl_Interp *interp, Tk_PathCanvas canvas, 
@@ -33,13 +61,45 @@ double	    GenericPathToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Tk_Pat
 		    PathAtom *atomPtr, int maxNumSegments, double *pointPtr);
 int	    GenericPathToArea(Tk_PathCanvas canvas,	Tk_PathItem *itemPtr, Tk_PathStyle *stylePtr,
                     PathAtom * atomPtr, int maxNumSegments, double *areaPtr);
+PathPolys * PathPolysMake(PathAtom *atomPtr, int maxNumSegments);
+void	    PathPolysFree(PathPolys *polysPtr);
+double	    GenericPolysToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+		    Tk_PathStyle *stylePtr, PathPolys *polysPtr, double *pointPtr);
+int	    GenericPolysToArea(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+		    Tk_PathStyle *stylePtr, PathPolys *polysPtr, double *areaPtr);
 void	    TranslatePathAtoms(PathAtom *atomPtr, double deltaX, double deltaY);
 void	    ScalePathAtoms(PathAtom *atomPtr, double originX, double originY,
                     double scaleX, double scaleY);
 void	    TranslatePathRect(PathRect *r, double deltaX, double deltaY);
 void	    ScalePathRect(PathRect *r, double originX, double originY,
 		    double scaleX, double scaleY);
+void	    PathLodInit(PathLodCache *lodPtr);
+void	    PathLodFree(PathLodCache *lodPtr);
+PathAtom *  PathLodGetAtoms(Tk_PathCanvas canvas, PathLodCache *lodPtr,
+		    PathAtom *atomPtr, TMatrix *mPtr);
 void	    TranslateItemHeader(Tk_PathItem *itemPtr, double deltaX, double deltaY);
+int	    GetSubpathMaxNumSegments(PathAtom *atomPtr);
+
+/*
+ * Items displayed into this drawable are written by the svg command
+ * instead of being drawn; see tkCanvSvg.c.
+ */
+
+#define TK_PATH_SVG_DRAWABLE	((Drawable) None)
+
+void	    TkPathSvgPath(PathAtom *atomPtr, Tk_PathStyle *stylePtr);
+void	    TkPathSvgText(Tk_PathStyle *stylePtr, Tk_PathTextStyle *textStylePtr,
+		    double x, double y, CONST char *utf8);
+void	    TkPathSvgImage(CONST char *imageName, double x, double y,
+		    double width, double height, double opacity, TMatrix *mPtr);
+/*
+ * TkPathInit and TkPathFree as called by the items, which also count
+ * the time when the canvas being drawn collects statistics.
+ */
+
+TkPathContext	TkPathTimedInit(Tk_Window tkwin, Drawable d);
+void		TkPathTimedFree(TkPathContext context);
+
 void	    ScaleItemHeader(Tk_PathItem *itemPtr, double originX, double originY,
 		    double scaleX, double scaleY);
 
@@ -55,6 +115,19 @@ double	PathRectToPoint(double rectPtr[], double width, int filled, double pointP
 int	PathRectToArea(double rectPtr[], double width, int filled, double *areaPtr);
 int	PathRectToAreaWithMatrix(PathRect bbox, TMatrix *mPtr, double *areaPtr);
 double PathRectToPointWithMatrix(PathRect bbox, TMatrix *mPtr, double *pointPtr);
+int	PathTMatrixIsSimilarity(TMatrix *mPtr, double *scalePtr);
+double	PathEllipseToPoint(double center[], double rx, double ry, double width, 
+			int filled, double pointPtr[]);
+int	PathEllipseToArea(double center[], double rx, double ry, double width, 
+			int filled, double *areaPtr);
+double	PathShapeToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, 
+			Tk_PathStyle *stylePtr, PathAtom *atomPtr, double *pointPtr);
+int	PathShapeToArea(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, 
+			Tk_PathStyle *stylePtr, PathAtom *atomPtr, double *areaPtr);
+double	PathRoundRectToPoint(double rectPtr[], double r, double width, int filled, 
+			double pointPtr[]);
+int	PathRoundRectToArea(double rectPtr[], double r, double width, int filled, 
+			double *areaPtr);
 
 
 /*
@@ -97,6 +170,12 @@ double PathRectToPointWithMatrix(PathRect bbox, TMatrix *mPtr, double *pointPtr)
 	TK_OPTION_NULL_OK, (ClientData) &tagsCO, PATH_CORE_OPTION_TAGS}
 
 
+#define PATH_OPTION_SPEC_LOD(typeName)				    \
+    {TK_OPTION_BOOLEAN, "-lod", NULL, NULL,			    \
+        "0", -1, Tk_Offset(typeName, lod),			    \
+	0, 0, 0}
+
+
 #ifdef __cplusplus
 }
 #endif
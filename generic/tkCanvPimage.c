@@ -230,6 +230,7 @@ Tk_PathItemType tkPimageType = {
     (Tk_PathItemInsertProc *) NULL,	/* insertProc */
     (Tk_PathItemDCharsProc *) NULL,	/* dTextProc */
     (Tk_PathItemType *) NULL,		/* nextPtr */
+    (Tk_PathItemAppendProc *) NULL,	/* appendProc */
 };
                         
  
@@ -575,10 +576,26 @@ DisplayPimage(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display, Draw
     TMatrix m;
     TkPathContext ctx;
     
+    if (drawable == TK_PATH_SVG_DRAWABLE) {
+	int iwidth = 0, iheight = 0;
+
+	if (pimagePtr->image == NULL) {
+	    return;
+	}
+	Tk_SizeOfImage(pimagePtr->image, &iwidth, &iheight);
+	m = GetTMatrix(pimagePtr);
+	TkPathSvgImage(Tcl_GetString(pimagePtr->imageObj),
+		itemPtr->bbox.x1+BBOX_OUT, itemPtr->bbox.y1+BBOX_OUT,
+		(pimagePtr->width > 0.0) ? pimagePtr->width : iwidth,
+		(pimagePtr->height > 0.0) ? pimagePtr->height : iheight,
+		pimagePtr->fillOpacity, &m);
+	return;
+    }
+
     /* === EB - 23-apr-2010: register coordinate offsets */
     m = GetCanvasTMatrix(canvas);
     TkPathSetCoordOffsets(m.tx, m.ty);
-    ctx = TkPathInit(Tk_PathCanvasTkwin(canvas), drawable);
+    ctx = TkPathTimedInit(Tk_PathCanvasTkwin(canvas), drawable);
     /* === */
     
     TkPathPushTMatrix(ctx, &m);
@@ -590,7 +607,7 @@ DisplayPimage(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display, Draw
             pimagePtr->width, pimagePtr->height, pimagePtr->fillOpacity,
             pimagePtr->tintColor, pimagePtr->tintAmount, pimagePtr->interpolation,
             pimagePtr->srcRegionPtr);
-    TkPathFree(ctx);
+    TkPathTimedFree(ctx);
 }
 
 static void	
@@ -114,6 +114,7 @@ Tk_PathItemType tkPlineType = {
     (Tk_PathItemInsertProc *) NULL,	/* insertProc */
     (Tk_PathItemDCharsProc *) NULL,	/* dTextProc */
     (Tk_PathItemType *) NULL,		/* nextPtr */
+    (Tk_PathItemAppendProc *) NULL,	/* appendProc */
 };
 
 static int		
@@ -370,14 +371,13 @@ DisplayPline(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display, Drawa
 
     atomPtr = MakePathAtoms(plinePtr);
     style = TkPathCanvasInheritStyle(itemPtr, kPathMergeStyleNotFill);
-    TkPathDrawPath(Tk_PathCanvasTkwin(canvas), drawable, atomPtr, &style, &m, &r);
-    TkPathFreeAtoms(atomPtr);
 
     /*
-     * Display arrowheads, if they are wanted.
+     * Display arrowheads, if they are wanted, in the same context.
      */
-    DisplayArrow(canvas, drawable, &plinePtr->startarrow, &style, &m, &r);
-    DisplayArrow(canvas, drawable, &plinePtr->endarrow, &style, &m, &r);
+    DisplayPathWithArrows(canvas, drawable, atomPtr, &style, &m, &r,
+            &plinePtr->startarrow, &plinePtr->endarrow);
+    TkPathFreeAtoms(atomPtr);
 
     TkPathCanvasFreeInheritedStyle(&style);
 }
@@ -26,7 +26,20 @@ typedef struct PpolyItem  {
     Tk_PathItemEx headerEx; /* Generic stuff that's the same for all
                              * path types.  MUST BE FIRST IN STRUCTURE. */
     char type;		    /* Polyline or polygon. */
-    PathAtom *atomPtr;
+    PathAtom *atomPtr;	    /* The atoms, stored in pointsPtr and
+			     * closeAtom. */
+    LineToAtom *pointsPtr;  /* One block for the atoms of all points: a
+			     * move to followed by line tos. The points in
+			     * use start at firstPoint, which lets appends
+			     * drop old points without moving the rest. */
+    int firstPoint;	    /* Index of first point in pointsPtr. */
+    int numPoints;	    /* Number of points in use. */
+    int pointSpace;	    /* Number of atoms allocated in pointsPtr. */
+    CloseAtom closeAtom;    /* Ends the atom list for polygons. */
+    int maxPoints;	    /* If > 0 only the last maxPoints points are
+			     * kept (ring buffer). */
+    int lod;		    /* Draw simplified atoms. */
+    PathLodCache lodCache;  /* The simplified atoms for -lod. */
     int maxNumSegments;	    /* Max number of straight segments (for subpath)
 			     * needed for Area and Point functions. */
     ArrowDescr startarrow;
@@ -47,8 +60,8 @@ static void	ComputePpolyBbox(Tk_PathCanvas canvas, PpolyItem *ppolyPtr);
 static int	ConfigurePpoly(Tcl_Interp *interp, Tk_PathCanvas canvas, 
                         Tk_PathItem *itemPtr, int objc,
                         Tcl_Obj *CONST objv[], int flags);
-int		CoordsForPolygonline(Tcl_Interp *interp, Tk_PathCanvas canvas, int closed,
-                        int objc, Tcl_Obj *CONST objv[], PathAtom **atomPtrPtr, int *lenPtr);
+static int	CoordsForPolygonline(Tcl_Interp *interp, Tk_PathCanvas canvas, 
+                        PpolyItem *ppolyPtr, int objc, Tcl_Obj *CONST objv[]);
 static int	CreateAny(Tcl_Interp *interp,
                         Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
                         int objc, Tcl_Obj *CONST objv[], char type);
@@ -78,6 +91,16 @@ static void	TranslatePpoly(Tk_PathCanvas canvas,
                         Tk_PathItem *itemPtr, double deltaX, double deltaY);
 
 static int      ConfigureArrows(Tk_PathCanvas canvas, PpolyItem *ppolyPtr);
+static void	SetPpolyPoints(PpolyItem *ppolyPtr, CONST char *coords, 
+                        int numPoints);
+static int	PpolyAppend(Tcl_Interp *interp, Tk_PathCanvas canvas,
+                        Tk_PathItem *itemPtr, int objc, Tcl_Obj *CONST objv[]);
+static int	GetPpolyCoords(Tcl_Interp *interp, Tk_PathCanvas canvas,
+                        int plain, int objc, Tcl_Obj *CONST objv[], 
+                        double *coords);
+static void	MakeRoomForPoints(PpolyItem *ppolyPtr, int numDrop, int numNew);
+static void	StorePpolyPoints(PpolyItem *ppolyPtr, CONST char *coords, 
+                        int numPoints);
 
 PATH_STYLE_CUSTOM_OPTION_RECORDS
 PATH_CUSTOM_OPTION_TAGS
@@ -85,6 +108,11 @@ PATH_OPTION_STRING_TABLES_FILL
 PATH_OPTION_STRING_TABLES_STROKE
 PATH_OPTION_STRING_TABLES_STATE
 
+#define PPOLY_OPTION_SPEC_MAXPOINTS		    \
+    {TK_OPTION_INT, "-maxpoints", NULL, NULL,	    \
+        "0", -1, Tk_Offset(PpolyItem, maxPoints),   \
+	0, 0, 0}
+
 static Tk_OptionSpec optionSpecsPolyline[] = {
     PATH_OPTION_SPEC_CORE(Tk_PathItemEx),
     PATH_OPTION_SPEC_PARENT,
@@ -93,6 +121,8 @@ static Tk_OptionSpec optionSpecsPolyline[] = {
     PATH_OPTION_SPEC_STYLE_STROKE(Tk_PathItemEx, "black"),
     PATH_OPTION_SPEC_STARTARROW_GRP(PpolyItem),
     PATH_OPTION_SPEC_ENDARROW_GRP(PpolyItem),
+    PPOLY_OPTION_SPEC_MAXPOINTS,
+    PATH_OPTION_SPEC_LOD(PpolyItem),
     PATH_OPTION_SPEC_END
 };
 
@@ -102,6 +132,8 @@ static Tk_OptionSpec optionSpecsPpolygon[] = {
     PATH_OPTION_SPEC_STYLE_FILL(Tk_PathItemEx, ""),
     PATH_OPTION_SPEC_STYLE_MATRIX(Tk_PathItemEx),
     PATH_OPTION_SPEC_STYLE_STROKE(Tk_PathItemEx, "black"),
+    PPOLY_OPTION_SPEC_MAXPOINTS,
+    PATH_OPTION_SPEC_LOD(PpolyItem),
     PATH_OPTION_SPEC_END
 };
 
@@ -135,6 +167,8 @@ Tk_PathItemType tkPolylineType = {
     (Tk_PathItemInsertProc *) NULL,	/* insertProc */
     (Tk_PathItemDCharsProc *) NULL,	/* dTextProc */
     (Tk_PathItemType *) NULL,		/* nextPtr */
+    PpolyAppend,			/* appendProc */
+    TK_PATH_ITEMTYPE_BINARY_COORDS,	/* flags */
 };
 
 Tk_PathItemType tkPpolygonType = {
@@ -159,6 +193,8 @@ Tk_PathItemType tkPpolygonType = {
     (Tk_PathItemInsertProc *) NULL,	/* insertProc */
     (Tk_PathItemDCharsProc *) NULL,	/* dTextProc */
     (Tk_PathItemType *) NULL,		/* nextPtr */
+    PpolyAppend,			/* appendProc */
+    TK_PATH_ITEMTYPE_BINARY_COORDS,	/* flags */
 };
  
 
@@ -199,6 +235,13 @@ CreateAny(Tcl_Interp *interp, Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
     itemExPtr->styleObj = NULL;
     itemExPtr->styleInst = NULL;
     ppolyPtr->atomPtr = NULL;
+    ppolyPtr->pointsPtr = NULL;
+    ppolyPtr->firstPoint = 0;
+    ppolyPtr->numPoints = 0;
+    ppolyPtr->pointSpace = 0;
+    ppolyPtr->maxPoints = 0;
+    ppolyPtr->lod = 0;
+    PathLodInit(&ppolyPtr->lodCache);
     ppolyPtr->type = type;
     itemPtr->bbox = NewEmptyPathRect();
     itemPtr->totalBbox = NewEmptyPathRect();
@@ -223,18 +266,28 @@ CreateAny(Tcl_Interp *interp, Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
         goto error;
     }
 
-    for (i = 1; i < objc; i++) {
+    /*
+     * The value after -doubles or -binary is the coords, which mustn't
+     * be taken for an option nor given a string rep.
+     */
+    i = 1;
+    if ((objc > 1) && (Tcl_ListObjLength(NULL, objv[0], &len) == TCL_OK)
+            && (len == 1)) {
+        char *arg = Tcl_GetString(objv[0]);
+
+        if ((strcmp(arg, "-doubles") == 0) || (strcmp(arg, "-binary") == 0)) {
+            i = 2;
+        }
+    }
+    for (; i < objc; i++) {
         char *arg = Tcl_GetString(objv[i]);
         if ((arg[0] == '-') && (arg[1] >= 'a') && (arg[1] <= 'z')) {
             break;
         }
     }
-    if (CoordsForPolygonline(interp, canvas, 
-	    (ppolyPtr->type == kPpolyTypePolyline) ? 0 : 1, 
-	    i, objv, &(ppolyPtr->atomPtr), &len) != TCL_OK) {
+    if (CoordsForPolygonline(interp, canvas, ppolyPtr, i, objv) != TCL_OK) {
         goto error;
     }
-    ppolyPtr->maxNumSegments = len;
    
     if (ConfigurePpoly(interp, canvas, itemPtr, objc-i, objv+i, 0) == TCL_OK) {
         return TCL_OK;
@@ -255,19 +308,166 @@ PpolyCoords(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
         int objc, Tcl_Obj *CONST objv[])
 {
     PpolyItem *ppolyPtr = (PpolyItem *) itemPtr;
-    int len, closed;
 
-    closed = (ppolyPtr->type == kPpolyTypePolyline) ? 0 : 1;
-    if (CoordsForPolygonline(interp, canvas, closed, objc, objv, 
-            &(ppolyPtr->atomPtr), &len) != TCL_OK) {
+    if (CoordsForPolygonline(interp, canvas, ppolyPtr, objc, objv) != TCL_OK) {
         return TCL_ERROR;
     }
-    ppolyPtr->maxNumSegments = len;
+    if (objc == 0) {
+        return TCL_OK;
+    }
     ConfigureArrows(canvas, ppolyPtr);
     ComputePpolyBbox(canvas, ppolyPtr);
     return TCL_OK;
 }	
 
+/*
+ *--------------------------------------------------------------
+ *
+ * PpolyAppend --
+ *
+ *		This procedure is invoked to append points to a polyline
+ *		or ppolygon item. For polylines the bbox is extended with
+ *		the new points only and only the area of the new segments
+ *		is redrawn. If points are dropped because of -maxpoints
+ *		the bbox is recomputed only if a dropped point was on
+ *		its edge.
+ *
+ * Results:
+ *		Standard tcl result.
+ *
+ * Side effects:
+ *		The item gets new points, and sets TK_ITEM_DONT_REDRAW
+ *		if it took care of redrawing itself.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+PpolyAppend(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr, 
+        int objc, Tcl_Obj *CONST objv[])
+{
+    PpolyItem *ppolyPtr = (PpolyItem *) itemPtr;
+    Tk_PathState state = itemPtr->state;
+    Tk_PathStyle style;
+    LineToAtom *atomPtr, *lastPtr;
+    PathRect bare, total, damage;
+    double *coords;
+    CONST char *newCoords;
+    int i, numNew, numDrop, fromIndex, fullBbox = 0;
+
+    if (objc == 1) {
+        if (Tcl_ListObjGetElements(interp, objv[0], &objc,
+            (Tcl_Obj ***) &objv) != TCL_OK) {
+            return TCL_ERROR;
+        }
+    }
+    if (objc & 1) {
+        char buf[64 + TCL_INTEGER_SPACE];
+        sprintf(buf, "wrong # coordinates: expected an even number, got %d", objc);
+        Tcl_SetResult(interp, buf, TCL_VOLATILE);
+        return TCL_ERROR;
+    } else if (objc == 0) {
+        itemPtr->redraw_flags |= TK_ITEM_DONT_REDRAW;
+        return TCL_OK;
+    }
+    coords = (double *) ckalloc((unsigned) (objc * sizeof(double)));
+    if (GetPpolyCoords(interp, canvas, 0, objc, objv, coords) != TCL_OK) {
+        ckfree((char *) coords);
+        return TCL_ERROR;
+    }
+    numNew = objc/2;
+    newCoords = (CONST char *) coords;
+    if ((ppolyPtr->maxPoints > 0) && (numNew > ppolyPtr->maxPoints)) {
+        newCoords += 2 * (numNew - ppolyPtr->maxPoints) * sizeof(double);
+        numNew = ppolyPtr->maxPoints;
+    }
+    numDrop = 0;
+    if ((ppolyPtr->maxPoints > 0) 
+            && (ppolyPtr->numPoints + numNew > ppolyPtr->maxPoints)) {
+        numDrop = ppolyPtr->numPoints + numNew - ppolyPtr->maxPoints;
+    }
+    if (state == TK_PATHSTATE_NULL) {
+	state = TkPathCanvasState(canvas);
+    }
+    if ((ppolyPtr->type == kPpolyTypePolygon) || (state == TK_PATHSTATE_HIDDEN)
+            || (numDrop >= ppolyPtr->numPoints - 1)) {
+        fullBbox = 1;
+    }
+    style = TkPathCanvasInheritStyle(itemPtr, kPathMergeStyleNotFill);
+    damage = NewEmptyPathRect();
+    
+    /* 
+     * The old end arrow goes away, and the last point is restored from
+     * its shortened position.
+     */
+    if (ppolyPtr->numPoints > 0) {
+        PathPoint p;
+        
+        IncludeArrowPointsInRect(&damage, &ppolyPtr->endarrow);
+        lastPtr = ppolyPtr->pointsPtr + ppolyPtr->firstPoint + ppolyPtr->numPoints - 1;
+        p.x = lastPtr->x;
+        p.y = lastPtr->y;
+        TkPathPreconfigureArrow(&p, &ppolyPtr->endarrow);
+        lastPtr->x = p.x;
+        lastPtr->y = p.y;
+    }
+    if ((numDrop > 0) && !fullBbox) {
+        atomPtr = ppolyPtr->pointsPtr + ppolyPtr->firstPoint;
+        if (ppolyPtr->startarrow.arrowEnabled) {
+            fullBbox = 1;
+        }
+        for (i = 0; (i < numDrop) && !fullBbox; i++, atomPtr++) {
+            if ((atomPtr->x == itemPtr->bbox.x1) || (atomPtr->x == itemPtr->bbox.x2) 
+                    || (atomPtr->y == itemPtr->bbox.y1) 
+                    || (atomPtr->y == itemPtr->bbox.y2)) {
+                fullBbox = 1;
+            }
+        }
+    }
+    
+    /* The segments from the one before the old last point change. */
+    fromIndex = MAX(0, ppolyPtr->numPoints - 2 - numDrop);
+    MakeRoomForPoints(ppolyPtr, numDrop, numNew);
+    StorePpolyPoints(ppolyPtr, newCoords, numNew);
+    ckfree((char *) coords);
+    ConfigureArrows(canvas, ppolyPtr);
+    
+    if (fullBbox) {
+        ComputePpolyBbox(canvas, ppolyPtr);
+    } else {
+        atomPtr = ppolyPtr->pointsPtr + ppolyPtr->firstPoint + fromIndex;
+        lastPtr = ppolyPtr->pointsPtr + ppolyPtr->firstPoint + ppolyPtr->numPoints - 1;
+        bare = NewEmptyPathRect();
+        for (; atomPtr <= lastPtr; atomPtr++) {
+            IncludePointInRect(&bare, atomPtr->x, atomPtr->y);
+        }
+        IncludeArrowPointsInRect(&bare, &ppolyPtr->endarrow);
+        IncludePointInRect(&damage, bare.x1, bare.y1);
+        IncludePointInRect(&damage, bare.x2, bare.y2);
+        IncludePointInRect(&itemPtr->bbox, bare.x1, bare.y1);
+        IncludePointInRect(&itemPtr->bbox, bare.x2, bare.y2);
+
+        /* Stroke width and miter corners of the changed segments only. */
+        atomPtr = ppolyPtr->pointsPtr + ppolyPtr->firstPoint + fromIndex;
+        total = GetGenericPathTotalBboxFromBare((PathAtom *) atomPtr, &style, &bare);
+        IncludePointInRect(&itemPtr->totalBbox, total.x1, total.y1);
+        IncludePointInRect(&itemPtr->totalBbox, total.x2, total.y2);
+        SetGenericPathHeaderBbox(itemPtr, style.matrixPtr, &itemPtr->totalBbox);
+        
+        if (numDrop == 0) {
+            Tk_PathItem damageItem;
+            
+            total = GetGenericPathTotalBboxFromBare((PathAtom *) atomPtr, &style, &damage);
+            SetGenericPathHeaderBbox(&damageItem, style.matrixPtr, &total);
+            Tk_PathCanvasEventuallyRedraw(canvas, damageItem.x1, damageItem.y1,
+                    damageItem.x2, damageItem.y2);
+            itemPtr->redraw_flags |= TK_ITEM_DONT_REDRAW;
+        }
+    }
+    TkPathCanvasFreeInheritedStyle(&style);
+    return TCL_OK;
+}
+
 void
 ComputePpolyBbox(Tk_PathCanvas canvas, PpolyItem *ppolyPtr)
 {
@@ -321,8 +521,30 @@ ConfigureArrows(
     PathPoint psecond;
     PathPoint ppenult;
     PathPoint *plastp;
+    LineToAtom *firstPtr, *lastPtr;
+    int error = TCL_ERROR;
 
-    int error = getSegmentsFromPathAtomList(ppolyPtr->atomPtr, &pfirstp, &psecond, &ppenult, &plastp);
+    /*
+     * Same as getSegmentsFromPathAtomList() but without walking all atoms
+     * since they are stored in one block.
+     */
+    if (ppolyPtr->numPoints >= 2) {
+        firstPtr = ppolyPtr->pointsPtr + ppolyPtr->firstPoint;
+        lastPtr = firstPtr + ppolyPtr->numPoints - 1;
+        pfirstp = (PathPoint *) &firstPtr->x;
+        psecond.x = firstPtr[1].x;
+        psecond.y = firstPtr[1].y;
+        if (ppolyPtr->type == kPpolyTypePolygon) {
+            ppenult.x = lastPtr->x;
+            ppenult.y = lastPtr->y;
+            plastp = (PathPoint *) &ppolyPtr->closeAtom.x;
+        } else {
+            ppenult.x = lastPtr[-1].x;
+            ppenult.y = lastPtr[-1].y;
+            plastp = (PathPoint *) &lastPtr->x;
+        }
+        error = TCL_OK;
+    }
 
     if (error == TCL_OK) {
         PathPoint pfirst = *pfirstp;
@@ -365,6 +587,11 @@ ConfigurePpoly(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
 		    objc, objv, tkwin, &savedOptions, &mask) != TCL_OK) {
 		continue;
 	    }
+	    if ((ppolyPtr->maxPoints < 0) || (ppolyPtr->maxPoints == 1)) {
+		Tcl_SetObjResult(interp, Tcl_NewStringObj(
+			"-maxpoints must be 0 or at least 2", -1));
+		continue;
+	    }
 	} else {
 	    errorResult = Tcl_GetObjResult(interp);
 	    Tcl_IncrRefCount(errorResult);
@@ -395,6 +622,14 @@ ConfigurePpoly(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
     }
 #endif
 
+    /* Arrows or -lod may have changed. */
+    PathLodFree(&ppolyPtr->lodCache);
+
+    /* Trim to the ring buffer size. */
+    if ((ppolyPtr->maxPoints > 0) && (ppolyPtr->numPoints > ppolyPtr->maxPoints)) {
+        MakeRoomForPoints(ppolyPtr, ppolyPtr->numPoints - ppolyPtr->maxPoints, 0);
+        StorePpolyPoints(ppolyPtr, NULL, 0);
+    }
     ConfigureArrows(canvas, ppolyPtr);
 
     if (error) {
@@ -421,10 +656,12 @@ DeletePpoly(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display)
     if (itemExPtr->styleInst != NULL) {
 	TkPathFreeStyle(itemExPtr->styleInst);
     }
-    if (ppolyPtr->atomPtr != NULL) {
-        TkPathFreeAtoms(ppolyPtr->atomPtr);
+    if (ppolyPtr->pointsPtr != NULL) {
+        ckfree((char *) ppolyPtr->pointsPtr);
+        ppolyPtr->pointsPtr = NULL;
         ppolyPtr->atomPtr = NULL;
     }
+    PathLodFree(&ppolyPtr->lodCache);
     TkPathFreeArrow(&ppolyPtr->startarrow);
     TkPathFreeArrow(&ppolyPtr->endarrow);
     optionTable = (ppolyPtr->type == kPpolyTypePolyline) ? optionTablePolyline : optionTablePpolygon;
@@ -438,19 +675,22 @@ DisplayPpoly(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display, Drawa
     PpolyItem *ppolyPtr = (PpolyItem *) itemPtr;
     TMatrix m = GetCanvasTMatrix(canvas);
     Tk_PathStyle style;
+    PathAtom *atomPtr = ppolyPtr->atomPtr;
     
     /* === EB - 23-apr-2010: register coordinate offsets */
     TkPathSetCoordOffsets(m.tx, m.ty);
     /* === */
     
     style = TkPathCanvasInheritStyle(itemPtr, 0);
-    TkPathDrawPath(Tk_PathCanvasTkwin(canvas), drawable, ppolyPtr->atomPtr, &style,
-            &m, &itemPtr->bbox);
+    if (ppolyPtr->lod) {
+        atomPtr = PathLodGetAtoms(canvas, &ppolyPtr->lodCache, atomPtr,
+                style.matrixPtr);
+    }
     /*
-     * Display arrowheads, if they are wanted.
+     * Display arrowheads, if they are wanted, in the same context.
      */
-    DisplayArrow(canvas, drawable, &ppolyPtr->startarrow, &style, &m, &itemPtr->bbox);
-    DisplayArrow(canvas, drawable, &ppolyPtr->endarrow, &style, &m, &itemPtr->bbox);
+    DisplayPathWithArrows(canvas, drawable, atomPtr, &style, &m,
+            &itemPtr->bbox, &ppolyPtr->startarrow, &ppolyPtr->endarrow);
     TkPathCanvasFreeInheritedStyle(&style);
 }
 
@@ -505,6 +745,7 @@ ScalePpoly(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double originX, double or
 {
     PpolyItem *ppolyPtr = (PpolyItem *) itemPtr;
 
+    PathLodFree(&ppolyPtr->lodCache);
     ScalePathAtoms(ppolyPtr->atomPtr, originX, originY, scaleX, scaleY);
     ScalePathRect(&itemPtr->bbox, originX, originY, scaleX, scaleY);
     ScalePathRect(&itemPtr->totalBbox, originX, originY, scaleX, scaleY);
@@ -519,6 +760,7 @@ TranslatePpoly(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double deltaX, double
 {
     PpolyItem *ppolyPtr = (PpolyItem *) itemPtr;
 
+    PathLodFree(&ppolyPtr->lodCache);
     TranslatePathAtoms(ppolyPtr->atomPtr, deltaX, deltaY);
     TranslatePathRect(&itemPtr->bbox, deltaX, deltaY);
     TranslatePathRect(&itemPtr->totalBbox, deltaX, deltaY);
@@ -527,65 +769,329 @@ TranslatePpoly(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double deltaX, double
     TranslateItemHeader(itemPtr, deltaX, deltaY);    
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * MakeRoomForPoints --
+ *
+ *		Drops the numDrop oldest points and makes sure there is
+ *		space for numNew more after the remaining ones. The block
+ *		is compacted or reallocated only when its end is reached,
+ *		so that appends are amortized O(1) per point.
+ *
+ * Results:
+ *		None.
+ *
+ * Side effects:
+ *		The points may move. StorePpolyPoints must be called
+ *		afterwards to link the atoms.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+MakeRoomForPoints(
+    PpolyItem *ppolyPtr,
+    int numDrop,
+    int numNew)
+{
+    int numKeep = ppolyPtr->numPoints - numDrop;
+    int first = ppolyPtr->firstPoint + numDrop;
+    int needed = numKeep + numNew;
+    LineToAtom *pointsPtr;
+    int i;
+    
+    if (numKeep <= 0) {
+        numKeep = 0;
+        first = 0;
+    }
+    if (first + needed <= ppolyPtr->pointSpace) {
+        ppolyPtr->firstPoint = first;
+        ppolyPtr->numPoints = numKeep;
+        return;
+    }
+    if (2*needed <= ppolyPtr->pointSpace) {
+        pointsPtr = ppolyPtr->pointsPtr;
+        memmove(pointsPtr, pointsPtr + first, numKeep * sizeof(LineToAtom));
+    } else {
+        pointsPtr = (LineToAtom *) ckalloc((unsigned) 
+                (2 * needed * sizeof(LineToAtom)));
+        if (ppolyPtr->pointsPtr != NULL) {
+            memcpy(pointsPtr, ppolyPtr->pointsPtr + first, 
+                    numKeep * sizeof(LineToAtom));
+            ckfree((char *) ppolyPtr->pointsPtr);
+        }
+        ppolyPtr->pointsPtr = pointsPtr;
+        ppolyPtr->pointSpace = 2 * needed;
+    }
+    for (i = 0; i < numKeep - 1; i++) {
+        pointsPtr[i].pathAtom.nextPtr = (PathAtom *) (pointsPtr + i + 1);
+    }
+    ppolyPtr->firstPoint = 0;
+    ppolyPtr->numPoints = numKeep;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * StorePpolyPoints --
+ *
+ *		Adds points after the current ones, the space must have
+ *		been made by MakeRoomForPoints, and links up the atoms.
+ *
+ * Results:
+ *		None.
+ *
+ * Side effects:
+ *		The atom list of the item is updated.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+StorePpolyPoints(
+    PpolyItem *ppolyPtr,
+    CONST char *coords,			/* Packed x y doubles, need not be
+					 * aligned. */
+    int numPoints)
+{
+    LineToAtom *firstPtr = ppolyPtr->pointsPtr + ppolyPtr->firstPoint;
+    LineToAtom *atomPtr = firstPtr + ppolyPtr->numPoints;
+    int i;
+    
+    PathLodFree(&ppolyPtr->lodCache);
+    if (ppolyPtr->numPoints > 0) {
+        atomPtr[-1].pathAtom.nextPtr = (PathAtom *) atomPtr;
+    }
+    for (i = 0; i < numPoints; i++, atomPtr++) {
+        atomPtr->pathAtom.type = PATH_ATOM_L;
+        atomPtr->pathAtom.nextPtr = (PathAtom *) (atomPtr + 1);
+        memcpy(&atomPtr->x, coords + (2*i) * sizeof(double), sizeof(double));
+        memcpy(&atomPtr->y, coords + (2*i+1) * sizeof(double), sizeof(double));
+    }
+    ppolyPtr->numPoints += numPoints;
+    if (ppolyPtr->numPoints == 0) {
+        ppolyPtr->atomPtr = NULL;
+        return;
+    }
+    firstPtr->pathAtom.type = PATH_ATOM_M;
+    atomPtr = firstPtr + ppolyPtr->numPoints - 1;
+    if (ppolyPtr->type == kPpolyTypePolygon) {
+        ppolyPtr->closeAtom.pathAtom.type = PATH_ATOM_Z;
+        ppolyPtr->closeAtom.pathAtom.nextPtr = NULL;
+        ppolyPtr->closeAtom.x = firstPtr->x;
+        ppolyPtr->closeAtom.y = firstPtr->y;
+        atomPtr->pathAtom.nextPtr = (PathAtom *) &ppolyPtr->closeAtom;
+    } else {
+        atomPtr->pathAtom.nextPtr = NULL;
+    }
+    ppolyPtr->atomPtr = (PathAtom *) firstPtr;
+    ppolyPtr->maxNumSegments = ppolyPtr->numPoints + 2;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SetPpolyPoints --
+ *
+ *		Replaces all points of the item, keeping only the last
+ *		maxPoints ones if set.
+ *
+ * Results:
+ *		None.
+ *
+ * Side effects:
+ *		The atom list of the item is replaced.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+SetPpolyPoints(
+    PpolyItem *ppolyPtr,
+    CONST char *coords,
+    int numPoints)
+{
+    if ((ppolyPtr->maxPoints > 0) && (numPoints > ppolyPtr->maxPoints)) {
+        coords += 2 * (numPoints - ppolyPtr->maxPoints) * sizeof(double);
+        numPoints = ppolyPtr->maxPoints;
+    }
+    
+    /* Don't hang on to a block much larger than needed. */
+    if ((numPoints > ppolyPtr->pointSpace) 
+            || (4*numPoints < ppolyPtr->pointSpace)) {
+        if (ppolyPtr->pointsPtr != NULL) {
+            ckfree((char *) ppolyPtr->pointsPtr);
+        }
+        ppolyPtr->pointsPtr = (LineToAtom *) ckalloc((unsigned) 
+                (numPoints * sizeof(LineToAtom)));
+        ppolyPtr->pointSpace = numPoints;
+    }
+    ppolyPtr->firstPoint = 0;
+    ppolyPtr->numPoints = 0;
+    StorePpolyPoints(ppolyPtr, coords, numPoints);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * GetPpolyCoords --
+ *
+ *		Parses coordinates into a double array. Plain numbers
+ *		are taken as is, and only other values go through the
+ *		screen distance parser unless plain is set.
+ *
+ * Results:
+ *		Standard tcl result.
+ *
+ * Side effects:
+ *		None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+GetPpolyCoords(
+    Tcl_Interp *interp, 
+    Tk_PathCanvas canvas,
+    int plain,				/* Only accept plain numbers. */
+    int objc, 
+    Tcl_Obj *CONST objv[],
+    double *coords)
+{
+    int i;
+    
+    for (i = 0; i < objc; i++) {
+        if (plain) {
+            if (Tcl_GetDoubleFromObj(interp, objv[i], &coords[i]) != TCL_OK) {
+                return TCL_ERROR;
+            }
+        } else if ((Tcl_GetDoubleFromObj(NULL, objv[i], &coords[i]) != TCL_OK)
+                && (Tk_PathCanvasGetCoordFromObj(interp, canvas, objv[i], 
+                &coords[i]) != TCL_OK)) {
+            return TCL_ERROR;
+        }
+    }
+    return TCL_OK;
+}
+
 /*
  *--------------------------------------------------------------
  *
  * CoordsForPolygonline --
  *
  *		Used as coordProc for polyline and polygon items.
+ *		The first argument may be "-doubles" or "-binary" for
+ *		bulk transfers: "-doubles" takes a list of plain numbers
+ *		(no screen distance units) and "-binary" a byte array
+ *		of packed native float64 x y pairs, as produced by
+ *		"binary format d*". Without coordinates the current ones
+ *		are returned in the given format.
  *
  * Results:
  *		Standard tcl result.
  *
  * Side effects:
- *		May store new atoms in atomPtrPtr and max number of points
- *		in lenPtr.
+ *		May store new points in the item.
  *
  *--------------------------------------------------------------
  */
 
-int		
+static int		
 CoordsForPolygonline(
     Tcl_Interp *interp, 
     Tk_PathCanvas canvas, 
-    int closed,				/* Polyline (0) or polygon (1) */
+    PpolyItem *ppolyPtr,
     int objc, 
-    Tcl_Obj *CONST objv[],
-    PathAtom **atomPtrPtr,
-    int *lenPtr)
+    Tcl_Obj *CONST objv[])
 {
-    PathAtom *atomPtr = *atomPtrPtr;
+    PathAtom *atomPtr;
+    double *coords;
+    int format = 0;
+    int i, len;
+    enum {
+        kCoordsList = 0, kCoordsDoubles, kCoordsBinary
+    };
 
+    /*
+     * Avoid generating the string rep of a large coordinate list when
+     * looking for an option.
+     */
+    if ((objc == 1 || objc == 2) 
+            && (Tcl_ListObjLength(NULL, objv[0], &len) == TCL_OK) && (len == 1)) {
+        char *arg = Tcl_GetString(objv[0]);
+        
+        if (strcmp(arg, "-doubles") == 0) {
+            format = kCoordsDoubles;
+        } else if (strcmp(arg, "-binary") == 0) {
+            format = kCoordsBinary;
+        }
+        if (format != kCoordsList) {
+            objc--, objv++;
+        }
+    }
     if (objc == 0) {
-        Tcl_Obj *obj = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
+        Tcl_Obj **objs = NULL;
+        unsigned char *bytes = NULL;
+        Tcl_Obj *obj = NULL;
         
-        while (atomPtr != NULL) {
-            switch (atomPtr->type) {
-                case PATH_ATOM_M: { 
-                    MoveToAtom *move = (MoveToAtom *) atomPtr;
-                    Tcl_ListObjAppendElement(interp, obj, Tcl_NewDoubleObj(move->x));
-                    Tcl_ListObjAppendElement(interp, obj, Tcl_NewDoubleObj(move->y));
-                    break;
-                }
-                case PATH_ATOM_L: {
-                    LineToAtom *line = (LineToAtom *) atomPtr;
-                    Tcl_ListObjAppendElement(interp, obj, Tcl_NewDoubleObj(line->x));
-                    Tcl_ListObjAppendElement(interp, obj, Tcl_NewDoubleObj(line->y));
-                    break;
-                }
-                case PATH_ATOM_Z: {
-                
-                    break;
-                }
-                default: {
-                    /* empty */
-                }
+        if (format == kCoordsBinary) {
+            obj = Tcl_NewByteArrayObj(NULL, 0);
+            bytes = Tcl_SetByteArrayLength(obj, 
+                    2 * ppolyPtr->numPoints * sizeof(double));
+        } else {
+            objs = (Tcl_Obj **) ckalloc((unsigned) 
+                    ((2 * ppolyPtr->numPoints + 1) * sizeof(Tcl_Obj *)));
+        }
+        i = 0;
+        for (atomPtr = ppolyPtr->atomPtr; atomPtr != NULL; atomPtr = atomPtr->nextPtr) {
+            LineToAtom *line = (LineToAtom *) atomPtr;
+            
+            /* Move to and line to atoms have the same layout. */
+            if (atomPtr->type == PATH_ATOM_Z) {
+                continue;
             }
-            atomPtr = atomPtr->nextPtr;
+            if (bytes != NULL) {
+                memcpy(bytes + i * sizeof(double), &line->x, sizeof(double));
+                memcpy(bytes + (i+1) * sizeof(double), &line->y, sizeof(double));
+            } else {
+                objs[i] = Tcl_NewDoubleObj(line->x);
+                objs[i+1] = Tcl_NewDoubleObj(line->y);
+            }
+            i += 2;
+        }
+        if (objs != NULL) {
+            obj = Tcl_NewListObj(i, objs);
+            ckfree((char *) objs);
         }
         Tcl_SetObjResult(interp, obj);
         return TCL_OK;
     }
+    if (format == kCoordsBinary) {
+        unsigned char *bytes;
+        char buf[64 + TCL_INTEGER_SPACE];
+        
+        if (objc != 1) {
+            Tcl_SetResult(interp, 
+                    "wrong # coordinates: expected a single byte array", 
+                    TCL_STATIC);
+            return TCL_ERROR;
+        }
+        bytes = Tcl_GetByteArrayFromObj(objv[0], &len);
+        if (len % (2 * sizeof(double)) != 0) {
+            sprintf(buf, "wrong # coordinates: expected a multiple of %d bytes, got %d", 
+                    (int) (2 * sizeof(double)), len);
+            Tcl_SetResult(interp, buf, TCL_VOLATILE);
+            return TCL_ERROR;
+        } else if (len < (int) (4 * sizeof(double))) {
+            sprintf(buf, "wrong # coordinates: expected at least 4, got %d", 
+                    (int) (len / sizeof(double)));
+            Tcl_SetResult(interp, buf, TCL_VOLATILE);
+            return TCL_ERROR;
+        }
+        SetPpolyPoints(ppolyPtr, (CONST char *) bytes, len / (2 * sizeof(double)));
+        return TCL_OK;
+    }
     if (objc == 1) {
         if (Tcl_ListObjGetElements(interp, objv[0], &objc,
             (Tcl_Obj ***) &objv) != TCL_OK) {
@@ -602,43 +1108,20 @@ CoordsForPolygonline(
         sprintf(buf, "wrong # coordinates: expected at least 4, got %d", objc);
         Tcl_SetResult(interp, buf, TCL_VOLATILE);
         return TCL_ERROR;
-    } else {
-        int 	i;
-        double	x, y;
-        double	firstX = 0.0, firstY = 0.0;
-        PathAtom *firstAtomPtr = NULL;
+    }
     
-        /*
-        * Free any old stuff.
-        */
-        if (atomPtr != NULL) {
-            TkPathFreeAtoms(atomPtr);
-            atomPtr = NULL;
-        }
-        for (i = 0; i < objc; i += 2) {
-            if (Tk_PathCanvasGetCoordFromObj(interp, canvas, objv[i], &x) != TCL_OK) {
-                /* @@@ error recovery? */
-                return TCL_ERROR;
-            }
-            if (Tk_PathCanvasGetCoordFromObj(interp, canvas, objv[i+1], &y) != TCL_OK) {
-                return TCL_ERROR;
-            }
-            if (i == 0) {
-                firstX = x;
-                firstY = y;
-                atomPtr = NewMoveToAtom(x, y);
-                firstAtomPtr = atomPtr;
-            } else {
-                atomPtr->nextPtr = NewLineToAtom(x, y);
-                atomPtr = atomPtr->nextPtr;
-            }
-        }
-        if (closed) {
-            atomPtr->nextPtr = NewCloseAtom(firstX, firstY);
-        }
-        *atomPtrPtr = firstAtomPtr;
-        *lenPtr = i/2 + 2;
+    /*
+     * Parse everything before touching the item so that it is intact
+     * on errors.
+     */
+    coords = (double *) ckalloc((unsigned) (objc * sizeof(double)));
+    if (GetPpolyCoords(interp, canvas, (format == kCoordsDoubles), 
+            objc, objv, coords) != TCL_OK) {
+        ckfree((char *) coords);
+        return TCL_ERROR;
     }
+    SetPpolyPoints(ppolyPtr, (CONST char *) coords, objc/2);
+    ckfree((char *) coords);
     return TCL_OK;
 }
 
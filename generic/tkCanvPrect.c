@@ -62,6 +62,8 @@ static void	ScalePrect(Tk_PathCanvas canvas,
 static void	TranslatePrect(Tk_PathCanvas canvas,
                         Tk_PathItem *itemPtr, double deltaX, double deltaY);
 static PathAtom * MakePathAtoms(PrectItem *prectPtr);
+static int	GetAnalyticRect(PrectItem *prectPtr, TMatrix *mPtr, 
+                        double bareRect[], double *rPtr);
 
 
 enum {
@@ -125,6 +127,7 @@ Tk_PathItemType tkPrectType = {
     (Tk_PathItemInsertProc *) NULL,	/* insertProc */
     (Tk_PathItemDCharsProc *) NULL,	/* dTextProc */
     (Tk_PathItemType *) NULL,		/* nextPtr */
+    (Tk_PathItemAppendProc *) NULL,	/* appendProc */
 };
                         
 
@@ -345,16 +348,79 @@ PrectBbox(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int mask)
     ComputePrectBbox(canvas, prectPtr);
 }
 
+/*
+ * The point and area functions handle rectangles with circular (or
+ * negligible) corners analytically. They fill in the bare rectangle and
+ * corner radius, transformed to canvas coordinates when the matrix keeps
+ * it axis aligned, and return 0 if the generic path code must be used.
+ */
+
+static int
+GetAnalyticRect(PrectItem *prectPtr, TMatrix *mPtr, double bareRect[], double *rPtr)
+{
+    PathRect *rectPtr = &prectPtr->headerEx.header.bbox;
+    double rx = prectPtr->rx;
+    double ry = prectPtr->ry;
+    double epsilon = 1e-6;
+    double r, tmp;
+
+    bareRect[0] = MIN(rectPtr->x1, rectPtr->x2);
+    bareRect[1] = MIN(rectPtr->y1, rectPtr->y2);
+    bareRect[2] = MAX(rectPtr->x1, rectPtr->x2);
+    bareRect[3] = MAX(rectPtr->y1, rectPtr->y2);
+
+    /* Same rules as TkPathMakePrectAtoms. */
+    if (rx < epsilon && ry < epsilon) {
+        r = 0.0;
+    } else {
+        if (rx < epsilon) {
+            rx = ry;
+        } else if (ry < epsilon) {
+            ry = rx;
+        }
+        rx = MIN(rx, (bareRect[2] - bareRect[0])/2.0);
+        ry = MIN(ry, (bareRect[3] - bareRect[1])/2.0);
+        if (rx == ry) {
+            r = rx;
+        } else if ((rx <= 1.0) && (ry <= 1.0)) {
+        
+            /* Be economical about tiny corners. */
+            r = 0.0;
+        } else {
+            return 0;
+        }
+    }
+    if (mPtr != NULL) {
+        if (!(TMATRIX_IS_RECTILINEAR(mPtr))) {
+            return 0;
+        }
+        if ((r > 0.0) && (fabs(mPtr->a) != fabs(mPtr->d))) {
+            return 0;
+        }
+        bareRect[0] = mPtr->a * bareRect[0] + mPtr->tx;
+        bareRect[1] = mPtr->d * bareRect[1] + mPtr->ty;
+        bareRect[2] = mPtr->a * bareRect[2] + mPtr->tx;
+        bareRect[3] = mPtr->d * bareRect[3] + mPtr->ty;
+        if (bareRect[0] > bareRect[2]) {
+            tmp = bareRect[0], bareRect[0] = bareRect[2], bareRect[2] = tmp;
+        }
+        if (bareRect[1] > bareRect[3]) {
+            tmp = bareRect[1], bareRect[1] = bareRect[3], bareRect[3] = tmp;
+        }
+        r *= fabs(mPtr->a);
+    }
+    *rPtr = r;
+    return 1;
+}
+
 static double	
 PrectToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *pointPtr)
 {
     PrectItem *prectPtr = (PrectItem *) itemPtr;
     Tk_PathStyle style;
     TMatrix *mPtr;
-    PathRect *rectPtr = &itemPtr->bbox;
     double bareRect[4];
-    double width, dist;
-    int rectiLinear = 0;
+    double width, dist, r, scale;
     int filled;
 
     style = TkPathCanvasInheritStyle(itemPtr, 0);
@@ -365,26 +431,20 @@ PrectToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *pointPtr)
     }
     mPtr = style.matrixPtr;
     
-    /* Try to be economical about this for pure rectangles. */
-    if ((prectPtr->rx <= 1.0) && (prectPtr->ry <= 1.0)) {
-        if (mPtr == NULL) {
-            rectiLinear = 1;
-            bareRect[0] = rectPtr->x1;
-            bareRect[1] = rectPtr->y1;
-            bareRect[2] = rectPtr->x2;
-            bareRect[3] = rectPtr->y2;
-        } else if (TMATRIX_IS_RECTILINEAR(mPtr)) {
-        
-            /* This is a situation we can treat in a simplified way. Apply the transform here. */
-            rectiLinear = 1;
-            bareRect[0] = mPtr->a * rectPtr->x1 + mPtr->tx;
-            bareRect[1] = mPtr->d * rectPtr->y1 + mPtr->ty;
-            bareRect[2] = mPtr->a * rectPtr->x2 + mPtr->tx;
-            bareRect[3] = mPtr->d * rectPtr->y2 + mPtr->ty;
-        }
-    }
-    if (rectiLinear) {
-        dist = PathRectToPoint(bareRect, width, filled, pointPtr);
+    if (GetAnalyticRect(prectPtr, mPtr, bareRect, &r)) {
+        dist = PathRoundRectToPoint(bareRect, r, width, filled, pointPtr);
+    } else if ((mPtr != NULL) && GetAnalyticRect(prectPtr, NULL, bareRect, &r)
+            && PathTMatrixIsSimilarity(mPtr, &scale)) {
+        TMatrix mi;
+        double point[2];
+    
+        /* 
+         * Rotated: do the test in the item's coordinate system. All 
+         * distances scale uniformly but the stroke width is in canvas units.
+         */
+        PathInverseTMatrix(mPtr, &mi);
+        PathApplyTMatrixToPoint(&mi, pointPtr, point);
+        dist = scale * PathRoundRectToPoint(bareRect, r, width/scale, filled, point);
     } else {
 	PathAtom *atomPtr = MakePathAtoms(prectPtr);
         dist = GenericPathToPoint(canvas, itemPtr, &style, atomPtr, 
@@ -399,13 +459,9 @@ static int
 PrectToArea(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *areaPtr)
 {
     PrectItem *prectPtr = (PrectItem *) itemPtr;
-    Tk_PathItemEx *itemExPtr = &prectPtr->headerEx;
-    Tk_PathStyle style = itemExPtr->style;  /* NB: We *copy* the style for temp usage. */
-    TMatrix *mPtr;
-    PathRect *rectPtr = &(itemPtr->bbox);
+    Tk_PathStyle style;
     double bareRect[4];
-    double width;
-    int rectiLinear = 0;
+    double width, r;
     int filled, area;
 
     style = TkPathCanvasInheritStyle(itemPtr, 0);
@@ -414,28 +470,8 @@ PrectToArea(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *areaPtr)
     if (style.strokeColor != NULL) {
         width = style.strokeWidth;
     }
-    mPtr = style.matrixPtr;
-
-    /* Try to be economical about this for pure rectangles. */
-    if ((prectPtr->rx <= 1.0) && (prectPtr->ry <= 1.0)) {
-        if (mPtr == NULL) {
-            rectiLinear = 1;
-            bareRect[0] = rectPtr->x1;
-            bareRect[1] = rectPtr->y1;
-            bareRect[2] = rectPtr->x2;
-            bareRect[3] = rectPtr->y2;
-        } else if (TMATRIX_IS_RECTILINEAR(mPtr)) {
-        
-            /* This is a situation we can treat in a simplified way. Apply the transform here. */
-            rectiLinear = 1;
-            bareRect[0] = mPtr->a * rectPtr->x1 + mPtr->tx;
-            bareRect[1] = mPtr->d * rectPtr->y1 + mPtr->ty;
-            bareRect[2] = mPtr->a * rectPtr->x2 + mPtr->tx;
-            bareRect[3] = mPtr->d * rectPtr->y2 + mPtr->ty;
-        }
-    }
-    if (rectiLinear) {
-        area = PathRectToArea(bareRect, width, filled, areaPtr);
+    if (GetAnalyticRect(prectPtr, style.matrixPtr, bareRect, &r)) {
+        area = PathRoundRectToArea(bareRect, r, width, filled, areaPtr);
     } else {
 	PathAtom *atomPtr = MakePathAtoms(prectPtr);
         area = GenericPathToArea(canvas, itemPtr, &style, 
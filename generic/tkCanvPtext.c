@@ -208,6 +208,7 @@ Tk_PathItemType tkPtextType = {
     (Tk_PathItemInsertProc *) NULL,	/* insertProc */
     (Tk_PathItemDCharsProc *) NULL,	/* dTextProc */
     (Tk_PathItemType *) NULL,		/* nextPtr */
+    (Tk_PathItemAppendProc *) NULL,	/* appendProc */
 };
                          
 
@@ -556,8 +557,15 @@ DisplayPtext(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display, Drawa
     if (!(style.mask & PATH_STYLE_OPTION_STROKE)) {
 	style.strokeColor = itemExPtr->style.strokeColor;
     }
+    if (drawable == TK_PATH_SVG_DRAWABLE) {
+	TkPathSvgText(&style, &ptextPtr->textStyle, itemPtr->bbox.x1,
+		itemPtr->bbox.y1 + ptextPtr->baseHeightRatio * (itemPtr->bbox.y2 - itemPtr->bbox.y1),
+		Tcl_GetString(ptextPtr->utf8Obj));
+	TkPathCanvasFreeInheritedStyle(&style);
+	return;
+    }
     
-    ctx = TkPathInit(Tk_PathCanvasTkwin(canvas), drawable);
+    ctx = TkPathTimedInit(Tk_PathCanvasTkwin(canvas), drawable);
     
     TkPathPushTMatrix(ctx, &m);
     if (style.matrixPtr != NULL) {
@@ -570,7 +578,7 @@ DisplayPtext(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display, Drawa
     TkPathTextDraw(ctx, &style, &ptextPtr->textStyle, itemPtr->bbox.x1, itemPtr->bbox.y1 + ptextPtr->baseHeightRatio * (itemPtr->bbox.y2 - itemPtr->bbox.y1),
             ptextPtr->fillOverStroke, Tcl_GetString(ptextPtr->utf8Obj), ptextPtr->custom);
     TkPathEndPath(ctx);
-    TkPathFree(ctx);
+    TkPathTimedFree(ctx);
     TkPathCanvasFreeInheritedStyle(&style);
 }
 
@@ -0,0 +1,1069 @@
+/*
+ * tkCanvSave.c --
+ *
+ *	This module implements the "save" and "load" widget commands that
+ *	write the items of a canvas, together with the gradients and
+ *	styles local to the canvas, to a channel in a binary format and
+ *	read them back. Loading is much faster than running a script of
+ *	create commands since nothing is parsed as a script and equal
+ *	option values are shared by all items, so colors, dashes etc.
+ *	are only looked up once.
+ *
+ *	The format is made of 32 bit integers, strings and arrays of
+ *	doubles, all in the byte order of the machine that wrote it:
+ *
+ *	    header	"TKPS" version byteOrder
+ *	    gradients	count {name type options}...
+ *	    styles	count {name options}...
+ *	    symbols	count {name pathSpec}...
+ *	    items	count {type id parentId coords options}...
+ *
+ *	A string is its length followed by that many bytes of UTF-8, and
+ *	options are a count followed by pairs of name and value strings.
+ *	Only the options that differ from their defaults are saved. The
+ *	coords start with a kind, 0 for none, 1 for a string, which is
+ *	what path items have, and 2 for a count followed by that many
+ *	doubles. The doubles start at a multiple of 8 bytes from the start
+ *	of the file, so that a reader can map large coordinate arrays
+ *	straight from the file. The byteOrder is written as 0x01020304, a
+ *	file from a machine of the other byte order is swapped on load.
+ *	The items come in stacking order with parents before children.
+ *	Version 1 files have no symbols and are still read.
+ *
+ * Copyright (c) 2026  tkpath contributors
+ *
+ * $Id$
+ */
+
+#include "tkIntPath.h"
+#include "tkpCanvas.h"
+
+#define SAVE_MAGIC		"TKPS"
+#define SAVE_VERSION		2
+#define SAVE_BYTE_ORDER		0x01020304
+#define SAVE_BUFFER_SIZE	65536
+
+enum {
+    SAVE_COORDS_NONE, SAVE_COORDS_STRING, SAVE_COORDS_DOUBLES
+};
+
+typedef struct SaveWriter {
+    Tcl_Channel chan;
+    Tcl_DString ds;		/* Output not yet written to chan. */
+    Tcl_WideInt offset;		/* Bytes made so far, for alignment. */
+    int error;			/* Nonzero once a write has failed. */
+} SaveWriter;
+
+typedef struct LoadReader {
+    unsigned char *p;		/* Next byte to read. */
+    unsigned char *start;
+    unsigned char *end;
+    int swap;			/* Written with the other byte order. */
+    Tcl_HashTable strings;	/* Interned strings -> Tcl_Obj*, so that
+				 * items share their option values. */
+} LoadReader;
+
+/*
+ * A gradient or style touched by a load, to be put back if it fails.
+ */
+
+typedef struct LoadUndo {
+    int isStyle;		/* A style, else a gradient. */
+    Tcl_Obj *nameObj;
+    Tcl_Obj *restoreObj;	/* Name and the old values of the options
+				 * set, or NULL if the load created it. */
+} LoadUndo;
+
+static void	SaveFlush(SaveWriter *writerPtr);
+static void	SavePutBytes(SaveWriter *writerPtr, CONST void *bytes,
+		    int length);
+static void	SavePutInt(SaveWriter *writerPtr, int value);
+static void	SavePutString(SaveWriter *writerPtr, CONST char *string);
+static int	SavePutOptions(Tcl_Interp *interp, SaveWriter *writerPtr,
+		    char *recordPtr, Tk_OptionTable optionTable,
+		    Tk_Window tkwin, CONST char *skip);
+static int	SavePutCoords(Tcl_Interp *interp, SaveWriter *writerPtr,
+		    TkPathCanvas *canvasPtr, Tk_PathItem *itemPtr);
+static int	LoadGetInt(LoadReader *readerPtr, int *valuePtr);
+static int	LoadGetString(LoadReader *readerPtr, Tcl_Obj **objPtrPtr);
+static int	LoadGetCount(LoadReader *readerPtr, int size, int *countPtr);
+static int	LoadGetOptions(LoadReader *readerPtr, Tcl_Obj ***objvPtr,
+		    int *objcPtr, int *sizePtr, int first);
+static void	LoadBumpUid(CONST char *name, CONST char *base, int *uidPtr);
+static void	LoadAddUndo(Tcl_Interp *interp, TkPathCanvas *canvasPtr,
+		    LoadUndo **undoPtrPtr, int *numUndoPtr, int isStyle,
+		    Tcl_Obj *nameObj, int objc, Tcl_Obj *CONST objv[]);
+static void	LoadUndoAll(Tcl_Interp *interp, TkPathCanvas *canvasPtr,
+		    LoadUndo *undoPtr, int numUndo);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathCanvasSaveCmd --
+ *
+ *	Implements 'pathName save channelId'. All items are written, the
+ *	channel is put in binary mode first.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	The canvas is written to the channel.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkPathCanvasSaveCmd(
+    TkPathCanvas *canvasPtr,	/* Information about canvas widget. */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    int objc,			/* Number of arguments. */
+    Tcl_Obj *CONST objv[])	/* Argument objects. */
+{
+    SaveWriter writer;
+    Tcl_Channel chan;
+    Tcl_HashEntry *hPtr;
+    Tcl_HashSearch search;
+    Tk_PathItem *itemPtr;
+    int mode, count;
+    int result = TCL_OK;
+
+    if (objc != 3) {
+	Tcl_WrongNumArgs(interp, 2, objv, "channelId");
+	return TCL_ERROR;
+    }
+    chan = Tcl_GetChannel(interp, Tcl_GetString(objv[2]), &mode);
+    if (chan == NULL) {
+	return TCL_ERROR;
+    }
+    if (!(mode & TCL_WRITABLE)) {
+	Tcl_AppendResult(interp, "channel \"", Tcl_GetString(objv[2]),
+		"\" wasn't opened for writing", NULL);
+	return TCL_ERROR;
+    }
+    if (Tcl_SetChannelOption(interp, chan, "-translation", "binary")
+	    != TCL_OK) {
+	return TCL_ERROR;
+    }
+    writer.chan = chan;
+    writer.offset = 0;
+    writer.error = 0;
+    Tcl_DStringInit(&writer.ds);
+
+    SavePutBytes(&writer, SAVE_MAGIC, 4);
+    SavePutInt(&writer, SAVE_VERSION);
+    SavePutInt(&writer, SAVE_BYTE_ORDER);
+
+    /*
+     * Gradients go first since styles and items refer to them.
+     */
+
+    SavePutInt(&writer, canvasPtr->gradientTable.numEntries);
+    for (hPtr = Tcl_FirstHashEntry(&canvasPtr->gradientTable, &search);
+	    hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	TkPathGradientMaster *gradientPtr =
+		(TkPathGradientMaster *) Tcl_GetHashValue(hPtr);
+
+	SavePutString(&writer,
+		Tcl_GetHashKey(&canvasPtr->gradientTable, hPtr));
+	SavePutString(&writer,
+		(gradientPtr->type == kPathGradientTypeLinear)
+		? "linear" : "radial");
+	result = SavePutOptions(interp, &writer, (char *) gradientPtr,
+		gradientPtr->optionTable, canvasPtr->tkwin, NULL);
+	if (result != TCL_OK) {
+	    goto done;
+	}
+    }
+    SavePutInt(&writer, canvasPtr->styleTable.numEntries);
+    for (hPtr = Tcl_FirstHashEntry(&canvasPtr->styleTable, &search);
+	    hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	Tk_PathStyle *stylePtr = (Tk_PathStyle *) Tcl_GetHashValue(hPtr);
+
+	SavePutString(&writer, Tcl_GetHashKey(&canvasPtr->styleTable, hPtr));
+	result = SavePutOptions(interp, &writer, (char *) stylePtr,
+		stylePtr->optionTable, canvasPtr->tkwin, NULL);
+	if (result != TCL_OK) {
+	    goto done;
+	}
+    }
+    SavePutInt(&writer, canvasPtr->symbolTable.numEntries);
+    for (hPtr = Tcl_FirstHashEntry(&canvasPtr->symbolTable, &search);
+	    hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	TkPathSymbol *symbolPtr = (TkPathSymbol *) Tcl_GetHashValue(hPtr);
+
+	SavePutString(&writer, Tcl_GetHashKey(&canvasPtr->symbolTable, hPtr));
+	SavePutString(&writer, Tcl_GetString(symbolPtr->pathObj));
+    }
+
+    /*
+     * The items in stacking order, which has the parents first.
+     */
+
+    count = 0;
+    for (itemPtr = TkPathCanvasItemIteratorNext(canvasPtr->rootItemPtr);
+	    itemPtr != NULL; itemPtr = TkPathCanvasItemIteratorNext(itemPtr)) {
+	count++;
+    }
+    SavePutInt(&writer, count);
+    for (itemPtr = TkPathCanvasItemIteratorNext(canvasPtr->rootItemPtr);
+	    itemPtr != NULL; itemPtr = TkPathCanvasItemIteratorNext(itemPtr)) {
+	SavePutString(&writer, itemPtr->typePtr->name);
+	SavePutInt(&writer, itemPtr->id);
+	SavePutInt(&writer, itemPtr->parentPtr->id);
+	result = SavePutCoords(interp, &writer, canvasPtr, itemPtr);
+	if (result != TCL_OK) {
+	    goto done;
+	}
+	result = SavePutOptions(interp, &writer, (char *) itemPtr,
+		itemPtr->optionTable, canvasPtr->tkwin, "-parent");
+	if (result != TCL_OK) {
+	    goto done;
+	}
+    }
+    SaveFlush(&writer);
+    Tcl_ResetResult(interp);
+
+  done:
+    if ((result == TCL_OK) && writer.error) {
+	Tcl_AppendResult(interp, "error writing \"", Tcl_GetString(objv[2]),
+		"\": ", Tcl_PosixError(interp), NULL);
+	result = TCL_ERROR;
+    }
+    Tcl_DStringFree(&writer.ds);
+    return result;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathCanvasLoadCmd --
+ *
+ *	Implements 'pathName load channelId'. The items read are added on
+ *	top of those already in the canvas and keep their saved ids unless
+ *	these are in use. Gradients and styles are created with their
+ *	saved names, or reconfigured if the names exist. Either all items
+ *	are made or none, and on failure the gradients and styles are
+ *	deleted or configured back too.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	New items, gradients and styles.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkPathCanvasLoadCmd(
+    TkPathCanvas *canvasPtr,	/* Information about canvas widget. */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    int objc,			/* Number of arguments. */
+    Tcl_Obj *CONST objv[])	/* Argument objects. */
+{
+    LoadReader reader;
+    Tcl_Channel chan;
+    Tcl_Obj *dataObj, *nameObj, *typeObj, *pathObj, *parentObj, **objv2;
+    Tcl_HashTable idMap;
+    Tcl_HashEntry *hPtr;
+    Tcl_HashSearch search;
+    Tk_PathItem *itemPtr, **itemsPtr = NULL;
+    LoadUndo *undoPtr = NULL;
+    CONST char *coords;
+    int mode, length, version, order, count, i, j, n, objc2 = 0, size;
+    int numItems = 0, numUndo = 0, kind, id, parentId, isNew, code;
+    int x1 = 0, y1 = 0, x2 = 0, y2 = 0, gotAny = 0;
+    int result = TCL_ERROR;
+
+    if (objc != 3) {
+	Tcl_WrongNumArgs(interp, 2, objv, "channelId");
+	return TCL_ERROR;
+    }
+    chan = Tcl_GetChannel(interp, Tcl_GetString(objv[2]), &mode);
+    if (chan == NULL) {
+	return TCL_ERROR;
+    }
+    if (!(mode & TCL_READABLE)) {
+	Tcl_AppendResult(interp, "channel \"", Tcl_GetString(objv[2]),
+		"\" wasn't opened for reading", NULL);
+	return TCL_ERROR;
+    }
+    if (Tcl_SetChannelOption(interp, chan, "-translation", "binary")
+	    != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    /*
+     * Everything is read in one go and parsed in memory, where the
+     * coordinate arrays are used in place.
+     */
+
+    dataObj = Tcl_NewObj();
+    Tcl_IncrRefCount(dataObj);
+    if (Tcl_ReadChars(chan, dataObj, -1, 0) < 0) {
+	Tcl_AppendResult(interp, "error reading \"", Tcl_GetString(objv[2]),
+		"\": ", Tcl_PosixError(interp), NULL);
+	Tcl_DecrRefCount(dataObj);
+	return TCL_ERROR;
+    }
+    reader.start = Tcl_GetByteArrayFromObj(dataObj, &length);
+    reader.p = reader.start;
+    reader.end = reader.start + length;
+    reader.swap = 0;
+    Tcl_InitHashTable(&reader.strings, TCL_STRING_KEYS);
+    Tcl_InitHashTable(&idMap, TCL_ONE_WORD_KEYS);
+    size = 16;
+    objv2 = (Tcl_Obj **) ckalloc((unsigned) size * sizeof(Tcl_Obj *));
+    parentObj = Tcl_NewStringObj("-parent", -1);
+    Tcl_IncrRefCount(parentObj);
+
+    if ((length < 12) || (memcmp(reader.p, SAVE_MAGIC, 4) != 0)) {
+	goto badFile;
+    }
+    memcpy(&order, reader.p + 8, 4);
+    reader.swap = (order != SAVE_BYTE_ORDER);
+    reader.p += 4;
+    LoadGetInt(&reader, &version);
+    LoadGetInt(&reader, &order);
+    if (order != SAVE_BYTE_ORDER) {
+	goto badFile;
+    }
+    if ((version < 1) || (version > SAVE_VERSION)) {
+	char buf[TCL_INTEGER_SPACE];
+
+	sprintf(buf, "%d", version);
+	Tcl_AppendResult(interp, "unsupported version ", buf,
+		" of saved canvas", NULL);
+	goto cleanup;
+    }
+
+    /*
+     * Gradients and styles. The uid counters are moved past the saved
+     * names so that later create commands don't reuse them.
+     */
+
+    if (LoadGetCount(&reader, 12, &count) != TCL_OK) {
+	goto badFile;
+    }
+    for (i = 0; i < count; i++) {
+	if ((LoadGetString(&reader, &nameObj) != TCL_OK)
+		|| (LoadGetString(&reader, &typeObj) != TCL_OK)
+		|| (LoadGetOptions(&reader, &objv2, &objc2, &size, 1)
+		    != TCL_OK)) {
+	    goto badFile;
+	}
+	if (Tcl_FindHashEntry(&canvasPtr->gradientTable,
+		Tcl_GetString(nameObj)) != NULL) {
+	    if (objc2 > 1) {
+		objv2[0] = nameObj;
+		LoadAddUndo(interp, canvasPtr, &undoPtr, &numUndo, 0,
+			nameObj, objc2, objv2);
+		if (PathGradientConfigure(interp, canvasPtr->tkwin, objc2,
+			objv2, &canvasPtr->gradientTable) != TCL_OK) {
+		    goto cleanup;
+		}
+	    }
+	} else {
+	    objv2[0] = typeObj;
+	    if (PathGradientCreate(interp, canvasPtr->tkwin, objc2, objv2,
+		    &canvasPtr->gradientTable, Tcl_GetString(nameObj))
+		    != TCL_OK) {
+		goto cleanup;
+	    }
+	    LoadAddUndo(interp, canvasPtr, &undoPtr, &numUndo, 0,
+		    nameObj, 0, NULL);
+	    LoadBumpUid(Tcl_GetString(nameObj), "gradient",
+		    &canvasPtr->gradientUid);
+	}
+    }
+    if (LoadGetCount(&reader, 8, &count) != TCL_OK) {
+	goto badFile;
+    }
+    for (i = 0; i < count; i++) {
+	if ((LoadGetString(&reader, &nameObj) != TCL_OK)
+		|| (LoadGetOptions(&reader, &objv2, &objc2, &size, 1)
+		    != TCL_OK)) {
+	    goto badFile;
+	}
+	if (Tcl_FindHashEntry(&canvasPtr->styleTable,
+		Tcl_GetString(nameObj)) != NULL) {
+	    if (objc2 > 1) {
+		objv2[0] = nameObj;
+		LoadAddUndo(interp, canvasPtr, &undoPtr, &numUndo, 1,
+			nameObj, objc2, objv2);
+		if (PathStyleConfigure(interp, canvasPtr->tkwin, objc2, objv2,
+			&canvasPtr->styleTable, &canvasPtr->gradientTable)
+			!= TCL_OK) {
+		    goto cleanup;
+		}
+	    }
+	} else {
+	    if (PathStyleCreate(interp, canvasPtr->tkwin, objc2-1, objv2+1,
+		    &canvasPtr->styleTable, &canvasPtr->gradientTable,
+		    Tcl_GetString(nameObj)) != TCL_OK) {
+		goto cleanup;
+	    }
+	    LoadAddUndo(interp, canvasPtr, &undoPtr, &numUndo, 1,
+		    nameObj, 0, NULL);
+	    LoadBumpUid(Tcl_GetString(nameObj), "style",
+		    &canvasPtr->styleUid);
+	}
+    }
+
+    /*
+     * Symbols can't be redefined. One of the same name is kept if it
+     * has the same geometry, else the saved items can't be drawn.
+     */
+
+    count = 0;
+    if ((version >= 2) && (LoadGetCount(&reader, 8, &count) != TCL_OK)) {
+	goto badFile;
+    }
+    for (i = 0; i < count; i++) {
+	if ((LoadGetString(&reader, &nameObj) != TCL_OK)
+		|| (LoadGetString(&reader, &pathObj) != TCL_OK)) {
+	    goto badFile;
+	}
+	hPtr = Tcl_FindHashEntry(&canvasPtr->symbolTable,
+		Tcl_GetString(nameObj));
+	if (hPtr == NULL) {
+	    if (TkPathCanvasSymbolCreate(interp, canvasPtr,
+		    Tcl_GetString(nameObj), pathObj) != TCL_OK) {
+		goto cleanup;
+	    }
+	} else if (strcmp(Tcl_GetString(pathObj), Tcl_GetString(
+		((TkPathSymbol *) Tcl_GetHashValue(hPtr))->pathObj)) != 0) {
+	    Tcl_AppendResult(interp, "symbol \"", Tcl_GetString(nameObj),
+		    "\" already exists", NULL);
+	    goto cleanup;
+	}
+    }
+
+    /*
+     * The items. Like createmany only the union of their bounding boxes
+     * is scheduled for redisplay.
+     */
+
+    if (LoadGetCount(&reader, 20, &count) != TCL_OK) {
+	goto badFile;
+    }
+    itemsPtr = (Tk_PathItem **) ckalloc((unsigned)
+	    (count + 1) * sizeof(Tk_PathItem *));
+    for (i = 0; i < count; i++) {
+	objc2 = 0;
+	if ((LoadGetString(&reader, &typeObj) != TCL_OK)
+		|| (LoadGetInt(&reader, &id) != TCL_OK)
+		|| (LoadGetInt(&reader, &parentId) != TCL_OK)
+		|| (LoadGetInt(&reader, &kind) != TCL_OK)) {
+	    goto badFile;
+	}
+
+	/*
+	 * Coords first, then -parent and the options. Doubles are
+	 * handed over as they are in the file, swapped in place if
+	 * need be.
+	 */
+
+	coords = NULL;
+	n = 0;
+	switch (kind) {
+	case SAVE_COORDS_NONE:
+	    break;
+	case SAVE_COORDS_STRING:
+	    if (LoadGetString(&reader, objv2 + objc2++) != TCL_OK) {
+		goto badFile;
+	    }
+	    break;
+	case SAVE_COORDS_DOUBLES: {
+	    if (LoadGetCount(&reader, 8, &n) != TCL_OK) {
+		goto badFile;
+	    }
+	    reader.p = reader.start + ((reader.p - reader.start + 7) & ~7);
+	    if (reader.p + 8 * n > reader.end) {
+		goto badFile;
+	    }
+	    if (reader.swap) {
+		for (j = 0; j < n; j++) {
+		    unsigned char *q = reader.p + 8 * j, c;
+		    int k;
+
+		    for (k = 0; k < 4; k++) {
+			c = q[k], q[k] = q[7-k], q[7-k] = c;
+		    }
+		}
+	    }
+	    coords = (CONST char *) reader.p;
+	    reader.p += 8 * n;
+	    break;
+	}
+	default:
+	    goto badFile;
+	}
+	if (parentId != 0) {
+	    hPtr = Tcl_FindHashEntry(&idMap, (char *) INT2PTR(parentId));
+	    if (hPtr != NULL) {
+		if (objc2 + 2 > size) {
+		    size = objc2 + 16;
+		    objv2 = (Tcl_Obj **) ckrealloc((char *) objv2,
+			    (unsigned) size * sizeof(Tcl_Obj *));
+		}
+		objv2[objc2++] = parentObj;
+		objv2[objc2++] = Tcl_NewIntObj(
+			((Tk_PathItem *) Tcl_GetHashValue(hPtr))->id);
+	    }
+	}
+	if (LoadGetOptions(&reader, &objv2, &objc2, &size, 0) != TCL_OK) {
+	    goto badFile;
+	}
+	for (j = 0; j < objc2; j++) {
+	    Tcl_IncrRefCount(objv2[j]);
+	}
+	code = TkPathCanvasCreateItem(interp, canvasPtr, typeObj, id,
+		coords, n, objc2, objv2, &itemPtr);
+	for (j = 0; j < objc2; j++) {
+	    Tcl_DecrRefCount(objv2[j]);
+	}
+	objc2 = 0;
+	if (code != TCL_OK) {
+	    goto cleanup;
+	}
+	itemsPtr[numItems++] = itemPtr;
+	hPtr = Tcl_CreateHashEntry(&idMap, (char *) INT2PTR(id), &isNew);
+	Tcl_SetHashValue(hPtr, itemPtr);
+	if ((itemPtr->x1 < itemPtr->x2) && (itemPtr->y1 < itemPtr->y2)) {
+	    if (gotAny) {
+		x1 = MIN(x1, itemPtr->x1);
+		y1 = MIN(y1, itemPtr->y1);
+		x2 = MAX(x2, itemPtr->x2);
+		y2 = MAX(y2, itemPtr->y2);
+	    } else {
+		x1 = itemPtr->x1;
+		y1 = itemPtr->y1;
+		x2 = itemPtr->x2;
+		y2 = itemPtr->y2;
+		gotAny = 1;
+	    }
+	}
+    }
+    if (gotAny) {
+	Tk_PathCanvasEventuallyRedraw((Tk_PathCanvas) canvasPtr,
+		x1, y1, x2, y2);
+    }
+    canvasPtr->flags |= REPICK_NEEDED;
+    Tcl_ResetResult(interp);
+    result = TCL_OK;
+    goto cleanup;
+
+  badFile:
+
+    /*
+     * The parent id of an item not yet made has no other reference.
+     */
+
+    for (j = 0; j < objc2; j++) {
+	if ((objv2[j] != NULL) && (objv2[j]->refCount == 0)) {
+	    Tcl_IncrRefCount(objv2[j]);
+	    Tcl_DecrRefCount(objv2[j]);
+	}
+    }
+    Tcl_ResetResult(interp);
+    Tcl_AppendResult(interp, "\"", Tcl_GetString(objv[2]),
+	    "\" is not a valid saved canvas", NULL);
+
+  cleanup:
+    if (result != TCL_OK) {
+
+	/*
+	 * All or nothing: remove the items made so far, last first
+	 * so that children go before their groups.
+	 */
+
+	while (numItems-- > 0) {
+	    TkPathCanvasDeleteItem(canvasPtr, itemsPtr[numItems]);
+	}
+	LoadUndoAll(interp, canvasPtr, undoPtr, numUndo);
+    } else {
+	for (i = 0; i < numUndo; i++) {
+	    if (undoPtr[i].restoreObj != NULL) {
+		Tcl_DecrRefCount(undoPtr[i].restoreObj);
+	    }
+	}
+    }
+    if (undoPtr != NULL) {
+	ckfree((char *) undoPtr);
+    }
+    if (itemsPtr != NULL) {
+	ckfree((char *) itemsPtr);
+    }
+    ckfree((char *) objv2);
+    Tcl_DecrRefCount(parentObj);
+    for (hPtr = Tcl_FirstHashEntry(&reader.strings, &search); hPtr != NULL;
+	    hPtr = Tcl_NextHashEntry(&search)) {
+	Tcl_DecrRefCount((Tcl_Obj *) Tcl_GetHashValue(hPtr));
+    }
+    Tcl_DeleteHashTable(&reader.strings);
+    Tcl_DeleteHashTable(&idMap);
+    Tcl_DecrRefCount(dataObj);
+    return result;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SavePutBytes, SavePutInt, SavePutString, SaveFlush --
+ *
+ *	Buffered output to the channel. Errors are only noted here and
+ *	reported when all is written.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+SavePutBytes(
+    SaveWriter *writerPtr,
+    CONST void *bytes,
+    int length)
+{
+    Tcl_DStringAppend(&writerPtr->ds, (CONST char *) bytes, length);
+    writerPtr->offset += length;
+    if (Tcl_DStringLength(&writerPtr->ds) >= SAVE_BUFFER_SIZE) {
+	SaveFlush(writerPtr);
+    }
+}
+
+static void
+SavePutInt(
+    SaveWriter *writerPtr,
+    int value)
+{
+    SavePutBytes(writerPtr, &value, 4);
+}
+
+static void
+SavePutString(
+    SaveWriter *writerPtr,
+    CONST char *string)
+{
+    int length = strlen(string);
+
+    SavePutInt(writerPtr, length);
+    SavePutBytes(writerPtr, string, length);
+}
+
+static void
+SaveFlush(
+    SaveWriter *writerPtr)
+{
+    if (!writerPtr->error && (Tcl_Write(writerPtr->chan,
+	    Tcl_DStringValue(&writerPtr->ds),
+	    Tcl_DStringLength(&writerPtr->ds)) < 0)) {
+	writerPtr->error = 1;
+    }
+    Tcl_DStringSetLength(&writerPtr->ds, 0);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SavePutOptions --
+ *
+ *	Writes the options of a record that differ from their defaults,
+ *	leaving out synonyms and the option skip if not NULL.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	Output made.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+SavePutOptions(
+    Tcl_Interp *interp,
+    SaveWriter *writerPtr,
+    char *recordPtr,
+    Tk_OptionTable optionTable,
+    Tk_Window tkwin,
+    CONST char *skip)
+{
+    Tcl_Obj *infoObj, **infov, **elemv;
+    int infoc, elemc, i, pass, count = 0;
+
+    infoObj = Tk_GetOptionInfo(interp, recordPtr, optionTable, NULL, tkwin);
+    if (infoObj == NULL) {
+	return TCL_ERROR;
+    }
+    Tcl_IncrRefCount(infoObj);
+    Tcl_ListObjGetElements(NULL, infoObj, &infoc, &infov);
+
+    /*
+     * The first pass counts, the second writes.
+     */
+
+    for (pass = 0; pass < 2; pass++) {
+	if (pass == 1) {
+	    SavePutInt(writerPtr, count);
+	}
+	for (i = 0; i < infoc; i++) {
+	    CONST char *name;
+
+	    Tcl_ListObjGetElements(NULL, infov[i], &elemc, &elemv);
+	    if (elemc != 5) {
+		continue;
+	    }
+	    name = Tcl_GetString(elemv[0]);
+	    if (((skip != NULL) && (strcmp(name, skip) == 0))
+		    || (strcmp(Tcl_GetString(elemv[3]),
+			Tcl_GetString(elemv[4])) == 0)) {
+		continue;
+	    }
+	    if (pass == 0) {
+		count++;
+	    } else {
+		SavePutString(writerPtr, name);
+		SavePutString(writerPtr, Tcl_GetString(elemv[4]));
+	    }
+	}
+    }
+    Tcl_DecrRefCount(infoObj);
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SavePutCoords --
+ *
+ *	Writes the coords of an item as returned by its coordProc. A list
+ *	of numbers is written as doubles, anything else as a string.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	Output made, the interp result is changed.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+SavePutCoords(
+    Tcl_Interp *interp,
+    SaveWriter *writerPtr,
+    TkPathCanvas *canvasPtr,
+    Tk_PathItem *itemPtr)
+{
+    Tcl_Obj *coordsObj, **elemv;
+    double d;
+    int elemc, i, length;
+
+    if (itemPtr->typePtr->coordProc == NULL) {
+	SavePutInt(writerPtr, SAVE_COORDS_NONE);
+	return TCL_OK;
+    }
+    Tcl_ResetResult(interp);
+    if ((*itemPtr->typePtr->coordProc)(interp, (Tk_PathCanvas) canvasPtr,
+	    itemPtr, 0, NULL) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    coordsObj = Tcl_GetObjResult(interp);
+    Tcl_GetStringFromObj(coordsObj, &length);
+    if (length == 0) {
+	SavePutInt(writerPtr, SAVE_COORDS_NONE);
+	return TCL_OK;
+    }
+    if (Tcl_ListObjGetElements(NULL, coordsObj, &elemc, &elemv) == TCL_OK) {
+	for (i = 0; i < elemc; i++) {
+	    if (Tcl_GetDoubleFromObj(NULL, elemv[i], &d) != TCL_OK) {
+		break;
+	    }
+	}
+	if (i == elemc) {
+	    SavePutInt(writerPtr, SAVE_COORDS_DOUBLES);
+	    SavePutInt(writerPtr, elemc);
+	    while (writerPtr->offset & 7) {
+		SavePutBytes(writerPtr, "", 1);
+	    }
+	    for (i = 0; i < elemc; i++) {
+		Tcl_GetDoubleFromObj(NULL, elemv[i], &d);
+		SavePutBytes(writerPtr, &d, 8);
+	    }
+	    return TCL_OK;
+	}
+    }
+    SavePutInt(writerPtr, SAVE_COORDS_STRING);
+    SavePutString(writerPtr, Tcl_GetString(coordsObj));
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * LoadGetInt, LoadGetCount, LoadGetString --
+ *
+ *	Read from the in memory file. A count is checked against the
+ *	smallest size of what it counts so that a damaged file can't
+ *	make us allocate without bounds. Strings are interned.
+ *
+ * Results:
+ *	TCL_ERROR if the file ends too early.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+LoadGetInt(
+    LoadReader *readerPtr,
+    int *valuePtr)
+{
+    unsigned char *p = readerPtr->p;
+
+    if (p + 4 > readerPtr->end) {
+	return TCL_ERROR;
+    }
+    if (readerPtr->swap) {
+	unsigned char bytes[4];
+
+	bytes[0] = p[3], bytes[1] = p[2], bytes[2] = p[1], bytes[3] = p[0];
+	memcpy(valuePtr, bytes, 4);
+    } else {
+	memcpy(valuePtr, p, 4);
+    }
+    readerPtr->p += 4;
+    return TCL_OK;
+}
+
+static int
+LoadGetCount(
+    LoadReader *readerPtr,
+    int size,
+    int *countPtr)
+{
+    if (LoadGetInt(readerPtr, countPtr) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    if ((*countPtr < 0)
+	    || (*countPtr > (readerPtr->end - readerPtr->p) / size)) {
+	return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+static int
+LoadGetString(
+    LoadReader *readerPtr,
+    Tcl_Obj **objPtrPtr)
+{
+    Tcl_DString ds;
+    Tcl_HashEntry *hPtr;
+    int length, isNew;
+
+    if (LoadGetCount(readerPtr, 1, &length) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    Tcl_DStringInit(&ds);
+    Tcl_DStringAppend(&ds, (char *) readerPtr->p, length);
+    readerPtr->p += length;
+    hPtr = Tcl_CreateHashEntry(&readerPtr->strings, Tcl_DStringValue(&ds),
+	    &isNew);
+    if (isNew) {
+	*objPtrPtr = Tcl_NewStringObj(Tcl_DStringValue(&ds),
+		Tcl_DStringLength(&ds));
+	Tcl_IncrRefCount(*objPtrPtr);
+	Tcl_SetHashValue(hPtr, *objPtrPtr);
+    } else {
+	*objPtrPtr = (Tcl_Obj *) Tcl_GetHashValue(hPtr);
+    }
+    Tcl_DStringFree(&ds);
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * LoadGetOptions --
+ *
+ *	Reads options, and appends the names and values to the array
+ *	*objvPtr which is grown as needed. With first set one empty slot
+ *	is left at the start for the caller, set to NULL.
+ *
+ * Results:
+ *	TCL_ERROR if the file is damaged.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+LoadGetOptions(
+    LoadReader *readerPtr,
+    Tcl_Obj ***objvPtr,
+    int *objcPtr,
+    int *sizePtr,
+    int first)
+{
+    int count, i;
+
+    if (LoadGetCount(readerPtr, 8, &count) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    count *= 2;
+    if (first) {
+	*objcPtr = 1;
+    }
+    if (*objcPtr + count + 2 > *sizePtr) {
+	*sizePtr = *objcPtr + count + 16;
+	*objvPtr = (Tcl_Obj **) ckrealloc((char *) *objvPtr,
+		(unsigned) *sizePtr * sizeof(Tcl_Obj *));
+    }
+    if (first) {
+	(*objvPtr)[0] = NULL;
+    }
+    for (i = 0; i < count; i++) {
+	if (LoadGetString(readerPtr, *objvPtr + *objcPtr) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	(*objcPtr)++;
+    }
+    return TCL_OK;
+}
+
+/*
+ * LoadBumpUid --
+ *
+ *	Moves a name counter past a loaded name made from base.
+ */
+
+static void
+LoadBumpUid(
+    CONST char *name,
+    CONST char *base,
+    int *uidPtr)
+{
+    int length = strlen(base), n;
+    char *end;
+
+    if (strncmp(name, base, length) == 0) {
+	n = (int) strtol(name + length, &end, 10);
+	if ((end != name + length) && (*end == '\0') && (n >= *uidPtr)) {
+	    *uidPtr = n + 1;
+	}
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * LoadAddUndo, LoadUndoAll --
+ *
+ *	Note a gradient or style created by the load, or the old values
+ *	of the options it is about to set on one that exists, and put
+ *	them all back when the load fails, last first.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Gradients and styles are deleted or configured. The interp
+ *	result is kept.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+LoadAddUndo(
+    Tcl_Interp *interp,
+    TkPathCanvas *canvasPtr,
+    LoadUndo **undoPtrPtr,
+    int *numUndoPtr,
+    int isStyle,
+    Tcl_Obj *nameObj,
+    int objc,			/* The name followed by option value */
+    Tcl_Obj *CONST objv[])	/* pairs, or 0 if created. */
+{
+    LoadUndo *undoPtr;
+    Tcl_Obj *cgetv[2];
+    int i, code;
+
+    if ((*numUndoPtr & 15) == 0) {
+	*undoPtrPtr = (LoadUndo *) ckrealloc((char *) *undoPtrPtr,
+		(unsigned) (*numUndoPtr + 16) * sizeof(LoadUndo));
+    }
+    undoPtr = *undoPtrPtr + (*numUndoPtr)++;
+    undoPtr->isStyle = isStyle;
+    undoPtr->nameObj = nameObj;
+    undoPtr->restoreObj = NULL;
+    if (objc == 0) {
+	return;
+    }
+
+    /*
+     * Options that can't be read can't be set either, so the configure
+     * will fail on them before anything is changed.
+     */
+
+    undoPtr->restoreObj = Tcl_NewListObj(1, &nameObj);
+    Tcl_IncrRefCount(undoPtr->restoreObj);
+    cgetv[0] = nameObj;
+    for (i = 1; i + 1 < objc; i += 2) {
+	cgetv[1] = objv[i];
+	if (isStyle) {
+	    code = PathStyleCget(interp, canvasPtr->tkwin, 2, cgetv,
+		    &canvasPtr->styleTable);
+	} else {
+	    code = PathGradientCget(interp, canvasPtr->tkwin, 2, cgetv,
+		    &canvasPtr->gradientTable);
+	}
+	if (code == TCL_OK) {
+	    Tcl_ListObjAppendElement(NULL, undoPtr->restoreObj, objv[i]);
+	    Tcl_ListObjAppendElement(NULL, undoPtr->restoreObj,
+		    Tcl_GetObjResult(interp));
+	}
+    }
+    Tcl_ResetResult(interp);
+}
+
+static void
+LoadUndoAll(
+    Tcl_Interp *interp,
+    TkPathCanvas *canvasPtr,
+    LoadUndo *undoPtr,
+    int numUndo)
+{
+    Tcl_Obj *resultObj, **elemv;
+    int elemc;
+
+    resultObj = Tcl_GetObjResult(interp);
+    Tcl_IncrRefCount(resultObj);
+    while (numUndo-- > 0) {
+	LoadUndo *u = undoPtr + numUndo;
+
+	if (u->restoreObj == NULL) {
+	    if (u->isStyle) {
+		PathStyleDelete(interp, u->nameObj, &canvasPtr->styleTable,
+			canvasPtr->tkwin);
+	    } else {
+		PathGradientDelete(interp, u->nameObj,
+			&canvasPtr->gradientTable);
+	    }
+	    continue;
+	}
+	Tcl_ListObjGetElements(NULL, u->restoreObj, &elemc, &elemv);
+	if (elemc > 1) {
+	    if (u->isStyle) {
+		PathStyleConfigure(interp, canvasPtr->tkwin, elemc, elemv,
+			&canvasPtr->styleTable, &canvasPtr->gradientTable);
+	    } else {
+		PathGradientConfigure(interp, canvasPtr->tkwin, elemc, elemv,
+			&canvasPtr->gradientTable);
+	    }
+	}
+	Tcl_DecrRefCount(u->restoreObj);
+    }
+    Tcl_SetObjResult(interp, resultObj);
+    Tcl_DecrRefCount(resultObj);
+}
+
+/*----------------------------------------------------------------------*/
@@ -0,0 +1,467 @@
+/*
+ * tkCanvStats.c --
+ *
+ *	This module implements the "stats" widget command that reports
+ *	where the redraw time of a canvas goes. Counting is off by default
+ *	and then costs the canvas no more than a test of its statsPtr, so
+ *	it can be left in production builds.
+ *
+ * Copyright (c) 2026  tkpath contributors
+ *
+ * $Id$
+ */
+
+#include "tkIntPath.h"
+#include "tkpCanvas.h"
+#include "tkCanvPathUtil.h"
+
+typedef struct ThreadSpecificData {
+    TkPathCanvasStats *drawingPtr;	/* Stats of the canvas being drawn by
+					 * DisplayCanvas, else NULL. */
+} ThreadSpecificData;
+
+static Tcl_ThreadDataKey dataKey;
+
+/*
+ * Number of threads drawing a canvas with statistics. Lets the timed
+ * wrappers skip the thread data lookup when nobody collects any.
+ */
+
+static int numDrawing = 0;
+TCL_DECLARE_MUTEX(statsMutex)
+
+static void	StatsSetDrawing(ThreadSpecificData *tsdPtr,
+		    TkPathCanvasStats *statsPtr);
+
+static void	StatsReset(TkPathCanvasStats *statsPtr);
+static Tcl_Obj *StatsTimeObj(TkPathStatsTime *timePtr);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathCanvasStatsCmd --
+ *
+ *	Implements 'pathName stats ?-enable boolean? ?-reset?'. Returns
+ *	the statistics gathered since the last reset as a key value list:
+ *
+ *	    enabled  1 if statistics are collected
+ *	    frames   number of redraws
+ *	    last     {visited drawn pixels usec} of each of the last frames
+ *	    types    'typeName {count usec}' for the displayProc calls
+ *	    context  {count usec} of TkPathInit and TkPathFree
+ *	    pixmaps, picks, hittests, searches, scanned
+ *
+ *	With -reset the counters are cleared after they were read.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	May enable or disable the statistics.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkPathCanvasStatsCmd(
+    TkPathCanvas *canvasPtr,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[])	/* Arguments, the first two are pathName
+				 * and "stats". */
+{
+    TkPathCanvasStats *statsPtr;
+    Tcl_Obj *listObj, *subObj;
+    Tcl_HashEntry *hPtr;
+    Tcl_HashSearch search;
+    int i, first, enable = -1, reset = 0;
+    static CONST char *optionStrings[] = {
+	"-enable", "-reset", NULL
+    };
+    enum options {
+	STATS_ENABLE, STATS_RESET
+    };
+
+    for (i = 2; i < objc; i++) {
+	int index;
+
+	if (Tcl_GetIndexFromObj(interp, objv[i], optionStrings, "option", 0,
+		&index) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	switch ((enum options) index) {
+	case STATS_ENABLE:
+	    if (i + 1 >= objc) {
+		Tcl_AppendResult(interp, "value for \"-enable\" missing", NULL);
+		return TCL_ERROR;
+	    }
+	    if (Tcl_GetBooleanFromObj(interp, objv[++i], &enable) != TCL_OK) {
+		return TCL_ERROR;
+	    }
+	    break;
+	case STATS_RESET:
+	    reset = 1;
+	    break;
+	}
+    }
+    if (enable == 0) {
+	TkPathCanvasStatsFree(canvasPtr);
+    } else if ((enable == 1) && (canvasPtr->statsPtr == NULL)) {
+	statsPtr = (TkPathCanvasStats *) ckalloc(sizeof(TkPathCanvasStats));
+	Tcl_InitHashTable(&statsPtr->typeTable, TCL_ONE_WORD_KEYS);
+	StatsReset(statsPtr);
+	canvasPtr->statsPtr = statsPtr;
+    }
+    statsPtr = canvasPtr->statsPtr;
+
+    listObj = Tcl_NewListObj(0, NULL);
+    Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewStringObj("enabled", -1));
+    Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewBooleanObj(statsPtr != NULL));
+    if (statsPtr == NULL) {
+	Tcl_SetObjResult(interp, listObj);
+	return TCL_OK;
+    }
+    Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewStringObj("frames", -1));
+    Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewIntObj(statsPtr->numFrames));
+
+    /*
+     * The ring of frames, oldest first.
+     */
+
+    subObj = Tcl_NewListObj(0, NULL);
+    first = MAX(0, statsPtr->numFrames - TK_PATH_STATS_FRAMES);
+    for (i = first; i < statsPtr->numFrames; i++) {
+	TkPathStatsFrame *framePtr =
+		statsPtr->frames + (i % TK_PATH_STATS_FRAMES);
+	Tcl_Obj *frameObj[4];
+
+	frameObj[0] = Tcl_NewIntObj(framePtr->visited);
+	frameObj[1] = Tcl_NewIntObj(framePtr->drawn);
+	frameObj[2] = Tcl_NewWideIntObj(framePtr->pixels);
+	frameObj[3] = Tcl_NewWideIntObj(framePtr->usec);
+	Tcl_ListObjAppendElement(NULL, subObj, Tcl_NewListObj(4, frameObj));
+    }
+    Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewStringObj("last", -1));
+    Tcl_ListObjAppendElement(NULL, listObj, subObj);
+
+    subObj = Tcl_NewListObj(0, NULL);
+    for (hPtr = Tcl_FirstHashEntry(&statsPtr->typeTable, &search);
+	    hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	Tk_PathItemType *typePtr = (Tk_PathItemType *)
+		Tcl_GetHashKey(&statsPtr->typeTable, hPtr);
+
+	Tcl_ListObjAppendElement(NULL, subObj,
+		Tcl_NewStringObj(typePtr->name, -1));
+	Tcl_ListObjAppendElement(NULL, subObj,
+		StatsTimeObj((TkPathStatsTime *) Tcl_GetHashValue(hPtr)));
+    }
+    Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewStringObj("types", -1));
+    Tcl_ListObjAppendElement(NULL, listObj, subObj);
+    Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewStringObj("context", -1));
+    Tcl_ListObjAppendElement(NULL, listObj, StatsTimeObj(&statsPtr->context));
+    Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewStringObj("pixmaps", -1));
+    Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewIntObj(statsPtr->pixmaps));
+    Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewStringObj("picks", -1));
+    Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewIntObj(statsPtr->picks));
+    Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewStringObj("hittests", -1));
+    Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewIntObj(statsPtr->hitTests));
+    Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewStringObj("searches", -1));
+    Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewIntObj(statsPtr->searches));
+    Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewStringObj("scanned", -1));
+    Tcl_ListObjAppendElement(NULL, listObj,
+	    Tcl_NewWideIntObj(statsPtr->scanned));
+    Tcl_SetObjResult(interp, listObj);
+    if (reset) {
+	StatsReset(statsPtr);
+    }
+    return TCL_OK;
+}
+
+static Tcl_Obj *
+StatsTimeObj(
+    TkPathStatsTime *timePtr)
+{
+    Tcl_Obj *objv[2];
+
+    objv[0] = Tcl_NewIntObj(timePtr->count);
+    objv[1] = Tcl_NewWideIntObj(timePtr->usec);
+    return Tcl_NewListObj(2, objv);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * StatsReset, TkPathCanvasStatsFree --
+ *
+ *	Clears the statistics of a canvas, or frees them which also turns
+ *	off collecting them.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Memory freed.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+StatsReset(
+    TkPathCanvasStats *statsPtr)
+{
+    Tcl_HashEntry *hPtr;
+    Tcl_HashSearch search;
+
+    for (hPtr = Tcl_FirstHashEntry(&statsPtr->typeTable, &search);
+	    hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	ckfree((char *) Tcl_GetHashValue(hPtr));
+    }
+    Tcl_DeleteHashTable(&statsPtr->typeTable);
+    memset(statsPtr, 0, sizeof(TkPathCanvasStats));
+    Tcl_InitHashTable(&statsPtr->typeTable, TCL_ONE_WORD_KEYS);
+}
+
+void
+TkPathCanvasStatsFree(
+    TkPathCanvas *canvasPtr)
+{
+    TkPathCanvasStats *statsPtr = canvasPtr->statsPtr;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    if (statsPtr == NULL) {
+	return;
+    }
+    if (tsdPtr->drawingPtr == statsPtr) {
+	StatsSetDrawing(tsdPtr, NULL);
+    }
+    StatsReset(statsPtr);
+    Tcl_DeleteHashTable(&statsPtr->typeTable);
+    ckfree((char *) statsPtr);
+    canvasPtr->statsPtr = NULL;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * StatsSetDrawing --
+ *
+ *	Sets the stats of the canvas this thread draws and keeps the
+ *	count of drawing threads.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	numDrawing may change.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+StatsSetDrawing(
+    ThreadSpecificData *tsdPtr,
+    TkPathCanvasStats *statsPtr)
+{
+    if ((tsdPtr->drawingPtr == NULL) != (statsPtr == NULL)) {
+	Tcl_MutexLock(&statsMutex);
+	numDrawing += (statsPtr == NULL) ? -1 : 1;
+	Tcl_MutexUnlock(&statsMutex);
+    }
+    tsdPtr->drawingPtr = statsPtr;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathStatsBeginFrame, TkPathStatsEndFrame --
+ *
+ *	Called by DisplayCanvas around a redraw when statistics are
+ *	enabled. While drawing, TkPathTimedInit and TkPathTimedFree add
+ *	to the context time of this canvas.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	A frame is added to the ring.
+ *
+ *--------------------------------------------------------------
+ */
+
+void
+TkPathStatsBeginFrame(
+    TkPathCanvas *canvasPtr)
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    StatsSetDrawing(tsdPtr, canvasPtr->statsPtr);
+    Tcl_GetTime(&canvasPtr->statsPtr->frameStart);
+}
+
+void
+TkPathStatsEndFrame(
+    TkPathCanvas *canvasPtr,
+    int visited, int drawn,
+    Tcl_WideInt pixels)
+{
+    TkPathCanvasStats *statsPtr = canvasPtr->statsPtr;
+    TkPathStatsFrame *framePtr;
+    TkPathStatsTime frameTime;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    StatsSetDrawing(tsdPtr, NULL);
+    if (statsPtr == NULL) {
+	return;
+    }
+    frameTime.count = 0;
+    frameTime.usec = 0;
+    TkPathStatsAddTime(&frameTime, &statsPtr->frameStart);
+    framePtr = statsPtr->frames
+	    + (statsPtr->numFrames % TK_PATH_STATS_FRAMES);
+    framePtr->visited = visited;
+    framePtr->drawn = drawn;
+    framePtr->pixels = pixels;
+    framePtr->usec = frameTime.usec;
+    statsPtr->numFrames++;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathStatsAddTime --
+ *
+ *	Adds one call lasting from startPtr until now to timePtr.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+void
+TkPathStatsAddTime(
+    TkPathStatsTime *timePtr,
+    Tcl_Time *startPtr)
+{
+    Tcl_Time now;
+
+    Tcl_GetTime(&now);
+    timePtr->count++;
+    timePtr->usec += (Tcl_WideInt) (now.sec - startPtr->sec) * 1000000
+	    + (now.usec - startPtr->usec);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathStatsTypeTime --
+ *
+ *	Finds the displayProc time record of an item type.
+ *
+ * Results:
+ *	The record, made on first use.
+ *
+ * Side effects:
+ *	Memory may be allocated.
+ *
+ *--------------------------------------------------------------
+ */
+
+TkPathStatsTime *
+TkPathStatsTypeTime(
+    TkPathCanvasStats *statsPtr,
+    Tk_PathItemType *typePtr)
+{
+    Tcl_HashEntry *hPtr;
+    TkPathStatsTime *timePtr;
+    int isNew;
+
+    hPtr = Tcl_CreateHashEntry(&statsPtr->typeTable, (char *) typePtr,
+	    &isNew);
+    if (isNew) {
+	timePtr = (TkPathStatsTime *) ckalloc(sizeof(TkPathStatsTime));
+	timePtr->count = 0;
+	timePtr->usec = 0;
+	Tcl_SetHashValue(hPtr, timePtr);
+    } else {
+	timePtr = (TkPathStatsTime *) Tcl_GetHashValue(hPtr);
+    }
+    return timePtr;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathTimedInit, TkPathTimedFree --
+ *
+ *	Wrap TkPathInit and TkPathFree for the items and count the time
+ *	spent in them when the canvas being drawn collects statistics.
+ *	Unless some thread draws such a canvas they only test numDrawing.
+ *
+ * Results:
+ *	As TkPathInit and TkPathFree.
+ *
+ * Side effects:
+ *	As TkPathInit and TkPathFree.
+ *
+ *--------------------------------------------------------------
+ */
+
+TkPathContext
+TkPathTimedInit(
+    Tk_Window tkwin,
+    Drawable d)
+{
+    ThreadSpecificData *tsdPtr;
+    TkPathContext context;
+    Tcl_Time start;
+
+    if (numDrawing == 0) {
+	return TkPathInit(tkwin, d);
+    }
+    tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    if (tsdPtr->drawingPtr == NULL) {
+	return TkPathInit(tkwin, d);
+    }
+    Tcl_GetTime(&start);
+    context = TkPathInit(tkwin, d);
+    TkPathStatsAddTime(&tsdPtr->drawingPtr->context, &start);
+    return context;
+}
+
+void
+TkPathTimedFree(
+    TkPathContext context)
+{
+    ThreadSpecificData *tsdPtr;
+    Tcl_Time start;
+
+    if (numDrawing == 0) {
+	TkPathFree(context);
+	return;
+    }
+    tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    if (tsdPtr->drawingPtr == NULL) {
+	TkPathFree(context);
+	return;
+    }
+    Tcl_GetTime(&start);
+    TkPathFree(context);
+
+    /*
+     * Only the time counts; the call was counted by TkPathTimedInit.
+     */
+    TkPathStatsAddTime(&tsdPtr->drawingPtr->context, &start);
+    tsdPtr->drawingPtr->context.count--;
+}
+
+/*----------------------------------------------------------------------*/
+
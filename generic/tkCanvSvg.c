@@ -0,0 +1,774 @@
+/*
+ * tkCanvSvg.c --
+ *
+ *	This module implements the "svg" widget command that writes the
+ *	path items of a canvas as an SVG document to a channel. The items
+ *	are visited by their displayProcs with a special drawable, and the
+ *	drawing helpers then hand their paths, text and images over to the
+ *	writer here instead of drawing them. Each element is written as
+ *	soon as it is made so the memory used does not grow with the
+ *	number of items. Named styles and gradients are written once, as
+ *	CSS classes and gradient definitions, the first time an item uses
+ *	them.
+ *
+ * Copyright (c) 2026  tkpath contributors
+ *
+ * $Id$
+ */
+
+#include "tkIntPath.h"
+#include "tkpCanvas.h"
+#include "tkCanvPathUtil.h"
+
+/*
+ * Tk 8.6 made the image type of Tk_GetImageMasterData const.
+ */
+
+#ifndef CONST86
+#   define CONST86
+#endif
+
+/*
+ * The state of an export in progress.
+ */
+
+typedef struct SvgWriter {
+    Tcl_Interp *interp;
+    Tcl_Channel chan;
+    Tk_PathItem *itemPtr;	/* The item being displayed. */
+    Tcl_HashTable gradients;	/* TkPathGradientMaster* -> number. */
+    Tcl_HashTable styles;	/* Tk_PathStyle* of named styles -> number. */
+    Tcl_DString ds;		/* Buffer for the element being made. */
+    Tcl_Obj *errorObj;		/* First error met, or NULL. Nothing more
+				 * is written after it. */
+} SvgWriter;
+
+typedef struct ThreadSpecificData {
+    SvgWriter *writerPtr;	/* Non-NULL while exporting. */
+} ThreadSpecificData;
+
+static Tcl_ThreadDataKey dataKey;
+
+static void	SvgAppend(Tcl_DString *dsPtr, CONST char *format, ...);
+static void	SvgAppendColor(Tcl_DString *dsPtr, CONST char *name,
+		    XColor *colorPtr);
+static void	SvgAppendEscaped(Tcl_DString *dsPtr, CONST char *string);
+static void	SvgAppendStyle(SvgWriter *writerPtr, Tcl_DString *dsPtr,
+		    Tk_PathStyle *stylePtr, int skipMask, int css);
+static void	SvgAppendTMatrix(Tcl_DString *dsPtr, CONST char *name,
+		    TMatrix *mPtr);
+static void	SvgFlush(SvgWriter *writerPtr);
+static int	SvgGradientNumber(SvgWriter *writerPtr,
+		    TkPathGradientMaster *gradientPtr);
+static int	SvgItemClass(SvgWriter *writerPtr, int *maskPtr);
+static SvgWriter *SvgGetWriter(void);
+static void	SvgWrite(SvgWriter *writerPtr, Tcl_DString *dsPtr);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkCanvSvgCmd --
+ *
+ *	This function is invoked to process the "svg" options of the widget
+ *	command for canvas widgets. See the user documentation for details
+ *	on what it does.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	The SVG document is written to the channel.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkCanvSvgCmd(
+    TkPathCanvas *canvasPtr,	/* Information about canvas widget. */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    int objc,			/* Number of arguments. */
+    Tcl_Obj *CONST objv[])	/* Argument objects. */
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    SvgWriter writer;
+    Tk_PathItem *itemPtr;
+    Tcl_Channel chan;
+    Tcl_Obj *regionObj = NULL;
+    Tcl_DString encoding;
+    int region[4], mode, width, height;
+    int result = TCL_OK;
+
+    if (objc == 5) {
+	if (strcmp(Tcl_GetString(objv[2]), "-region") != 0) {
+	    Tcl_AppendResult(interp, "bad option \"", Tcl_GetString(objv[2]),
+		    "\": must be -region", NULL);
+	    return TCL_ERROR;
+	}
+	regionObj = objv[3];
+    } else if (objc != 3) {
+	Tcl_WrongNumArgs(interp, 2, objv, "?-region {x1 y1 x2 y2}? channelId");
+	return TCL_ERROR;
+    }
+    chan = Tcl_GetChannel(interp, Tcl_GetString(objv[objc-1]), &mode);
+    if (chan == NULL) {
+	return TCL_ERROR;
+    }
+    if (!(mode & TCL_WRITABLE)) {
+	Tcl_AppendResult(interp, "channel \"", Tcl_GetString(objv[objc-1]),
+		"\" wasn't opened for writing", NULL);
+	return TCL_ERROR;
+    }
+    if (TkPathCanvasGetRegion(interp, canvasPtr, regionObj, region)
+	    != TCL_OK) {
+	return TCL_ERROR;
+    }
+    if (tsdPtr->writerPtr != NULL) {
+	Tcl_AppendResult(interp, "an svg export is already in progress", NULL);
+	return TCL_ERROR;
+    }
+    width = region[2] - region[0];
+    height = region[3] - region[1];
+
+    /*
+     * The document says it is UTF-8, so write it so whatever the channel
+     * was set up with, and put that back afterwards.
+     */
+
+    Tcl_DStringInit(&encoding);
+    if (Tcl_GetChannelOption(interp, chan, "-encoding", &encoding) != TCL_OK) {
+	Tcl_DStringFree(&encoding);
+	return TCL_ERROR;
+    }
+    if (Tcl_SetChannelOption(interp, chan, "-encoding", "utf-8") != TCL_OK) {
+	Tcl_DStringFree(&encoding);
+	return TCL_ERROR;
+    }
+
+    writer.interp = interp;
+    writer.chan = chan;
+    writer.itemPtr = NULL;
+    Tcl_InitHashTable(&writer.gradients, TCL_ONE_WORD_KEYS);
+    Tcl_InitHashTable(&writer.styles, TCL_ONE_WORD_KEYS);
+    Tcl_DStringInit(&writer.ds);
+    writer.errorObj = NULL;
+    tsdPtr->writerPtr = &writer;
+
+    SvgAppend(&writer.ds, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	    "<svg xmlns=\"http://www.w3.org/2000/svg\" "
+	    "xmlns:xlink=\"http://www.w3.org/1999/xlink\" version=\"1.1\"\n"
+	    "  width=\"%d\" height=\"%d\" viewBox=\"%d %d %d %d\">\n",
+	    width, height, region[0], region[1], width, height);
+    SvgFlush(&writer);
+
+    /*
+     * The items are visited in the same order as they are displayed, and
+     * only those that are visible and inside the region are written.
+     */
+
+    for (itemPtr = canvasPtr->rootItemPtr;
+	    (itemPtr != NULL) && (writer.errorObj == NULL);
+	    itemPtr = TkPathCanvasItemIteratorNext(itemPtr)) {
+	if ((itemPtr->typePtr == &tkGroupType) || !TkPathCanvasIsPathItem(itemPtr)) {
+	    continue;
+	}
+	if ((itemPtr->x1 >= region[2]) || (itemPtr->y1 >= region[3])
+		|| (itemPtr->x2 < region[0]) || (itemPtr->y2 < region[1])) {
+	    continue;
+	}
+	if (itemPtr->state == TK_PATHSTATE_HIDDEN ||
+	    (itemPtr->state == TK_PATHSTATE_NULL &&
+	     canvasPtr->canvas_state == TK_PATHSTATE_HIDDEN)) {
+	    continue;
+	}
+	writer.itemPtr = itemPtr;
+	(*itemPtr->typePtr->displayProc)((Tk_PathCanvas) canvasPtr, itemPtr,
+		canvasPtr->display, TK_PATH_SVG_DRAWABLE, region[0], region[1],
+		width, height);
+    }
+    SvgAppend(&writer.ds, "</svg>\n");
+    SvgFlush(&writer);
+
+    tsdPtr->writerPtr = NULL;
+    Tcl_DeleteHashTable(&writer.gradients);
+    Tcl_DeleteHashTable(&writer.styles);
+    Tcl_DStringFree(&writer.ds);
+    if (writer.errorObj != NULL) {
+	Tcl_SetObjResult(interp, writer.errorObj);
+	Tcl_DecrRefCount(writer.errorObj);
+	result = TCL_ERROR;
+    } else if (Tcl_Flush(chan) != TCL_OK) {
+	Tcl_AppendResult(interp, "error writing \"",
+		Tcl_GetChannelName(chan), "\": ", Tcl_PosixError(interp), NULL);
+	result = TCL_ERROR;
+    }
+    Tcl_SetChannelOption(NULL, chan, "-encoding",
+	    Tcl_DStringValue(&encoding));
+    Tcl_DStringFree(&encoding);
+    return result;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathSvgPath, TkPathSvgText, TkPathSvgImage --
+ *
+ *	Called by the drawing code instead of drawing when the drawable is
+ *	TK_PATH_SVG_DRAWABLE. The style is the one the item is drawn with;
+ *	options that its named style sets are left to the CSS class.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	An element is written to the channel.
+ *
+ *--------------------------------------------------------------
+ */
+
+void
+TkPathSvgPath(
+    PathAtom *atomPtr,
+    Tk_PathStyle *stylePtr)
+{
+    SvgWriter *writerPtr = SvgGetWriter();
+    Tcl_DString *dsPtr;
+    int number, mask;
+
+    if (writerPtr == NULL) {
+	return;
+    }
+    number = SvgItemClass(writerPtr, &mask);
+    dsPtr = &writerPtr->ds;
+    Tcl_DStringAppend(dsPtr, "<path d=\"", -1);
+    for (; atomPtr != NULL; atomPtr = atomPtr->nextPtr) {
+	switch (atomPtr->type) {
+	    case PATH_ATOM_M: {
+		MoveToAtom *move = (MoveToAtom *) atomPtr;
+		SvgAppend(dsPtr, "M%g %g ", move->x, move->y);
+		break;
+	    }
+	    case PATH_ATOM_L: {
+		LineToAtom *line = (LineToAtom *) atomPtr;
+		SvgAppend(dsPtr, "L%g %g ", line->x, line->y);
+		break;
+	    }
+	    case PATH_ATOM_A: {
+		ArcAtom *arc = (ArcAtom *) atomPtr;
+		SvgAppend(dsPtr, "A%g %g %g %d %d %g %g ", arc->radX,
+			arc->radY, arc->angle, arc->largeArcFlag ? 1 : 0,
+			arc->sweepFlag ? 1 : 0, arc->x, arc->y);
+		break;
+	    }
+	    case PATH_ATOM_Q: {
+		QuadBezierAtom *quad = (QuadBezierAtom *) atomPtr;
+		SvgAppend(dsPtr, "Q%g %g %g %g ", quad->ctrlX, quad->ctrlY,
+			quad->anchorX, quad->anchorY);
+		break;
+	    }
+	    case PATH_ATOM_C: {
+		CurveToAtom *curve = (CurveToAtom *) atomPtr;
+		SvgAppend(dsPtr, "C%g %g %g %g %g %g ", curve->ctrlX1,
+			curve->ctrlY1, curve->ctrlX2, curve->ctrlY2,
+			curve->anchorX, curve->anchorY);
+		break;
+	    }
+	    case PATH_ATOM_Z: {
+		Tcl_DStringAppend(dsPtr, "Z ", -1);
+		break;
+	    }
+	    case PATH_ATOM_ELLIPSE: {
+		EllipseAtom *ell = (EllipseAtom *) atomPtr;
+		SvgAppend(dsPtr, "M%g %g A%g %g 0 1 1 %g %g A%g %g 0 1 1 %g %g Z ",
+			ell->cx + ell->rx, ell->cy, ell->rx, ell->ry,
+			ell->cx - ell->rx, ell->cy, ell->rx, ell->ry,
+			ell->cx + ell->rx, ell->cy);
+		break;
+	    }
+	    case PATH_ATOM_RECT: {
+		RectAtom *rect = (RectAtom *) atomPtr;
+		SvgAppend(dsPtr, "M%g %g h%g v%g h%g Z ", rect->x, rect->y,
+			rect->width, rect->height, -rect->width);
+		break;
+	    }
+	}
+    }
+    Tcl_DStringAppend(dsPtr, "\"", -1);
+    if (number > 0) {
+	SvgAppend(dsPtr, " class=\"s%d\"", number);
+    }
+    SvgAppendStyle(writerPtr, dsPtr, stylePtr, mask, 0);
+    SvgAppendTMatrix(dsPtr, "transform", stylePtr->matrixPtr);
+    Tcl_DStringAppend(dsPtr, "/>\n", -1);
+    SvgFlush(writerPtr);
+}
+
+void
+TkPathSvgText(
+    Tk_PathStyle *stylePtr,
+    Tk_PathTextStyle *textStylePtr,
+    double x, double y,
+    CONST char *utf8)
+{
+    SvgWriter *writerPtr = SvgGetWriter();
+    Tcl_DString *dsPtr;
+    int number, mask;
+
+    if (writerPtr == NULL) {
+	return;
+    }
+    number = SvgItemClass(writerPtr, &mask);
+    dsPtr = &writerPtr->ds;
+    SvgAppend(dsPtr, "<text x=\"%g\" y=\"%g\"", x, y);
+    if (number > 0) {
+	SvgAppend(dsPtr, " class=\"s%d\"", number);
+    }
+    SvgAppendStyle(writerPtr, dsPtr, stylePtr, mask, 0);
+    SvgAppendTMatrix(dsPtr, "transform", stylePtr->matrixPtr);
+    if (textStylePtr->fontFamily != NULL) {
+	Tcl_DStringAppend(dsPtr, " font-family=\"", -1);
+	SvgAppendEscaped(dsPtr, textStylePtr->fontFamily);
+	Tcl_DStringAppend(dsPtr, "\"", -1);
+    }
+    SvgAppend(dsPtr, " font-size=\"%g\"", textStylePtr->fontSize);
+    if (textStylePtr->fontWeight == PATH_TEXT_WEIGHT_BOLD) {
+	Tcl_DStringAppend(dsPtr, " font-weight=\"bold\"", -1);
+    }
+    if (textStylePtr->fontSlant == PATH_TEXT_SLANT_ITALIC) {
+	Tcl_DStringAppend(dsPtr, " font-style=\"italic\"", -1);
+    }
+    Tcl_DStringAppend(dsPtr, ">", -1);
+    SvgAppendEscaped(dsPtr, utf8);
+    Tcl_DStringAppend(dsPtr, "</text>\n", -1);
+    SvgFlush(writerPtr);
+}
+
+void
+TkPathSvgImage(
+    CONST char *imageName,
+    double x, double y,
+    double width, double height,
+    double opacity,
+    TMatrix *mPtr)
+{
+    SvgWriter *writerPtr = SvgGetWriter();
+    Tcl_Interp *interp;
+    Tcl_Obj *cmdObj;
+    Tcl_DString *dsPtr;
+    CONST86 Tk_ImageType *typePtr = NULL;
+    int code;
+
+    if ((writerPtr == NULL) || (writerPtr->errorObj != NULL)) {
+	return;
+    }
+    interp = writerPtr->interp;
+    dsPtr = &writerPtr->ds;
+
+    /*
+     * The image is embedded as base64 png, which only photo images can
+     * produce; others are left out. A photo that fails to give its data
+     * ends the export with that error.
+     */
+
+    Tk_GetImageMasterData(interp, imageName, &typePtr);
+    if ((typePtr == NULL) || (strcmp(typePtr->name, "photo") != 0)) {
+	return;
+    }
+    cmdObj = Tcl_NewListObj(0, NULL);
+    Tcl_IncrRefCount(cmdObj);
+    Tcl_ListObjAppendElement(NULL, cmdObj, Tcl_NewStringObj(imageName, -1));
+    Tcl_ListObjAppendElement(NULL, cmdObj, Tcl_NewStringObj("data", -1));
+    Tcl_ListObjAppendElement(NULL, cmdObj, Tcl_NewStringObj("-format", -1));
+    Tcl_ListObjAppendElement(NULL, cmdObj, Tcl_NewStringObj("png", -1));
+    code = Tcl_EvalObjEx(interp, cmdObj, TCL_EVAL_DIRECT);
+    Tcl_DecrRefCount(cmdObj);
+    if (code == TCL_OK) {
+	SvgAppend(dsPtr, "<image x=\"%g\" y=\"%g\" width=\"%g\" height=\"%g\"",
+		x, y, width, height);
+	if (opacity < 1.0) {
+	    SvgAppend(dsPtr, " opacity=\"%g\"", opacity);
+	}
+	SvgAppendTMatrix(dsPtr, "transform", mPtr);
+	Tcl_DStringAppend(dsPtr,
+		" preserveAspectRatio=\"none\" xlink:href=\"data:image/png;base64,",
+		-1);
+	Tcl_DStringAppend(dsPtr, Tcl_GetStringResult(interp), -1);
+	Tcl_DStringAppend(dsPtr, "\"/>\n", -1);
+	SvgFlush(writerPtr);
+    } else {
+	writerPtr->errorObj = Tcl_GetObjResult(interp);
+	Tcl_IncrRefCount(writerPtr->errorObj);
+    }
+    Tcl_ResetResult(interp);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgItemClass --
+ *
+ *	Finds the named style of the item being written and writes its
+ *	CSS class the first time it is seen.
+ *
+ * Results:
+ *	The class number or 0 if the item has no named style. The options
+ *	that the class sets are left in maskPtr.
+ *
+ * Side effects:
+ *	May write a style element.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+SvgItemClass(
+    SvgWriter *writerPtr,
+    int *maskPtr)
+{
+    Tk_PathItem *itemPtr = writerPtr->itemPtr;
+    TkPathStyleInst *styleInst = NULL;
+    Tk_PathStyle *masterPtr;
+    Tcl_HashEntry *hPtr;
+    Tcl_DString *dsPtr = &writerPtr->ds;
+    Tcl_DString ds;
+    int isNew, number;
+
+    *maskPtr = 0;
+    if (itemPtr == NULL) {
+	return 0;
+    }
+    if (TkPathItemIsLight(itemPtr)) {
+	styleInst = ((Tk_PathItemLight *) itemPtr)->styleInst;
+    } else if (itemPtr->typePtr != &tkPimageType) {
+	styleInst = ((Tk_PathItemEx *) itemPtr)->styleInst;
+    }
+    if (styleInst == NULL) {
+	return 0;
+    }
+    masterPtr = styleInst->masterPtr;
+    *maskPtr = masterPtr->mask & ~PATH_STYLE_OPTION_MATRIX;
+    hPtr = Tcl_CreateHashEntry(&writerPtr->styles, (char *) masterPtr,
+	    &isNew);
+    if (!isNew) {
+	return (int) (long) Tcl_GetHashValue(hPtr);
+    }
+    number = writerPtr->styles.numEntries;
+    Tcl_SetHashValue(hPtr, (ClientData) (long) number);
+
+    /*
+     * Any gradient of the style must be written out before we start on
+     * the style element, so make the rules in a buffer of their own.
+     */
+
+    Tcl_DStringInit(&ds);
+    SvgAppendStyle(writerPtr, &ds, masterPtr, ~masterPtr->mask, 1);
+    SvgAppend(dsPtr, "<style type=\"text/css\">.s%d {", number);
+    Tcl_DStringAppend(dsPtr, Tcl_DStringValue(&ds), Tcl_DStringLength(&ds));
+    Tcl_DStringAppend(dsPtr, " }</style>\n", -1);
+    Tcl_DStringFree(&ds);
+    SvgFlush(writerPtr);
+    return number;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgGradientNumber --
+ *
+ *	Writes the definition of a gradient the first time it is used.
+ *
+ * Results:
+ *	The number that its id is made from.
+ *
+ * Side effects:
+ *	May write a defs element.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+SvgGradientNumber(
+    SvgWriter *writerPtr,
+    TkPathGradientMaster *gradientPtr)
+{
+    static CONST char *methods[] = {"pad", "repeat", "reflect"};
+    Tcl_HashEntry *hPtr;
+    Tcl_DString ds;
+    GradientStopArray *stopArrPtr;
+    CONST char *units;
+    int isNew, number, method, i;
+
+    hPtr = Tcl_CreateHashEntry(&writerPtr->gradients, (char *) gradientPtr,
+	    &isNew);
+    if (!isNew) {
+	return (int) (long) Tcl_GetHashValue(hPtr);
+    }
+    number = writerPtr->gradients.numEntries;
+    Tcl_SetHashValue(hPtr, (ClientData) (long) number);
+
+    /*
+     * We may be in the middle of an element, so use a buffer of our own
+     * and write it out directly.
+     */
+
+    Tcl_DStringInit(&ds);
+    if (gradientPtr->type == kPathGradientTypeLinear) {
+	LinearGradientFill *fillPtr = &gradientPtr->linearFill;
+	PathRect *tPtr = fillPtr->transitionPtr;
+
+	method = fillPtr->method;
+	units = (fillPtr->units == kPathGradientUnitsUserSpace) ?
+		"userSpaceOnUse" : "objectBoundingBox";
+	stopArrPtr = fillPtr->stopArrPtr;
+	SvgAppend(&ds, "<defs><linearGradient id=\"g%d\" "
+		"x1=\"%g\" y1=\"%g\" x2=\"%g\" y2=\"%g\"", number,
+		tPtr->x1, tPtr->y1, tPtr->x2, tPtr->y2);
+    } else {
+	RadialGradientFill *fillPtr = &gradientPtr->radialFill;
+	RadialTransition *tPtr = fillPtr->radialPtr;
+
+	method = fillPtr->method;
+	units = (fillPtr->units == kPathGradientUnitsUserSpace) ?
+		"userSpaceOnUse" : "objectBoundingBox";
+	stopArrPtr = fillPtr->stopArrPtr;
+	SvgAppend(&ds, "<defs><radialGradient id=\"g%d\" "
+		"cx=\"%g\" cy=\"%g\" r=\"%g\" fx=\"%g\" fy=\"%g\"", number,
+		tPtr->centerX, tPtr->centerY, tPtr->radius,
+		tPtr->focalX, tPtr->focalY);
+    }
+    if ((method < 0) || (method > kPathGradientMethodReflect)) {
+	method = kPathGradientMethodPad;
+    }
+    SvgAppend(&ds, " gradientUnits=\"%s\" spreadMethod=\"%s\"", units,
+	    methods[method]);
+    SvgAppendTMatrix(&ds, "gradientTransform", gradientPtr->matrixPtr);
+    Tcl_DStringAppend(&ds, ">\n", -1);
+    if (stopArrPtr != NULL) {
+	for (i = 0; i < stopArrPtr->nstops; i++) {
+	    GradientStop *stopPtr = stopArrPtr->stops[i];
+
+	    SvgAppend(&ds, "  <stop offset=\"%g\"", stopPtr->offset);
+	    SvgAppendColor(&ds, "stop-color", stopPtr->color);
+	    SvgAppend(&ds, " stop-opacity=\"%g\"/>\n", stopPtr->opacity);
+	}
+    }
+    Tcl_DStringAppend(&ds, (gradientPtr->type == kPathGradientTypeLinear) ?
+	    "</linearGradient></defs>\n" : "</radialGradient></defs>\n", -1);
+    SvgWrite(writerPtr, &ds);
+    Tcl_DStringFree(&ds);
+    return number;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SvgAppendStyle --
+ *
+ *	Appends the style as attributes, or as CSS declarations if css is
+ *	set. Options whose bits are in skipMask are left out.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	May write gradient definitions.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+SvgAppendStyle(
+    SvgWriter *writerPtr,
+    Tcl_DString *dsPtr,
+    Tk_PathStyle *stylePtr,
+    int skipMask,
+    int css)
+{
+    static CONST char *caps[] = {"butt", "butt", "round", "square"};
+    static CONST char *joins[] = {"miter", "round", "bevel"};
+    CONST char *format = css ? " %s: %s;" : " %s=\"%s\"";
+    TkPathGradientMaster *gradientPtr;
+    XColor *colorPtr;
+    char buf[64];
+    int i;
+
+    if (!(skipMask & PATH_STYLE_OPTION_FILL)) {
+	gradientPtr = GetGradientMasterFromPathColor(stylePtr->fill);
+	colorPtr = GetColorFromPathColor(stylePtr->fill);
+	if (gradientPtr != NULL) {
+	    sprintf(buf, "url(#g%d)", SvgGradientNumber(writerPtr, gradientPtr));
+	    SvgAppend(dsPtr, format, "fill", buf);
+	} else if (colorPtr != NULL) {
+	    sprintf(buf, "#%02x%02x%02x", colorPtr->red >> 8,
+		    colorPtr->green >> 8, colorPtr->blue >> 8);
+	    SvgAppend(dsPtr, format, "fill", buf);
+	} else {
+	    SvgAppend(dsPtr, format, "fill", "none");
+	}
+    }
+    if (!(skipMask & PATH_STYLE_OPTION_FILL_OPACITY)
+	    && (stylePtr->fillOpacity < 1.0)) {
+	sprintf(buf, "%g", stylePtr->fillOpacity);
+	SvgAppend(dsPtr, format, "fill-opacity", buf);
+    }
+    if (!(skipMask & PATH_STYLE_OPTION_FILL_RULE)
+	    && (stylePtr->fillRule == EvenOddRule)) {
+	SvgAppend(dsPtr, format, "fill-rule", "evenodd");
+    }
+    if (!(skipMask & PATH_STYLE_OPTION_STROKE)) {
+	colorPtr = stylePtr->strokeColor;
+	if (colorPtr != NULL) {
+	    sprintf(buf, "#%02x%02x%02x", colorPtr->red >> 8,
+		    colorPtr->green >> 8, colorPtr->blue >> 8);
+	    SvgAppend(dsPtr, format, "stroke", buf);
+	} else {
+	    SvgAppend(dsPtr, format, "stroke", "none");
+	}
+    }
+    if (stylePtr->strokeColor == NULL) {
+	return;
+    }
+    if (!(skipMask & PATH_STYLE_OPTION_STROKE_WIDTH)) {
+	sprintf(buf, "%g", stylePtr->strokeWidth);
+	SvgAppend(dsPtr, format, "stroke-width", buf);
+    }
+    if (!(skipMask & PATH_STYLE_OPTION_STROKE_OPACITY)
+	    && (stylePtr->strokeOpacity < 1.0)) {
+	sprintf(buf, "%g", stylePtr->strokeOpacity);
+	SvgAppend(dsPtr, format, "stroke-opacity", buf);
+    }
+    if (!(skipMask & PATH_STYLE_OPTION_STROKE_LINECAP)
+	    && (stylePtr->capStyle >= CapNotLast)
+	    && (stylePtr->capStyle <= CapProjecting)) {
+	SvgAppend(dsPtr, format, "stroke-linecap", caps[stylePtr->capStyle]);
+    }
+    if (!(skipMask & PATH_STYLE_OPTION_STROKE_LINEJOIN)
+	    && (stylePtr->joinStyle >= JoinMiter)
+	    && (stylePtr->joinStyle <= JoinBevel)) {
+	SvgAppend(dsPtr, format, "stroke-linejoin",
+		joins[stylePtr->joinStyle]);
+    }
+    if (!(skipMask & PATH_STYLE_OPTION_STROKE_MITERLIMIT)
+	    && (stylePtr->joinStyle == JoinMiter)) {
+	sprintf(buf, "%g", stylePtr->miterLimit);
+	SvgAppend(dsPtr, format, "stroke-miterlimit", buf);
+    }
+    if (!(skipMask & PATH_STYLE_OPTION_STROKE_DASHARRAY)
+	    && (stylePtr->dashPtr != NULL) && (stylePtr->dashPtr->number > 0)) {
+	Tcl_DStringAppend(dsPtr, css ? " stroke-dasharray:" :
+		" stroke-dasharray=\"", -1);
+	for (i = 0; i < stylePtr->dashPtr->number; i++) {
+	    SvgAppend(dsPtr, (i == 0) ? "%g" : ",%g",
+		    stylePtr->dashPtr->array[i] * stylePtr->strokeWidth);
+	}
+	Tcl_DStringAppend(dsPtr, css ? ";" : "\"", -1);
+    }
+}
+
+static void
+SvgAppendTMatrix(
+    Tcl_DString *dsPtr,
+    CONST char *name,
+    TMatrix *mPtr)
+{
+    if (mPtr != NULL) {
+	SvgAppend(dsPtr, " %s=\"matrix(%g %g %g %g %g %g)\"", name,
+		mPtr->a, mPtr->b, mPtr->c, mPtr->d, mPtr->tx, mPtr->ty);
+    }
+}
+
+static void
+SvgAppendColor(
+    Tcl_DString *dsPtr,
+    CONST char *name,
+    XColor *colorPtr)
+{
+    if (colorPtr != NULL) {
+	SvgAppend(dsPtr, " %s=\"#%02x%02x%02x\"", name, colorPtr->red >> 8,
+		colorPtr->green >> 8, colorPtr->blue >> 8);
+    }
+}
+
+/*
+ * Appends a string as XML character data or attribute value.
+ */
+
+static void
+SvgAppendEscaped(
+    Tcl_DString *dsPtr,
+    CONST char *string)
+{
+    CONST char *p;
+
+    for (p = string; *p != '\0'; p++) {
+	switch (*p) {
+	    case '<': Tcl_DStringAppend(dsPtr, "&lt;", -1); break;
+	    case '>': Tcl_DStringAppend(dsPtr, "&gt;", -1); break;
+	    case '&': Tcl_DStringAppend(dsPtr, "&amp;", -1); break;
+	    case '"': Tcl_DStringAppend(dsPtr, "&quot;", -1); break;
+	    default: Tcl_DStringAppend(dsPtr, p, 1); break;
+	}
+    }
+}
+
+/*
+ * Formats into the buffer. All our formats have short output; names of
+ * unknown length are appended directly instead.
+ */
+
+static void
+SvgAppend(
+    Tcl_DString *dsPtr,
+    CONST char *format,
+    ...)
+{
+    va_list args;
+    char buf[512];
+
+    va_start(args, format);
+    vsprintf(buf, format, args);
+    va_end(args);
+    Tcl_DStringAppend(dsPtr, buf, -1);
+}
+
+/*
+ * Writes the element buffer, or another buffer, to the channel. The
+ * first write error is kept and ends the export.
+ */
+
+static void
+SvgFlush(
+    SvgWriter *writerPtr)
+{
+    SvgWrite(writerPtr, &writerPtr->ds);
+    Tcl_DStringSetLength(&writerPtr->ds, 0);
+}
+
+static void
+SvgWrite(
+    SvgWriter *writerPtr,
+    Tcl_DString *dsPtr)
+{
+    if (writerPtr->errorObj != NULL) {
+	return;
+    }
+    if (Tcl_WriteChars(writerPtr->chan, Tcl_DStringValue(dsPtr),
+	    Tcl_DStringLength(dsPtr)) < 0) {
+	writerPtr->errorObj = Tcl_NewStringObj("error writing \"", -1);
+	Tcl_AppendStringsToObj(writerPtr->errorObj,
+		Tcl_GetChannelName(writerPtr->chan), "\": ",
+		Tcl_ErrnoMsg(Tcl_GetErrno()), NULL);
+	Tcl_IncrRefCount(writerPtr->errorObj);
+    }
+}
+
+static SvgWriter *
+SvgGetWriter(void)
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    return tsdPtr->writerPtr;
+}
+
+/*----------------------------------------------------------------------*/
@@ -0,0 +1,696 @@
+/*
+ * tkCanvUse.c --
+ *
+ *	This file implements the "symbol" widget command that defines
+ *	named path geometry once per canvas, and the use canvas item,
+ *	modelled after its SVG counterpart, that draws a symbol at a
+ *	point with its own matrix and style. The atoms, their bare
+ *	bounding box and the polygons used for hit testing are made
+ *	once per symbol and shared by all of its use items, so
+ *	thousands of markers cost little more than one.
+ *
+ * Copyright (c) 2026  tkpath contributors
+ *
+ * $Id$
+ */
+
+#include "tkIntPath.h"
+#include "tkpCanvas.h"
+#include "tkCanvPathUtil.h"
+#include "tkPathStyle.h"
+
+/*
+ * The structure below defines the record for each use item.
+ */
+
+typedef struct UseItem  {
+    Tk_PathItemEx headerEx; /* Generic stuff that's the same for all
+                             * path types.  MUST BE FIRST IN STRUCTURE. */
+    double point[2];	    /* Where the symbol origin is drawn. */
+    Tcl_Obj *symbolObj;	    /* Name of the symbol. */
+    TkPathSymbol *symbolPtr;/* The symbol, or NULL if not set. */
+} UseItem;
+
+/*
+ * Prototypes for procedures defined in this file:
+ */
+
+static void	ComputeUseBbox(Tk_PathCanvas canvas, UseItem *usePtr);
+static int	ConfigureUse(Tcl_Interp *interp, Tk_PathCanvas canvas,
+                        Tk_PathItem *itemPtr, int objc,
+                        Tcl_Obj *CONST objv[], int flags);
+static int	CreateUse(Tcl_Interp *interp,
+                        Tk_PathCanvas canvas, struct Tk_PathItem *itemPtr,
+                        int objc, Tcl_Obj *CONST objv[]);
+static void	DeleteUse(Tk_PathCanvas canvas,
+                        Tk_PathItem *itemPtr, Display *display);
+static void	DisplayUse(Tk_PathCanvas canvas,
+                        Tk_PathItem *itemPtr, Display *display, Drawable drawable,
+                        int x, int y, int width, int height);
+static void	UseBbox(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int mask);
+static int	UseCoords(Tcl_Interp *interp,
+                        Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+                        int objc, Tcl_Obj *CONST objv[]);
+static int	UseToArea(Tk_PathCanvas canvas,
+                        Tk_PathItem *itemPtr, double *rectPtr);
+static double	UseToPoint(Tk_PathCanvas canvas,
+                        Tk_PathItem *itemPtr, double *coordPtr);
+static int	UseToPostscript(Tcl_Interp *interp,
+                        Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int prepass);
+static void	ScaleUse(Tk_PathCanvas canvas,
+                        Tk_PathItem *itemPtr, double originX, double originY,
+                        double scaleX, double scaleY);
+static void	TranslateUse(Tk_PathCanvas canvas,
+                        Tk_PathItem *itemPtr, double deltaX, double deltaY);
+static Tk_PathStyle UseInheritStyle(UseItem *usePtr, long flags);
+static void	SymbolRelease(TkPathSymbol *symbolPtr);
+static PathPolys * SymbolPolys(TkPathSymbol *symbolPtr);
+
+
+enum {
+    USE_OPTION_INDEX_SYMBOL = (1L << (PATH_STYLE_OPTION_INDEX_END + 0))
+};
+
+PATH_STYLE_CUSTOM_OPTION_RECORDS
+PATH_CUSTOM_OPTION_TAGS
+PATH_OPTION_STRING_TABLES_FILL
+PATH_OPTION_STRING_TABLES_STROKE
+PATH_OPTION_STRING_TABLES_STATE
+
+#define PATH_OPTION_SPEC_SYMBOL(typeName)		    \
+    {TK_OPTION_STRING, "-symbol", NULL, NULL,		    \
+        "", Tk_Offset(typeName, symbolObj), -1,		    \
+	TK_OPTION_NULL_OK, 0, USE_OPTION_INDEX_SYMBOL}
+
+static Tk_OptionSpec optionSpecs[] = {
+    PATH_OPTION_SPEC_CORE(Tk_PathItemEx),
+    PATH_OPTION_SPEC_PARENT,
+    PATH_OPTION_SPEC_STYLE_FILL(Tk_PathItemEx, ""),
+    PATH_OPTION_SPEC_STYLE_MATRIX(Tk_PathItemEx),
+    PATH_OPTION_SPEC_STYLE_STROKE(Tk_PathItemEx, "black"),
+    PATH_OPTION_SPEC_SYMBOL(UseItem),
+    PATH_OPTION_SPEC_END
+};
+
+static Tk_OptionTable optionTable = NULL;
+
+/*
+ * The structures below defines the 'use' item type by means
+ * of procedures that can be invoked by generic item code.
+ */
+
+Tk_PathItemType tkUseType = {
+    "use",				/* name */
+    sizeof(UseItem),			/* itemSize */
+    CreateUse,				/* createProc */
+    optionSpecs,			/* optionSpecs */
+    ConfigureUse,			/* configureProc */
+    UseCoords,				/* coordProc */
+    DeleteUse,				/* deleteProc */
+    DisplayUse,				/* displayProc */
+    0,					/* flags */
+    UseBbox,				/* bboxProc */
+    UseToPoint,				/* pointProc */
+    UseToArea,				/* areaProc */
+    UseToPostscript,			/* postscriptProc */
+    ScaleUse,				/* scaleProc */
+    TranslateUse,			/* translateProc */
+    (Tk_PathItemIndexProc *) NULL,	/* indexProc */
+    (Tk_PathItemCursorProc *) NULL,	/* icursorProc */
+    (Tk_PathItemSelectionProc *) NULL,	/* selectionProc */
+    (Tk_PathItemInsertProc *) NULL,	/* insertProc */
+    (Tk_PathItemDCharsProc *) NULL,	/* dTextProc */
+    (Tk_PathItemType *) NULL,		/* nextPtr */
+    (Tk_PathItemAppendProc *) NULL,	/* appendProc */
+};
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathCanvasSymbolCmd --
+ *
+ *	Implements
+ *	    'pathName symbol create name pathSpec'
+ *	    'pathName symbol delete name'
+ *	    'pathName symbol inuse name'
+ *	    'pathName symbol names'
+ *	A symbol can't be redefined, nor deleted while use items draw
+ *	it, so a name always stands for the geometry its items show and
+ *	save can write symbols by name.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	Symbols are created or deleted.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkPathCanvasSymbolCmd(
+    TkPathCanvas *canvasPtr,	/* Information about canvas widget. */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    int objc,			/* Number of arguments. */
+    Tcl_Obj *CONST objv[])	/* Argument objects. */
+{
+    TkPathSymbol *symbolPtr;
+    Tcl_HashEntry *hPtr;
+    Tcl_HashSearch search;
+    Tcl_Obj *listObj;
+    int index;
+    static CONST char *symbolCmds[] = {
+	"create", "delete", "inuse", "names", NULL
+    };
+    enum {
+	SYMBOL_CREATE, SYMBOL_DELETE, SYMBOL_INUSE, SYMBOL_NAMES
+    };
+
+    if (objc < 3) {
+	Tcl_WrongNumArgs(interp, 2, objv, "command ?arg arg...?");
+	return TCL_ERROR;
+    }
+    if (Tcl_GetIndexFromObj(interp, objv[2], symbolCmds, "command", 0,
+	    &index) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    switch (index) {
+    case SYMBOL_CREATE:
+	if (objc != 5) {
+	    Tcl_WrongNumArgs(interp, 3, objv, "name pathSpec");
+	    return TCL_ERROR;
+	}
+	if (TkPathCanvasSymbolCreate(interp, canvasPtr, Tcl_GetString(objv[3]),
+		objv[4]) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	Tcl_SetObjResult(interp, objv[3]);
+	break;
+    case SYMBOL_DELETE:
+    case SYMBOL_INUSE:
+	if (objc != 4) {
+	    Tcl_WrongNumArgs(interp, 3, objv, "name");
+	    return TCL_ERROR;
+	}
+	hPtr = Tcl_FindHashEntry(&canvasPtr->symbolTable,
+		Tcl_GetString(objv[3]));
+	if (hPtr == NULL) {
+	    Tcl_AppendResult(interp, "symbol \"", Tcl_GetString(objv[3]),
+		    "\" doesn't exist", NULL);
+	    return TCL_ERROR;
+	}
+	symbolPtr = (TkPathSymbol *) Tcl_GetHashValue(hPtr);
+	if (index == SYMBOL_INUSE) {
+	    Tcl_SetObjResult(interp, Tcl_NewBooleanObj(symbolPtr->refCount > 1));
+	} else if (symbolPtr->refCount > 1) {
+	    Tcl_AppendResult(interp, "symbol \"", Tcl_GetString(objv[3]),
+		    "\" is in use", NULL);
+	    return TCL_ERROR;
+	} else {
+	    Tcl_DeleteHashEntry(hPtr);
+	    SymbolRelease(symbolPtr);
+	}
+	break;
+    case SYMBOL_NAMES:
+	if (objc != 3) {
+	    Tcl_WrongNumArgs(interp, 3, objv, NULL);
+	    return TCL_ERROR;
+	}
+	listObj = Tcl_NewListObj(0, NULL);
+	for (hPtr = Tcl_FirstHashEntry(&canvasPtr->symbolTable, &search);
+		hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	    Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewStringObj(
+		    Tcl_GetHashKey(&canvasPtr->symbolTable, hPtr), -1));
+	}
+	Tcl_SetObjResult(interp, listObj);
+	break;
+    }
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathCanvasSymbolCreate --
+ *
+ *	Makes a new symbol from a path spec. Also used by the load
+ *	command.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	A symbol is added to the symbolTable of the canvas.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkPathCanvasSymbolCreate(
+    Tcl_Interp *interp,
+    TkPathCanvas *canvasPtr,
+    CONST char *name,
+    Tcl_Obj *pathObj)
+{
+    TkPathSymbol *symbolPtr;
+    Tcl_HashEntry *hPtr;
+    PathAtom *atomPtr;
+    int len, isNew;
+
+    if (Tcl_FindHashEntry(&canvasPtr->symbolTable, name) != NULL) {
+	Tcl_AppendResult(interp, "symbol \"", name, "\" already exists",
+		NULL);
+	return TCL_ERROR;
+    }
+    if (TkPathParseToAtoms(interp, pathObj, &atomPtr, &len) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    symbolPtr = (TkPathSymbol *) ckalloc(sizeof(TkPathSymbol));
+    symbolPtr->pathObj = pathObj;
+    Tcl_IncrRefCount(symbolPtr->pathObj);
+    symbolPtr->atomPtr = atomPtr;
+    symbolPtr->pathLen = len;
+    symbolPtr->maxNumSegments = GetSubpathMaxNumSegments(atomPtr);
+    symbolPtr->bbox = GetGenericBarePathBbox(atomPtr);
+    symbolPtr->polysPtr = NULL;
+    symbolPtr->refCount = 1;
+    hPtr = Tcl_CreateHashEntry(&canvasPtr->symbolTable, name, &isNew);
+    Tcl_SetHashValue(hPtr, symbolPtr);
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathCanvasSymbolsFree --
+ *
+ *	Drops the names of all symbols of a canvas. Called when the
+ *	canvas is destroyed, after its items.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Memory freed.
+ *
+ *--------------------------------------------------------------
+ */
+
+void
+TkPathCanvasSymbolsFree(
+    TkPathCanvas *canvasPtr)
+{
+    Tcl_HashEntry *hPtr;
+    Tcl_HashSearch search;
+
+    for (hPtr = Tcl_FirstHashEntry(&canvasPtr->symbolTable, &search);
+	    hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	SymbolRelease((TkPathSymbol *) Tcl_GetHashValue(hPtr));
+    }
+}
+
+static void
+SymbolRelease(
+    TkPathSymbol *symbolPtr)
+{
+    if (--symbolPtr->refCount > 0) {
+	return;
+    }
+    Tcl_DecrRefCount(symbolPtr->pathObj);
+    TkPathFreeAtoms(symbolPtr->atomPtr);
+    if (symbolPtr->polysPtr != NULL) {
+	PathPolysFree(symbolPtr->polysPtr);
+    }
+    ckfree((char *) symbolPtr);
+}
+
+/*
+ * The polygons are made by the first hit test of any of the symbol's
+ * items, in symbol coordinates, and each item transforms them by its
+ * own matrix.
+ */
+
+static PathPolys *
+SymbolPolys(
+    TkPathSymbol *symbolPtr)
+{
+    if (symbolPtr->polysPtr == NULL) {
+	symbolPtr->polysPtr = PathPolysMake(symbolPtr->atomPtr,
+		symbolPtr->maxNumSegments);
+    }
+    return symbolPtr->polysPtr;
+}
+
+/*
+ +++ This starts the canvas item part +++
+ */
+
+static int
+CreateUse(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+        int objc, Tcl_Obj *CONST objv[])
+{
+    UseItem *usePtr = (UseItem *) itemPtr;
+    Tk_PathItemEx *itemExPtr = &usePtr->headerEx;
+    int	i;
+
+    if (objc == 0) {
+        Tcl_Panic("canvas did not pass any coords\n");
+    }
+
+    /*
+     * Carry out initialization that is needed to set defaults and to
+     * allow proper cleanup after errors during the the remainder of
+     * this procedure.
+     */
+    TkPathInitStyle(&itemExPtr->style);
+    itemExPtr->canvas = canvas;
+    itemExPtr->styleObj = NULL;
+    itemExPtr->styleInst = NULL;
+    itemPtr->bbox = NewEmptyPathRect();
+    itemPtr->totalBbox = NewEmptyPathRect();
+    usePtr->point[0] = usePtr->point[1] = 0.0;
+    usePtr->symbolObj = NULL;
+    usePtr->symbolPtr = NULL;
+
+    if (optionTable == NULL) {
+	optionTable = Tk_CreateOptionTable(interp, optionSpecs);
+    }
+    itemPtr->optionTable = optionTable;
+    if (Tk_InitOptions(interp, (char *) usePtr, optionTable,
+	    Tk_PathCanvasTkwin(canvas)) != TCL_OK) {
+        goto error;
+    }
+    for (i = 1; i < objc; i++) {
+        char *arg = Tcl_GetString(objv[i]);
+        if ((arg[0] == '-') && (arg[1] >= 'a') && (arg[1] <= 'z')) {
+            break;
+        }
+    }
+    if (CoordsForPointItems(interp, canvas, usePtr->point, i, objv) != TCL_OK) {
+        goto error;
+    }
+    if (ConfigureUse(interp, canvas, itemPtr, objc-i, objv+i, 0) == TCL_OK) {
+        return TCL_OK;
+    }
+
+    error:
+    /*
+     * NB: We must unlink the item here since the TkPathCanvasItemExConfigure()
+     *     link it to the root by default.
+     */
+    TkPathCanvasItemDetach(itemPtr);
+    DeleteUse(canvas, itemPtr, Tk_Display(Tk_PathCanvasTkwin(canvas)));
+    return TCL_ERROR;
+}
+
+static int
+UseCoords(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+        int objc, Tcl_Obj *CONST objv[])
+{
+    UseItem *usePtr = (UseItem *) itemPtr;
+    int result;
+
+    result = CoordsForPointItems(interp, canvas, usePtr->point, objc, objv);
+    if ((result == TCL_OK) && ((objc == 1) || (objc == 2))) {
+        ComputeUseBbox(canvas, usePtr);
+    }
+    return result;
+}
+
+/*
+ * The symbol is drawn in its own coordinates with the item's point
+ * added as a translation before the item matrix, as SVG does.
+ */
+
+static Tk_PathStyle
+UseInheritStyle(UseItem *usePtr, long flags)
+{
+    Tk_PathStyle style;
+    TMatrix m = kPathUnitTMatrix;
+
+    style = TkPathCanvasInheritStyle((Tk_PathItem *) usePtr, flags);
+    m.tx = usePtr->point[0];
+    m.ty = usePtr->point[1];
+    if (style.matrixPtr == NULL) {
+        style.matrixPtr = (TMatrix *) ckalloc(sizeof(TMatrix));
+        *style.matrixPtr = m;
+    } else {
+        MMulTMatrix(&m, style.matrixPtr);
+    }
+    return style;
+}
+
+static void
+ComputeUseBbox(Tk_PathCanvas canvas, UseItem *usePtr)
+{
+    Tk_PathItemEx *itemExPtr = &usePtr->headerEx;
+    Tk_PathItem *itemPtr = &itemExPtr->header;
+    TkPathSymbol *symbolPtr = usePtr->symbolPtr;
+    Tk_PathStyle style;
+    Tk_PathState state = itemExPtr->header.state;
+
+    if(state == TK_PATHSTATE_NULL) {
+	state = TkPathCanvasState(canvas);
+    }
+    if ((symbolPtr == NULL) || (symbolPtr->pathLen < 4)
+            || (state == TK_PATHSTATE_HIDDEN)) {
+        itemExPtr->header.x1 = itemExPtr->header.x2 =
+        itemExPtr->header.y1 = itemExPtr->header.y2 = -1;
+        return;
+    }
+
+    /*
+     * The bare bbox is the symbol's, only the stroke differs per item.
+     */
+    style = UseInheritStyle(usePtr, kPathMergeStyleNotFill);
+    itemPtr->bbox = symbolPtr->bbox;
+    itemPtr->totalBbox = GetGenericPathTotalBboxFromBare(symbolPtr->atomPtr,
+            &style, &symbolPtr->bbox);
+    SetGenericPathHeaderBbox(&itemExPtr->header, style.matrixPtr, &itemPtr->totalBbox);
+    TranslatePathRect(&itemPtr->bbox, usePtr->point[0], usePtr->point[1]);
+    TranslatePathRect(&itemPtr->totalBbox, usePtr->point[0], usePtr->point[1]);
+    TkPathCanvasFreeInheritedStyle(&style);
+}
+
+static int
+ConfigureUse(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+        int objc, Tcl_Obj *CONST objv[], int flags)
+{
+    UseItem *usePtr = (UseItem *) itemPtr;
+    Tk_PathItemEx *itemExPtr = &usePtr->headerEx;
+    Tk_PathStyle *stylePtr = &itemExPtr->style;
+    TkPathCanvas *canvasPtr = (TkPathCanvas *) canvas;
+    TkPathSymbol *symbolPtr = NULL;
+    Tk_Window tkwin;
+    Tk_SavedOptions savedOptions;
+    Tcl_Obj *errorResult = NULL;
+    int error, mask;
+
+    tkwin = Tk_PathCanvasTkwin(canvas);
+    for (error = 0; error <= 1; error++) {
+	if (!error) {
+	    if (Tk_SetOptions(interp, (char *) usePtr, optionTable,
+		    objc, objv, tkwin, &savedOptions, &mask) != TCL_OK) {
+		continue;
+	    }
+	} else {
+	    errorResult = Tcl_GetObjResult(interp);
+	    Tcl_IncrRefCount(errorResult);
+	    Tk_RestoreSavedOptions(&savedOptions);
+	}
+	if (TkPathCanvasItemExConfigure(interp, canvas, itemExPtr, mask) != TCL_OK) {
+	    continue;
+	}
+
+	/*
+	 * Look up a new symbol. The old one is kept until we know.
+	 */
+	if (!error && (mask & USE_OPTION_INDEX_SYMBOL)
+		&& (usePtr->symbolObj != NULL)) {
+	    Tcl_HashEntry *hPtr;
+
+	    hPtr = Tcl_FindHashEntry(&canvasPtr->symbolTable,
+		    Tcl_GetString(usePtr->symbolObj));
+	    if (hPtr == NULL) {
+		Tcl_ResetResult(interp);
+		Tcl_AppendResult(interp, "symbol \"",
+			Tcl_GetString(usePtr->symbolObj), "\" doesn't exist",
+			NULL);
+		continue;
+	    }
+	    symbolPtr = (TkPathSymbol *) Tcl_GetHashValue(hPtr);
+	}
+
+	/*
+	 * If we reach this on the first pass we are OK and continue below.
+	 */
+	break;
+    }
+    if (!error) {
+	Tk_FreeSavedOptions(&savedOptions);
+	stylePtr->mask |= mask;
+	if (mask & USE_OPTION_INDEX_SYMBOL) {
+	    if (symbolPtr != NULL) {
+		symbolPtr->refCount++;
+	    }
+	    if (usePtr->symbolPtr != NULL) {
+		SymbolRelease(usePtr->symbolPtr);
+	    }
+	    usePtr->symbolPtr = symbolPtr;
+	}
+    }
+    stylePtr->strokeOpacity = MAX(0.0, MIN(1.0, stylePtr->strokeOpacity));
+    stylePtr->fillOpacity   = MAX(0.0, MIN(1.0, stylePtr->fillOpacity));
+
+    /*
+     * Recompute bounding box for path.
+     */
+    if (error) {
+	Tcl_SetObjResult(interp, errorResult);
+	Tcl_DecrRefCount(errorResult);
+	return TCL_ERROR;
+    } else {
+	ComputeUseBbox(canvas, usePtr);
+	return TCL_OK;
+    }
+}
+
+static void
+DeleteUse(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display)
+{
+    UseItem *usePtr = (UseItem *) itemPtr;
+    Tk_PathItemEx *itemExPtr = &usePtr->headerEx;
+    Tk_PathStyle *stylePtr = &itemExPtr->style;
+
+    if (stylePtr->fill != NULL) {
+	TkPathFreePathColor(stylePtr->fill);
+    }
+    if (itemExPtr->styleInst != NULL) {
+	TkPathFreeStyle(itemExPtr->styleInst);
+    }
+    if (usePtr->symbolPtr != NULL) {
+	SymbolRelease(usePtr->symbolPtr);
+	usePtr->symbolPtr = NULL;
+    }
+    Tk_FreeConfigOptions((char *) itemPtr, optionTable, Tk_PathCanvasTkwin(canvas));
+}
+
+static void
+DisplayUse(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, Display *display, Drawable drawable,
+        int x, int y, int width, int height)
+{
+    UseItem *usePtr = (UseItem *) itemPtr;
+    TkPathSymbol *symbolPtr = usePtr->symbolPtr;
+    TMatrix m = GetCanvasTMatrix(canvas);
+    Tk_PathStyle style;
+
+    if ((symbolPtr == NULL) || (symbolPtr->pathLen <= 2)) {
+	return;
+    }
+    TkPathSetCoordOffsets(m.tx, m.ty);
+    style = UseInheritStyle(usePtr, 0);
+    TkPathDrawPath(Tk_PathCanvasTkwin(canvas), drawable, symbolPtr->atomPtr,
+	    &style, &m, &symbolPtr->bbox);
+    TkPathCanvasFreeInheritedStyle(&style);
+}
+
+static void
+UseBbox(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int mask)
+{
+    UseItem *usePtr = (UseItem *) itemPtr;
+    ComputeUseBbox(canvas, usePtr);
+}
+
+static double
+UseToPoint(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *pointPtr)
+{
+    UseItem *usePtr = (UseItem *) itemPtr;
+    TkPathSymbol *symbolPtr = usePtr->symbolPtr;
+    Tk_PathStyle style;
+    double dist;
+
+    if (symbolPtr == NULL) {
+	return 1.0e36;
+    }
+    style = UseInheritStyle(usePtr, 0);
+    dist = GenericPolysToPoint(canvas, itemPtr, &style,
+	    SymbolPolys(symbolPtr), pointPtr);
+    TkPathCanvasFreeInheritedStyle(&style);
+    return dist;
+}
+
+static int
+UseToArea(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double *areaPtr)
+{
+    UseItem *usePtr = (UseItem *) itemPtr;
+    TkPathSymbol *symbolPtr = usePtr->symbolPtr;
+    Tk_PathStyle style;
+    int area;
+
+    if (symbolPtr == NULL) {
+	return -1;
+    }
+    style = UseInheritStyle(usePtr, 0);
+    area = GenericPolysToArea(canvas, itemPtr, &style,
+	    SymbolPolys(symbolPtr), areaPtr);
+    TkPathCanvasFreeInheritedStyle(&style);
+    return area;
+}
+
+static int
+UseToPostscript(Tcl_Interp *interp, Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int prepass)
+{
+    return TCL_ERROR;
+}
+
+/*
+ * The geometry is shared and can't be scaled per item, so the scale
+ * goes into the item's matrix, which is applied after the scale as in
+ * ScaleEllipse. If the -style gives the matrix only the point moves.
+ */
+
+static void
+ScaleUse(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double originX, double originY,
+        double scaleX, double scaleY)
+{
+    UseItem *usePtr = (UseItem *) itemPtr;
+    Tk_PathItemEx *itemExPtr = &usePtr->headerEx;
+    Tk_PathStyle *stylePtr = &itemExPtr->style;
+
+    if ((itemExPtr->styleInst == NULL) 
+	    || !(itemExPtr->styleInst->masterPtr->mask & PATH_STYLE_OPTION_MATRIX)) {
+	TMatrix s = kPathUnitTMatrix, m = kPathUnitTMatrix;
+
+	s.a = scaleX;
+	s.d = scaleY;
+	s.tx = originX - scaleX*originX;
+	s.ty = originY - scaleY*originY;
+	if (stylePtr->matrixPtr == NULL) {
+	    stylePtr->matrixPtr = (TMatrix *) ckalloc(sizeof(TMatrix));
+	} else {
+	    m = *stylePtr->matrixPtr;
+	}
+	MMulTMatrix(&s, &m);
+	*stylePtr->matrixPtr = m;
+	stylePtr->mask |= PATH_STYLE_OPTION_MATRIX;
+	ComputeUseBbox(canvas, usePtr);
+	return;
+    }
+    usePtr->point[0] = originX + scaleX*(usePtr->point[0] - originX);
+    usePtr->point[1] = originY + scaleY*(usePtr->point[1] - originY);
+    ComputeUseBbox(canvas, usePtr);
+}
+
+static void
+TranslateUse(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, double deltaX, double deltaY)
+{
+    UseItem *usePtr = (UseItem *) itemPtr;
+
+    usePtr->point[0] += deltaX;
+    usePtr->point[1] += deltaY;
+    TranslatePathRect(&itemPtr->bbox, deltaX, deltaY);
+    TranslatePathRect(&itemPtr->totalBbox, deltaX, deltaY);
+    TranslateItemHeader(itemPtr, deltaX, deltaY);
+}
+
+/*----------------------------------------------------------------------*/
@@ -287,6 +287,21 @@ void TkPathSetCoordOffsets(double dx, double dy);
 /* === */
 TkPathContext	TkPathInit(Tk_Window tkwin, Drawable d);
 TkPathContext	TkPathInitSurface(int width, int height);
+
+/*
+ * Optional client side buffer for the redraws of a canvas. TkPathBufferNew
+ * returns NULL if the platform or display has none. Between Begin and End
+ * the contexts made for the drawable render into the buffer instead, and
+ * TkPathBufferSync must be called before anything else draws into it.
+ */
+typedef struct TkPathBuffer_ TkPathBuffer;
+TkPathBuffer *	TkPathBufferNew(Tk_Window tkwin);
+int		TkPathBufferBegin(TkPathBuffer *bufPtr, Drawable d, GC gc,
+                    int width, int height, unsigned long background);
+void		TkPathBufferSync(TkPathBuffer *bufPtr);
+void		TkPathBufferEnd(TkPathBuffer *bufPtr, Drawable dst, GC gc,
+                    int srcX, int srcY, int width, int height, int dstX, int dstY);
+void		TkPathBufferFree(TkPathBuffer *bufPtr);
 void		TkPathBeginPath(TkPathContext ctx, Tk_PathStyle *stylePtr);
 void    	TkPathEndPath(TkPathContext ctx);
 void		TkPathMoveTo(TkPathContext ctx, double x, double y);
@@ -350,6 +365,20 @@ void		TkPathMakeRawCurvePostscript(Tcl_Interp *interp, Tk_PathCanvas canvas,
 void		TkPathFillPolygon(Tk_PathCanvas canvas, double *coordPtr, int numPoints,
 		    Display *display, Drawable drawable, GC gc, GC outlineGC);
 		
+/*
+ * Slab pools for small records, see tkPathPool.c.
+ */
+
+typedef struct TkPathPool TkPathPool;
+
+TkPathPool *	TkPathPoolCreate(void);
+void		TkPathPoolDestroy(TkPathPool *poolPtr);
+char *		TkPathPoolAlloc(TkPathPool *poolPtr, unsigned int size);
+void		TkPathPoolFree(TkPathPool *poolPtr, char *ptr, unsigned int size);
+void		TkPathPoolStats(TkPathPool *poolPtr, Tcl_Obj *listObj);
+TkPathPool *	TkPathAtomPool(void);
+TkPathPool *	TkPathTagPool(void);
+
 /* 
  * Various stuff.
  */
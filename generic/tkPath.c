@@ -243,7 +243,7 @@ NewMoveToAtom(double x, double y)
     PathAtom *atomPtr;
     MoveToAtom *moveToAtomPtr;
 
-    moveToAtomPtr = (MoveToAtom *) ckalloc((unsigned) (sizeof(MoveToAtom)));
+    moveToAtomPtr = (MoveToAtom *) TkPathPoolAlloc(TkPathAtomPool(), sizeof(MoveToAtom));
     atomPtr = (PathAtom *) moveToAtomPtr;
     atomPtr->type = PATH_ATOM_M;
     atomPtr->nextPtr = NULL;
@@ -258,7 +258,7 @@ NewLineToAtom(double x, double y)
     PathAtom *atomPtr;
     LineToAtom *lineToAtomPtr;
 
-    lineToAtomPtr = (LineToAtom *) ckalloc((unsigned) (sizeof(LineToAtom)));
+    lineToAtomPtr = (LineToAtom *) TkPathPoolAlloc(TkPathAtomPool(), sizeof(LineToAtom));
     atomPtr = (PathAtom *) lineToAtomPtr;
     atomPtr->type = PATH_ATOM_L;
     atomPtr->nextPtr = NULL;
@@ -274,7 +274,7 @@ NewArcAtom(double radX, double radY,
     PathAtom *atomPtr;
     ArcAtom *arcAtomPtr;
 
-    arcAtomPtr = (ArcAtom *) ckalloc((unsigned) (sizeof(ArcAtom)));
+    arcAtomPtr = (ArcAtom *) TkPathPoolAlloc(TkPathAtomPool(), sizeof(ArcAtom));
     atomPtr = (PathAtom *) arcAtomPtr;
     atomPtr->type = PATH_ATOM_A;
     atomPtr->nextPtr = NULL;    
@@ -294,7 +294,7 @@ NewQuadBezierAtom(double ctrlX, double ctrlY, double anchorX, double anchorY)
     PathAtom *atomPtr;
     QuadBezierAtom *quadBezierAtomPtr;
 
-    quadBezierAtomPtr = (QuadBezierAtom *) ckalloc((unsigned) (sizeof(QuadBezierAtom)));
+    quadBezierAtomPtr = (QuadBezierAtom *) TkPathPoolAlloc(TkPathAtomPool(), sizeof(QuadBezierAtom));
     atomPtr = (PathAtom *) quadBezierAtomPtr;
     atomPtr->type = PATH_ATOM_Q;
     atomPtr->nextPtr = NULL;
@@ -312,7 +312,7 @@ NewCurveToAtom(double ctrlX1, double ctrlY1, double ctrlX2, double ctrlY2,
     PathAtom *atomPtr;
     CurveToAtom *curveToAtomPtr;
 
-    curveToAtomPtr = (CurveToAtom *) ckalloc((unsigned) (sizeof(CurveToAtom)));
+    curveToAtomPtr = (CurveToAtom *) TkPathPoolAlloc(TkPathAtomPool(), sizeof(CurveToAtom));
     atomPtr = (PathAtom *) curveToAtomPtr;
     atomPtr->type = PATH_ATOM_C;
     atomPtr->nextPtr = NULL;
@@ -331,7 +331,7 @@ NewRectAtom(double pointsPtr[])
     PathAtom *atomPtr;
     RectAtom *rectAtomPtr;
 
-    rectAtomPtr = (RectAtom *) ckalloc((unsigned) (sizeof(RectAtom)));
+    rectAtomPtr = (RectAtom *) TkPathPoolAlloc(TkPathAtomPool(), sizeof(RectAtom));
     atomPtr = (PathAtom *) rectAtomPtr;    
     atomPtr->nextPtr = NULL;
     atomPtr->type = PATH_ATOM_RECT;
@@ -348,7 +348,7 @@ NewCloseAtom(double x, double y)
     PathAtom *atomPtr;
     CloseAtom *closeAtomPtr;
 
-    closeAtomPtr = (CloseAtom *) ckalloc((unsigned) (sizeof(CloseAtom)));
+    closeAtomPtr = (CloseAtom *) TkPathPoolAlloc(TkPathAtomPool(), sizeof(CloseAtom));
     atomPtr = (PathAtom *) closeAtomPtr;
     atomPtr->type = PATH_ATOM_Z;
     atomPtr->nextPtr = NULL;
@@ -716,6 +716,26 @@ error:
     return TCL_ERROR;
 }
 
+/*
+ * The size the atom was allocated with in its pool.
+ */
+
+static unsigned int
+AtomSize(PathAtom *atomPtr)
+{
+    switch (atomPtr->type) {
+        case PATH_ATOM_M: return sizeof(MoveToAtom);
+        case PATH_ATOM_L: return sizeof(LineToAtom);
+        case PATH_ATOM_A: return sizeof(ArcAtom);
+        case PATH_ATOM_Q: return sizeof(QuadBezierAtom);
+        case PATH_ATOM_C: return sizeof(CurveToAtom);
+        case PATH_ATOM_Z: return sizeof(CloseAtom);
+        case PATH_ATOM_ELLIPSE: return sizeof(EllipseAtom);
+        case PATH_ATOM_RECT: return sizeof(RectAtom);
+    }
+    return sizeof(PathAtom);
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -736,11 +756,12 @@ void
 TkPathFreeAtoms(PathAtom *pathAtomPtr)
 {
     PathAtom *tmpAtomPtr;
+    TkPathPool *poolPtr = TkPathAtomPool();
 
     while (pathAtomPtr != NULL) {
         tmpAtomPtr = pathAtomPtr;
         pathAtomPtr = tmpAtomPtr->nextPtr;
-        ckfree((char *) tmpAtomPtr);
+        TkPathPoolFree(poolPtr, (char *) tmpAtomPtr, AtomSize(tmpAtomPtr));
     }
 }
 
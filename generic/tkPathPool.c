@@ -0,0 +1,307 @@
+/*
+ * tkPathPool.c --
+ *
+ *	Size class slab pools for the many small records of the canvas:
+ *	item records, path atoms and tag arrays. Slots are handed out
+ *	from slabs of a few kB and put on a free list when released, so
+ *	creating and deleting many items does not fragment the heap.
+ *	All slabs are released at once when a pool is destroyed.
+ *
+ *	The caller must give the same size to TkPathPoolFree as it gave
+ *	to TkPathPoolAlloc since no header is stored with the slots.
+ *
+ * Copyright (c) 2026  tkpath contributors
+ *
+ * $Id$
+ */
+
+#include "tkIntPath.h"
+
+/*
+ * Slots are a multiple of this many bytes, which also keeps them
+ * aligned for doubles.
+ */
+
+#define POOL_QUANTUM	    16
+#define POOL_NUM_CLASSES    64	/* Largest pooled size is 1024 bytes. */
+#define POOL_SLAB_BYTES	    8192
+#define POOL_MIN_SLOTS	    8
+
+typedef struct PoolSlot {
+    struct PoolSlot *nextPtr;
+} PoolSlot;
+
+/*
+ * Each slab starts with this header, padded to a full quantum.
+ */
+
+typedef union PoolSlab {
+    union PoolSlab *nextPtr;
+    char pad[POOL_QUANTUM];
+} PoolSlab;
+
+typedef struct PoolClass {
+    PoolSlot *freePtr;	    /* Free slots of this class. */
+    PoolSlab *slabPtr;	    /* All slabs of this class. */
+    int numSlabs;
+    int numLive;	    /* Slots handed out. */
+    int numFree;	    /* Slots on the free list. */
+} PoolClass;
+
+struct TkPathPool {
+    PoolClass classes[POOL_NUM_CLASSES];
+    int numLarge;	    /* Live allocations too big for the slabs. */
+};
+
+typedef struct ThreadSpecificData {
+    TkPathPool *atomPoolPtr;
+    TkPathPool *tagPoolPtr;
+} ThreadSpecificData;
+
+static Tcl_ThreadDataKey dataKey;
+
+static void	PoolThreadExitProc(ClientData clientData);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathPoolCreate, TkPathPoolDestroy --
+ *
+ *	Creates and destroys a pool. Destroying releases all its slabs,
+ *	also those with slots in use.
+ *
+ * Results:
+ *	The new pool.
+ *
+ * Side effects:
+ *	Memory allocated or freed.
+ *
+ *--------------------------------------------------------------
+ */
+
+TkPathPool *
+TkPathPoolCreate(void)
+{
+    TkPathPool *poolPtr;
+
+    poolPtr = (TkPathPool *) ckalloc(sizeof(TkPathPool));
+    memset(poolPtr, 0, sizeof(TkPathPool));
+    return poolPtr;
+}
+
+void
+TkPathPoolDestroy(TkPathPool *poolPtr)
+{
+    PoolSlab *slabPtr, *nextPtr;
+    int i;
+
+    for (i = 0; i < POOL_NUM_CLASSES; i++) {
+	for (slabPtr = poolPtr->classes[i].slabPtr; slabPtr != NULL;
+		slabPtr = nextPtr) {
+	    nextPtr = slabPtr->nextPtr;
+	    ckfree((char *) slabPtr);
+	}
+    }
+    ckfree((char *) poolPtr);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathPoolAlloc --
+ *
+ *	Returns a slot of at least size bytes. Sizes above the largest
+ *	class go directly to ckalloc.
+ *
+ * Results:
+ *	Pointer to uninitialized memory.
+ *
+ * Side effects:
+ *	May allocate a new slab.
+ *
+ *--------------------------------------------------------------
+ */
+
+char *
+TkPathPoolAlloc(TkPathPool *poolPtr, unsigned int size)
+{
+    int index = (size + POOL_QUANTUM - 1)/POOL_QUANTUM - 1;
+    PoolClass *classPtr;
+    PoolSlot *slotPtr;
+
+    if (index >= POOL_NUM_CLASSES) {
+	poolPtr->numLarge++;
+	return ckalloc(size);
+    }
+    if (index < 0) {
+	index = 0;
+    }
+    classPtr = poolPtr->classes + index;
+    if (classPtr->freePtr == NULL) {
+	PoolSlab *slabPtr;
+	int i, slotSize = (index + 1) * POOL_QUANTUM;
+	int numSlots = MAX(POOL_MIN_SLOTS, POOL_SLAB_BYTES/slotSize);
+	char *p;
+
+	slabPtr = (PoolSlab *) ckalloc((unsigned)
+		(sizeof(PoolSlab) + numSlots * slotSize));
+	slabPtr->nextPtr = classPtr->slabPtr;
+	classPtr->slabPtr = slabPtr;
+	classPtr->numSlabs++;
+
+	/* Link the slots backwards so they are handed out in order. */
+	p = (char *) (slabPtr + 1) + (numSlots - 1) * slotSize;
+	for (i = 0; i < numSlots; i++, p -= slotSize) {
+	    slotPtr = (PoolSlot *) p;
+	    slotPtr->nextPtr = classPtr->freePtr;
+	    classPtr->freePtr = slotPtr;
+	}
+	classPtr->numFree += numSlots;
+    }
+    slotPtr = classPtr->freePtr;
+    classPtr->freePtr = slotPtr->nextPtr;
+    classPtr->numFree--;
+    classPtr->numLive++;
+    return (char *) slotPtr;
+}
+
+void
+TkPathPoolFree(TkPathPool *poolPtr, char *ptr, unsigned int size)
+{
+    int index = (size + POOL_QUANTUM - 1)/POOL_QUANTUM - 1;
+    PoolClass *classPtr;
+    PoolSlot *slotPtr = (PoolSlot *) ptr;
+
+    if (index >= POOL_NUM_CLASSES) {
+	poolPtr->numLarge--;
+	ckfree(ptr);
+	return;
+    }
+    if (index < 0) {
+	index = 0;
+    }
+    classPtr = poolPtr->classes + index;
+    slotPtr->nextPtr = classPtr->freePtr;
+    classPtr->freePtr = slotPtr;
+    classPtr->numFree++;
+    classPtr->numLive--;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathPoolStats --
+ *
+ *	Appends 'slotSize live free' to listObj for each size class
+ *	that has any slabs, and 'large count 0' for the big ones.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+void
+TkPathPoolStats(TkPathPool *poolPtr, Tcl_Obj *listObj)
+{
+    PoolClass *classPtr;
+    int i;
+
+    for (i = 0, classPtr = poolPtr->classes; i < POOL_NUM_CLASSES;
+	    i++, classPtr++) {
+	if (classPtr->numSlabs > 0) {
+	    Tcl_ListObjAppendElement(NULL, listObj,
+		    Tcl_NewIntObj((i + 1) * POOL_QUANTUM));
+	    Tcl_ListObjAppendElement(NULL, listObj,
+		    Tcl_NewIntObj(classPtr->numLive));
+	    Tcl_ListObjAppendElement(NULL, listObj,
+		    Tcl_NewIntObj(classPtr->numFree));
+	}
+    }
+    if (poolPtr->numLarge > 0) {
+	Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewStringObj("large", -1));
+	Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewIntObj(poolPtr->numLarge));
+	Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewIntObj(0));
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathAtomPool, TkPathTagPool --
+ *
+ *	Path atoms and tag arrays are made without knowing any canvas,
+ *	so they come from pools per thread instead.
+ *
+ * Results:
+ *	The pool of this thread.
+ *
+ * Side effects:
+ *	Pools created on first use.
+ *
+ *--------------------------------------------------------------
+ */
+
+static ThreadSpecificData *
+GetThreadPools(void)
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    if (tsdPtr->atomPoolPtr == NULL) {
+	tsdPtr->atomPoolPtr = TkPathPoolCreate();
+	tsdPtr->tagPoolPtr = TkPathPoolCreate();
+	Tcl_CreateThreadExitHandler(PoolThreadExitProc, NULL);
+    }
+    return tsdPtr;
+}
+
+TkPathPool *
+TkPathAtomPool(void)
+{
+    return GetThreadPools()->atomPoolPtr;
+}
+
+TkPathPool *
+TkPathTagPool(void)
+{
+    return GetThreadPools()->tagPoolPtr;
+}
+
+static int
+PoolIsEmpty(TkPathPool *poolPtr)
+{
+    int i;
+
+    for (i = 0; i < POOL_NUM_CLASSES; i++) {
+	if (poolPtr->classes[i].numLive > 0) {
+	    return 0;
+	}
+    }
+    return (poolPtr->numLarge == 0);
+}
+
+static void
+PoolThreadExitProc(ClientData clientData)
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    /*
+     * Something may still hold slots if the thread goes away before
+     * its canvases, and then we must leave the pools alone.
+     */
+    if ((tsdPtr->atomPoolPtr != NULL) && PoolIsEmpty(tsdPtr->atomPoolPtr)
+	    && PoolIsEmpty(tsdPtr->tagPoolPtr)) {
+	TkPathPoolDestroy(tsdPtr->atomPoolPtr);
+	TkPathPoolDestroy(tsdPtr->tagPoolPtr);
+	tsdPtr->atomPoolPtr = NULL;
+	tsdPtr->tagPoolPtr = NULL;
+    }
+}
+
+/*----------------------------------------------------------------------*/
+
@@ -114,13 +114,18 @@ TkPathDrawPath(
 {
     TkPathContext context;
     
+    if (drawable == TK_PATH_SVG_DRAWABLE) {
+	TkPathSvgPath(atomPtr, stylePtr);
+	return;
+    }
+
     /*
      * Define the path in the drawable using the path drawing functions.
      * Any transform matrix need to be considered and canvas drawable
      * offset must always be taken into account. Note the order!
      */
      
-    context = TkPathInit(tkwin, drawable);
+    context = TkPathTimedInit(tkwin, drawable);
     if (mPtr != NULL) {
         TkPathPushTMatrix(context, mPtr);
     }
@@ -131,7 +136,7 @@ TkPathDrawPath(
         return;
     }
     TkPathPaintPath(context, atomPtr, stylePtr,	bboxPtr);
-    TkPathFree(context);
+    TkPathTimedFree(context);
 }
 
 /*
@@ -187,6 +187,9 @@ typedef void	Tk_PathItemInsertProc(Tk_PathCanvas canvas,
 		    Tk_PathItem *itemPtr, int beforeThis, char *string);
 typedef void	Tk_PathItemDCharsProc(Tk_PathCanvas canvas,
 		    Tk_PathItem *itemPtr, int first, int last);
+typedef int	Tk_PathItemAppendProc(Tcl_Interp *interp,
+		    Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int objc,
+		    Tcl_Obj *CONST objv[]);
 
 #ifndef __NO_OLD_CONFIG
 
@@ -247,9 +250,16 @@ typedef struct Tk_PathItemType {
 				/* Procedure to delete characters from an
 				 * item. */
     struct Tk_PathItemType *nextPtr;/* Used to link types together into a list. */
-    char *reserved1;		/* Reserved for future extension. */
-    int reserved2;		/* Carefully compatible with */
-    char *reserved3;		/* Jan Nijtmans dash patch */
+    Tk_PathItemAppendProc *appendProc;
+				/* Procedure to append coordinates to an
+				 * item, or NULL. Takes the place of the
+				 * first reserved field, so types that don't
+				 * set it keep working. */
+    int flags;			/* Bits describing the type, for tkpath's
+				 * own use. Takes the place of the second
+				 * reserved field, 0 for other types. */
+    char *reserved3;		/* Carefully compatible with
+				 * Jan Nijtmans dash patch */
     char *reserved4;
 } Tk_PathItemType;
 
@@ -281,6 +281,7 @@ Tk_PathItemType tkArcType = {
     NULL,			/* insertProc */
     NULL,			/* dTextProc */
     NULL,			/* nextPtr */
+    NULL,			/* appendProc */
 };
 
 #ifndef PI
@@ -164,6 +164,7 @@ Tk_PathItemType tkBitmapType = {
     NULL,			/* insertProc */
     NULL,			/* dTextProc */
     NULL,			/* nextPtr */
+    NULL,			/* appendProc */
 };
 
 /*
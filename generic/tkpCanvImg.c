@@ -151,6 +151,7 @@ Tk_PathItemType tkImageType = {
     NULL,			/* insertProc */
     NULL,			/* dTextProc */
     NULL,			/* nextPtr */
+    NULL,			/* appendProc */
 };
 
 /*
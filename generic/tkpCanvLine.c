@@ -296,6 +296,7 @@ Tk_PathItemType tkLineType = {
     (Tk_PathItemInsertProc *) LineInsert,/* insertProc */
     LineDeleteCoords,		/* dTextProc */
     NULL,			/* nextPtr */
+    NULL,			/* appendProc */
 };
 
 /*
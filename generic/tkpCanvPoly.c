@@ -266,6 +266,7 @@ Tk_PathItemType tkPolygonType = {
     (Tk_PathItemInsertProc *) PolygonInsert,/* insertProc */
     PolygonDeleteCoords,		/* dTextProc */
     NULL,				/* nextPtr */
+    NULL,			/* appendProc */
 };
 
 /*
@@ -229,6 +229,7 @@ Tk_PathItemType tkTextType = {
     TextInsert,			/* insertProc */
     TextDeleteChars,		/* dTextProc */
     NULL,			/* nextPtr */
+    NULL,			/* appendProc */
 };
 
 /*
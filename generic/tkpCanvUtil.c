@@ -441,11 +441,20 @@ TkPathCanvasInheritStyle(Tk_PathItem *itemPtr, long flags)
      * Merge the parents style with the actual items style.
      * The order of these two merges decides which take precedence.
      */
-    itemExPtr = (Tk_PathItemEx *) itemPtr;
-    TkPathStyleMergeStyles(&itemExPtr->style, &style, flags);
-    if (itemExPtr->styleInst != NULL) {
-	TkPathStyleMergeStyles(itemExPtr->styleInst->masterPtr, &style, flags);
-    }    
+    if (TkPathItemIsLight(itemPtr)) {
+	/* Lightweight items have only the named style. */
+	Tk_PathItemLight *itemLightPtr = (Tk_PathItemLight *) itemPtr;
+	
+	if (itemLightPtr->styleInst != NULL) {
+	    TkPathStyleMergeStyles(itemLightPtr->styleInst->masterPtr, &style, flags);
+	}
+    } else {
+	itemExPtr = (Tk_PathItemEx *) itemPtr;
+	TkPathStyleMergeStyles(&itemExPtr->style, &style, flags);
+	if (itemExPtr->styleInst != NULL) {
+	    TkPathStyleMergeStyles(itemExPtr->styleInst->masterPtr, &style, flags);
+	}    
+    }
     if (style.matrixPtr != NULL) {
 	anyMatrix = 1;
 	MMulTMatrix(style.matrixPtr, &matrix);
@@ -616,10 +625,11 @@ TkPathAllocTagsFromObj(
 	return NULL;
     }
     len = MAX(objc, TK_PATHTAG_SPACE);
-    tagsPtr = (Tk_PathTags *) ckalloc(sizeof(Tk_PathTags));
+    tagsPtr = (Tk_PathTags *) TkPathPoolAlloc(TkPathTagPool(), sizeof(Tk_PathTags));
     tagsPtr->tagSpace = len;
     tagsPtr->numTags = objc;
-    tagsPtr->tagPtr = (Tk_Uid *) ckalloc((unsigned) (len * sizeof(Tk_Uid)));
+    tagsPtr->tagPtr = (Tk_Uid *) TkPathPoolAlloc(TkPathTagPool(), 
+	    (unsigned) (len * sizeof(Tk_Uid)));
     for (i = 0; i < objc; i++) {
 	tagsPtr->tagPtr[i] = Tk_GetUid(Tcl_GetStringFromObj(objv[i], NULL));
     }
@@ -630,7 +640,8 @@ static void
 TkPathFreeTags(Tk_PathTags *tagsPtr)
 {
     if (tagsPtr->tagPtr != NULL) {
-	ckfree((char *) tagsPtr->tagPtr);
+	TkPathPoolFree(TkPathTagPool(), (char *) tagsPtr->tagPtr,
+		(unsigned) (tagsPtr->tagSpace * sizeof(Tk_Uid)));
     }    
 }
 
@@ -738,7 +749,8 @@ Tk_PathCanvasTagsOptionFreeProc(
     tagsPtr = *((Tk_PathTags **) internalPtr);
     if (tagsPtr != NULL) {
 	TkPathFreeTags(tagsPtr);
-        ckfree(*((char **) internalPtr));
+	TkPathPoolFree(TkPathTagPool(), *((char **) internalPtr), 
+		sizeof(Tk_PathTags));
         *((char **) internalPtr) = NULL;
     }
 }
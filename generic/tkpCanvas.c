@@ -107,8 +107,39 @@ typedef struct TagSearch {
 #define SEARCH_TYPE_EXPR	4	/* Compound search */
 #define SEARCH_TYPE_ROOT	5	/* Looking for the root item */
 
+/*
+ * Number of compiled tag expressions kept per canvas.
+ */
+
+#define TAG_EXPR_CACHE_SIZE	64
+
+/*
+ * Counting of the items scanned by tag searches for the stats command.
+ */
+
+#define SEARCH_STATS_BEGIN(searchPtr) \
+    do { \
+	if ((searchPtr)->canvasPtr->statsPtr != NULL) \
+	    (searchPtr)->canvasPtr->statsPtr->searches++; \
+    } while (0)
+#define SEARCH_STATS_SCAN(searchPtr) \
+    do { \
+	if ((searchPtr)->canvasPtr->statsPtr != NULL) \
+	    (searchPtr)->canvasPtr->statsPtr->scanned++; \
+    } while (0)
+
 #endif /* USE_OLD_TAG_SEARCH */
 
+/*
+ * Counting of the pointProc and areaProc calls for the stats command.
+ */
+
+#define HIT_STATS(canvasPtr) \
+    do { \
+	if ((canvasPtr)->statsPtr != NULL) \
+	    (canvasPtr)->statsPtr->hitTests++; \
+    } while (0)
+
 #define PATH_DEF_STATE "normal"
 
 /* These MUST be kept in sync with enums! X.h */
@@ -180,6 +211,9 @@ static Tk_OptionSpec optionSpecs[] = {
     {TK_OPTION_PIXELS, "-insertwidth", "insertWidth", "InsertWidth",
 	DEF_CANVAS_INSERT_WIDTH, -1, Tk_Offset(TkPathCanvas, textInfo.insertWidth),
 	0, 0, 0},
+    {TK_OPTION_INT, "-maxfps", "maxFps", "MaxFps",
+	"0", -1, Tk_Offset(TkPathCanvas, maxFps),
+	0, 0, 0},
     {TK_OPTION_CUSTOM, "-offset", "offset", "Offset",
 	"0,0", -1, Tk_Offset(TkPathCanvas, tsoffsetPtr),
 	0, &offsetCO, 0},
@@ -199,6 +233,9 @@ static Tk_OptionSpec optionSpecs[] = {
     {TK_OPTION_COLOR, "-selectforeground", "selectForeground", "Background",
 	DEF_CANVAS_SELECT_FG_COLOR, -1, Tk_Offset(TkPathCanvas, textInfo.selFgColorPtr),
 	TK_OPTION_NULL_OK, (ClientData) DEF_CANVAS_SELECT_FG_MONO, 0},	
+    {TK_OPTION_BOOLEAN, "-shm", "shm", "Shm",
+	"0", -1, Tk_Offset(TkPathCanvas, shm),
+	0, 0, 0},
     {TK_OPTION_STRING_TABLE, "-state", "state", "State",
 	PATH_DEF_STATE, -1, Tk_Offset(TkPathCanvas, canvas_state),
 	0, (ClientData) stateStrings, 0},
@@ -273,6 +310,11 @@ static void		CanvasBindProc(ClientData clientData,
 static void		CanvasBlinkProc(ClientData clientData);
 static void		CanvasCmdDeletedProc(ClientData clientData);
 static void		CanvasDoEvent(TkPathCanvas *canvasPtr, XEvent *eventPtr);
+#ifndef USE_OLD_TAG_SEARCH
+static TagExprMatches *	GetTagExprMatches(TkPathCanvas *canvasPtr,
+			    Tk_PathItem *itemPtr);
+static void		FreeTagExprMatches(TagExprMatches *matchesPtr);
+#endif
 static void		CanvasEventProc(ClientData clientData,
 			    XEvent *eventPtr);
 static int		CanvasFetchSelection(ClientData clientData, int offset,
@@ -296,6 +338,11 @@ static int		ConfigureCanvas(Tcl_Interp *interp,
 			    Tcl_Obj *CONST *argv, int flags);
 static void		DestroyCanvas(char *memPtr);
 static void		DisplayCanvas(ClientData clientData);
+static void		FrameTimerProc(ClientData clientData);
+static void		ScheduleRedraw(TkPathCanvas *canvasPtr);
+static int		CanvasSnapshot(Tcl_Interp *interp,
+			    TkPathCanvas *canvasPtr, int objc,
+			    Tcl_Obj *CONST objv[]);
 static void		DoItem(Tcl_Interp *interp,
 			    Tk_PathItem *itemPtr, Tk_Uid tag);
 static void		EventuallyRedrawItem(Tk_PathCanvas canvas,
@@ -305,11 +352,19 @@ static Tcl_Obj *	UnshareObj(Tcl_Obj *objPtr);
 static Tk_PathItem *	ItemIteratorSubNext(Tk_PathItem *itemPtr, Tk_PathItem *groupPtr);
 static void		ItemAddToParent(Tk_PathItem *parentPtr, Tk_PathItem *itemPtr);
 static void		ItemDelete(TkPathCanvas *canvasPtr, Tk_PathItem *itemPtr);
+static void		ItemDeleteTree(TkPathCanvas *canvasPtr, 
+				Tk_PathItem *itemPtr, int area[4]);
+static void		ItemRelease(TkPathCanvas *canvasPtr, Tk_PathItem *itemPtr);
+static void		DeleteAllItems(TkPathCanvas *canvasPtr);
 static int		ItemCreate(Tcl_Interp *interp, TkPathCanvas *canvasPtr, 
 				Tk_PathItemType *typePtr, int isRoot, Tk_PathItem **itemPtrPtr, 
 				int objc, Tcl_Obj *CONST objv[]);
 static int		ItemGetNumTags(Tk_PathItem *itemPtr);
+static int		GetItemTypeFromObj(Tcl_Interp *interp, Tcl_Obj *objPtr,
+				Tk_PathItemType **typePtrPtr);
 static void		SetAncestorsDirtyBbox(Tk_PathItem *itemPtr);
+static void		TransformBbox(TMatrix *mPtr, int *x1Ptr, int *y1Ptr,
+				int *x2Ptr, int *y2Ptr);
 			    
 static void		DebugGetItemInfo(Tk_PathItem *itemPtr, char *s);
 
@@ -325,6 +380,11 @@ static int		FindItems(Tcl_Interp *interp, TkPathCanvas *canvasPtr,
 #endif /* USE_OLD_TAG_SEARCH */
 static int		FindArea(Tcl_Interp *interp, TkPathCanvas *canvasPtr,
 			    Tcl_Obj *CONST *argv, Tk_Uid uid, int enclosed);
+static int		FindAtPoints(Tcl_Interp *interp,
+			    TkPathCanvas *canvasPtr, Tcl_Obj *pointsObj,
+			    Tk_PathItem **items, int numItems, Tk_Uid uid);
+static int		GetPointsFromObj(Tcl_Interp *interp, Tcl_Obj *listObj,
+			    double **pointsPtr, int *numPointsPtr);
 static double		GridAlign(double coord, double spacing);
 static CONST char**	TkGetStringsFromObjs(int argc, Tcl_Obj *CONST *objv);
 static void		InitCanvas(void);
@@ -344,6 +404,7 @@ static int		RelinkItems(TkPathCanvas *canvasPtr, Tcl_Obj *tag,
 			    Tk_PathItem *prevPtr, TagSearch **searchPtrPtr);
 static void 		TagSearchExprInit(TagSearchExpr **exprPtrPtr);
 static void		TagSearchExprDestroy(TagSearchExpr *expr);
+static void		TagSearchExprCacheFlush(TkPathCanvas *canvasPtr);
 static void		TagSearchDestroy(TagSearch *searchPtr);
 static int		TagSearchScan(TkPathCanvas *canvasPtr,
 			    Tcl_Obj *tag, TagSearch **searchPtrPtr);
@@ -493,6 +554,7 @@ Tk_PathCanvasObjCmd(
     canvasPtr->insertBlinkHandler = (Tcl_TimerToken) NULL;
     canvasPtr->xOrigin = canvasPtr->yOrigin = 0;
     canvasPtr->drawableXOrigin = canvasPtr->drawableYOrigin = 0;
+    canvasPtr->drawableScale = 1.0;
     canvasPtr->bindingTable = NULL;
     canvasPtr->currentItemPtr = NULL;
     canvasPtr->newCurrentPtr = NULL;
@@ -527,13 +589,29 @@ Tk_PathCanvasObjCmd(
     canvasPtr->tsoffsetPtr = NULL;
     canvasPtr->styleUid = 0;
     canvasPtr->gradientUid = 0;
+    canvasPtr->itemPoolPtr = TkPathPoolCreate();
 #ifndef USE_OLD_TAG_SEARCH
     canvasPtr->bindTagExprs = NULL;
+    canvasPtr->bindExprGen = 0;
+    canvasPtr->bindExprCurrent = 0;
+    Tcl_InitHashTable(&canvasPtr->exprMatchTable, TCL_ONE_WORD_KEYS);
+    Tcl_InitHashTable(&canvasPtr->exprCacheTable, TCL_ONE_WORD_KEYS);
 #endif
+    canvasPtr->statsPtr = NULL;
+    canvasPtr->animPtr = NULL;
+    canvasPtr->animTimer = NULL;
+    canvasPtr->maxFps = 0;
+    canvasPtr->frameTimer = NULL;
+    canvasPtr->nextFrame.sec = 0;
+    canvasPtr->nextFrame.usec = 0;
+    canvasPtr->shm = 0;
+    canvasPtr->bufferPtr = NULL;
+    canvasPtr->bufferFailed = 0;
 
     Tcl_InitHashTable(&canvasPtr->idTable, TCL_ONE_WORD_KEYS);
     Tcl_InitHashTable(&canvasPtr->styleTable, TCL_STRING_KEYS);
     Tcl_InitHashTable(&canvasPtr->gradientTable, TCL_STRING_KEYS);
+    Tcl_InitHashTable(&canvasPtr->symbolTable, TCL_STRING_KEYS);
 
     Tk_SetClass(canvasPtr->tkwin, "PathCanvas");
     Tk_SetClassProcs(canvasPtr->tkwin, &canvasClass, (ClientData) canvasPtr);
@@ -600,7 +678,7 @@ CanvasWidgetCmd(
     Tcl_Obj *CONST objv[])	/* Argument objects. */
 {
     TkPathCanvas *canvasPtr = (TkPathCanvas *) clientData;
-    int c, result;
+    int result;
     Tcl_Obj *resultObjPtr;
     Tk_PathItem *itemPtr = NULL;/* Initialization needed only to prevent
 				 * compiler warning. */
@@ -613,16 +691,18 @@ CanvasWidgetCmd(
 
     int index;
     static CONST char *optionStrings[] = {
-	"addtag",	"ancestors",	"bbox",		"bind",		    "canvasx",
+	"addtag",	"ancestors",	"animate",	"append",
+	"bbox",		"bind",		"canvasx",
 	"canvasy",	"cget",		"children",	"configure",	    "coords",
-	"create",	"dchars",	"delete",	
+	"create",	"createmany",	"dchars",	"delete",	
 	"depth",	"distance",	"dtag",
 	"find",		"firstchild",	"focus",	"gettags",	    
 	"gradient",	"icursor",
 	"index",	"insert",	"itemcget",	"itemconfigure",    "lastchild",
-	"lower",	"move",		"nextsibling",
+	"load",		"lower",	"memory",	"move",		"nextsibling",
 	"parent",	"prevsibling",	"postscript",	"raise",
-	"scale",	"scan",		"select",	"style",	    
+	"save",		"scale",	"scan",		"select",	"snapshot",	"stats",
+	"style",	"svg",		"symbol",
 	"type",		"types",
 	"xview",	"yview",
 #if 1
@@ -631,16 +711,18 @@ CanvasWidgetCmd(
 	NULL
     };
     enum options {
-	CANV_ADDTAG,	CANV_ANCESTORS,	    CANV_BBOX,		CANV_BIND,	    CANV_CANVASX,
+	CANV_ADDTAG,	CANV_ANCESTORS,	    CANV_ANIMATE,	CANV_APPEND,
+	CANV_BBOX,	CANV_BIND,	    CANV_CANVASX,
 	CANV_CANVASY,	CANV_CGET,	    CANV_CHILDREN,	CANV_CONFIGURE,	    CANV_COORDS,
-	CANV_CREATE,	CANV_DCHARS,	    CANV_DELETE,	
+	CANV_CREATE,	CANV_CREATEMANY,    CANV_DCHARS,	CANV_DELETE,	
 	CANV_DEPTH,	CANV_DISTANCE,	    CANV_DTAG,
 	CANV_FIND,	CANV_FIRSTCHILD,    CANV_FOCUS,		CANV_GETTAGS,	    
 	CANV_GRADIENT,	CANV_ICURSOR,
 	CANV_INDEX,	CANV_INSERT,	    CANV_ITEMCGET,	CANV_ITEMCONFIGURE, CANV_LASTCHILD,
-	CANV_LOWER,	CANV_MOVE,	    CANV_NEXTSIBLING,
+	CANV_LOAD,	CANV_LOWER,	    CANV_MEMORY,	CANV_MOVE,	    CANV_NEXTSIBLING,
 	CANV_PARENT,	CANV_PREVSIBLING,   CANV_POSTSCRIPT,    CANV_RAISE,
-	CANV_SCALE,	CANV_SCAN,	    CANV_SELECT,	CANV_STYLE,	    
+	CANV_SAVE,	CANV_SCALE,	    CANV_SCAN,		CANV_SELECT,	    CANV_SNAPSHOT,	CANV_STATS,
+	CANV_STYLE,	CANV_SVG,	    CANV_SYMBOL,
 	CANV_TYPE,	CANV_TYPES,
 	CANV_XVIEW,	CANV_YVIEW,
 #if 1
@@ -704,6 +786,47 @@ CanvasWidgetCmd(
 	}
 	break;
     }
+    case CANV_ANIMATE: {
+	result = TkPathCanvasAnimateCmd(canvasPtr, interp, objc, objv);
+	break;
+    }
+    case CANV_APPEND: {
+	int x1,x2,y1,y2;
+
+	if (objc < 4) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "tagOrId coordList|x y ?x y ...?");
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	FOR_EVERY_CANVAS_ITEM_MATCHING(objv[2], &searchPtr, goto done) {
+	    if (itemPtr->typePtr->appendProc == NULL) {
+		continue;
+	    }
+
+	    /*
+	     * Items normally damage only the area of the new points and set
+	     * TK_ITEM_DONT_REDRAW. Otherwise redraw both old and new areas.
+	     */
+
+	    x1 = itemPtr->x1; y1 = itemPtr->y1;
+	    x2 = itemPtr->x2; y2 = itemPtr->y2;
+	    itemPtr->redraw_flags &= ~TK_ITEM_DONT_REDRAW;
+	    result = (*itemPtr->typePtr->appendProc)(interp,
+		    (Tk_PathCanvas) canvasPtr, itemPtr, objc-3, objv+3);
+	    if (result != TCL_OK) {
+		goto done;
+	    }
+	    if (!(itemPtr->redraw_flags & TK_ITEM_DONT_REDRAW)) {
+		Tk_PathCanvasEventuallyRedraw((Tk_PathCanvas) canvasPtr,
+			x1, y1, x2, y2);
+		EventuallyRedrawItem((Tk_PathCanvas) canvasPtr, itemPtr);
+	    } else {
+		TkPathCanvasGroupChildChanged(itemPtr);
+	    }
+	    itemPtr->redraw_flags &= ~TK_ITEM_DONT_REDRAW;
+	}
+	break;
+    }
     case CANV_BBOX: {
 	int i, gotAny;
 	int x1 = 0, y1 = 0, x2 = 0, y2 = 0;	/* Initializations needed only
@@ -722,7 +845,7 @@ CanvasWidgetCmd(
 		/*
 		 * Groups bbox are only updated lazily, when needed.
 		 */
-		if (itemPtr->firstChildPtr != NULL) {
+		if (itemPtr->typePtr == &tkGroupType) {
 		    TkPathCanvasGroupBbox((Tk_PathCanvas) canvasPtr, itemPtr,
 			    &itemPtr->x1, &itemPtr->y1, &itemPtr->x2, &itemPtr->y2);
 		}	    
@@ -855,6 +978,7 @@ CanvasWidgetCmd(
 		 */
 
 	    	TagSearchExpr *expr, **lastPtr;
+		int i;
 
 		lastPtr = &(canvasPtr->bindTagExprs);
 		while ((expr = *lastPtr) != NULL) {
@@ -870,6 +994,13 @@ CanvasWidgetCmd(
 
 		    *lastPtr = searchPtr->expr;
 		    searchPtr->expr->next = NULL;
+		    canvasPtr->bindExprGen++;
+		    for (i = 0; i < searchPtr->expr->length; i++) {
+			if (searchPtr->expr->uids[i]
+				== GetStaticUids()->currentUid) {
+			    canvasPtr->bindExprCurrent = 1;
+			}
+		    }
 
 		    /*
 		     * Flag in TagSearch that expr has changed ownership so
@@ -1069,44 +1200,18 @@ CanvasWidgetCmd(
     }
     case CANV_CREATE: {
 	Tk_PathItemType *typePtr;
-	Tk_PathItemType *matchPtr = NULL;
 	Tk_PathItem *itemPtr;
-	char *arg;
-	int length;
 
 	if (objc < 3) {
 	    Tcl_WrongNumArgs(interp, 2, objv, "type coords ?arg arg ...?");
 	    result = TCL_ERROR;
 	    goto done;
 	}
-	arg = Tcl_GetStringFromObj(objv[2], &length);
-	c = arg[0];
-	Tcl_MutexLock(&typeListMutex);
-	for (typePtr = typeList; typePtr != NULL; typePtr = typePtr->nextPtr) {
-	    if ((c == typePtr->name[0])
-		    && (strncmp(arg, typePtr->name, (unsigned)length) == 0)) {
-		if (matchPtr != NULL) {
-		    Tcl_MutexUnlock(&typeListMutex);
-		badType:
-		    Tcl_AppendResult(interp,
-			    "unknown or ambiguous item type \"",arg,"\"",NULL);
-		    result = TCL_ERROR;
-		    goto done;
-		}
-		matchPtr = typePtr;
-	    }
-	}
-	/*
-	 * Can unlock now because we no longer look at the fields of
-	 * the matched item type that are potentially modified by
-	 * other threads.
-	 */
-	Tcl_MutexUnlock(&typeListMutex);
-	if (matchPtr == NULL) {
-	    goto badType;
+	if (GetItemTypeFromObj(interp, objv[2], &typePtr) != TCL_OK) {
+	    result = TCL_ERROR;
+	    goto done;
 	}
-	if ((strncmp("group", matchPtr->name, (unsigned)length) != 0) && 
-		(objc < 4)) {
+	if ((strcmp("group", typePtr->name) != 0) && (objc < 4)) {
 	    /*
 	     * Allow more specific error return. Groups have no coords.
 	     */
@@ -1114,7 +1219,6 @@ CanvasWidgetCmd(
 	    result = TCL_ERROR;
 	    goto done;
 	}
-	typePtr = matchPtr;
 	
 	result = ItemCreate(interp, canvasPtr, typePtr, 0, &itemPtr, objc-3, objv+3);
 	if (result != TCL_OK) {
@@ -1129,6 +1233,128 @@ CanvasWidgetCmd(
 	Tcl_SetObjResult(interp, Tcl_NewIntObj(itemPtr->id));
 	break;
     }
+    case CANV_CREATEMANY: {
+	Tk_PathItemType *typePtr;
+	Tk_PathItem *itemPtr;
+	Tk_PathItem **itemsPtr;
+	Tcl_Obj **specv, **elemv, **objv2;
+	Tcl_Obj *listObj;
+	int numSpecs, numElems, numCoords, numShared, i, j, n;
+	int x1 = 0, y1 = 0, x2 = 0, y2 = 0, gotAny = 0;
+	char *arg;
+
+	if ((objc < 4) || ((objc % 2) != 0)) {
+	    Tcl_WrongNumArgs(interp, 2, objv, 
+		    "type specList ?option value ...?");
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	if (GetItemTypeFromObj(interp, objv[2], &typePtr) != TCL_OK) {
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	if (Tcl_ListObjGetElements(interp, objv[3], &numSpecs, 
+		&specv) != TCL_OK) {
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	
+	/*
+	 * The shared options go after the coords of each spec but before
+	 * its own options so that these win. Since the same Tcl_Obj's are
+	 * handed to every item their internal reps, colors, styles etc.,
+	 * are only computed once. Otherwise each item goes through
+	 * ItemCreate like one made by create, with its own option
+	 * processing and idTable entry; its id is simply the next one.
+	 */
+	numShared = objc - 4;
+	n = numShared;
+	for (i = 0; i < numSpecs; i++) {
+	    if (Tcl_ListObjLength(interp, specv[i], &numElems) != TCL_OK) {
+		result = TCL_ERROR;
+		goto done;
+	    }
+	    n = MAX(n, numElems + numShared);
+	}
+	objv2 = (Tcl_Obj **) ckalloc((unsigned) (n + 1) * sizeof(Tcl_Obj *));
+	itemsPtr = (Tk_PathItem **) ckalloc((unsigned)
+		(numSpecs + 1) * sizeof(Tk_PathItem *));
+	
+	for (i = 0; i < numSpecs; i++) {
+	    Tcl_ListObjGetElements(NULL, specv[i], &numElems, &elemv);
+	    for (numCoords = 0; numCoords < numElems; numCoords++) {
+		arg = Tcl_GetString(elemv[numCoords]);
+		if ((arg[0] == '-') && (arg[1] >= 'a') && (arg[1] <= 'z')) {
+		    break;
+		}
+	    }
+	    n = 0;
+	    for (j = 0; j < numCoords; j++) {
+		objv2[n++] = elemv[j];
+	    }
+	    for (j = 0; j < numShared; j++) {
+		objv2[n++] = objv[4+j];
+	    }
+	    for (j = numCoords; j < numElems; j++) {
+		objv2[n++] = elemv[j];
+	    }
+	    if (ItemCreate(interp, canvasPtr, typePtr, 0, &itemPtr, 
+		    n, objv2) != TCL_OK) {
+		
+		/*
+		 * All or nothing: remove what we made so far, last first
+		 * in case any of them are groups parenting the others.
+		 */
+		while (i-- > 0) {
+		    ItemDelete(canvasPtr, itemsPtr[i]);
+		}
+		ckfree((char *) itemsPtr);
+		ckfree((char *) objv2);
+		result = TCL_ERROR;
+		goto done;
+	    }
+	    
+	    /*
+	     * Collect the union bbox instead of registering each item.
+	     */
+	    itemPtr->redraw_flags &= ~FORCE_REDRAW;
+	    if ((itemPtr->x1 < itemPtr->x2) && (itemPtr->y1 < itemPtr->y2)) {
+		if (gotAny) {
+		    x1 = MIN(x1, itemPtr->x1);
+		    y1 = MIN(y1, itemPtr->y1);
+		    x2 = MAX(x2, itemPtr->x2);
+		    y2 = MAX(y2, itemPtr->y2);
+		} else {
+		    x1 = itemPtr->x1;
+		    y1 = itemPtr->y1;
+		    x2 = itemPtr->x2;
+		    y2 = itemPtr->y2;
+		    gotAny = 1;
+		}
+	    }
+	    TkPathCanvasGroupChildChanged(itemPtr);
+	    if (itemPtr->typePtr->alwaysRedraw & 1) {
+		EventuallyRedrawItem((Tk_PathCanvas) canvasPtr, itemPtr);
+	    }
+	    canvasPtr->hotPtr = itemPtr;
+	    canvasPtr->hotPrevPtr = itemPtr->prevPtr;
+	    itemsPtr[i] = itemPtr;
+	}
+	listObj = Tcl_NewListObj(0, NULL);
+	for (i = 0; i < numSpecs; i++) {
+	    Tcl_ListObjAppendElement(NULL, listObj, 
+		    Tcl_NewIntObj(itemsPtr[i]->id));
+	}
+	ckfree((char *) itemsPtr);
+	ckfree((char *) objv2);
+	if (gotAny) {
+	    Tk_PathCanvasEventuallyRedraw((Tk_PathCanvas) canvasPtr, 
+		    x1, y1, x2, y2);
+	}
+	canvasPtr->flags |= REPICK_NEEDED;
+	Tcl_SetObjResult(interp, listObj);
+	break;
+    }
     case CANV_DCHARS: {
 	int first, last;
 	int x1,x2,y1,y2;
@@ -1212,28 +1438,74 @@ CanvasWidgetCmd(
 	break;
     }
     case CANV_DELETE: {
-	int i;
+	Tk_PathItem **itemsPtr = NULL, *walkPtr;
+	int i, j, numItems = 0, numAlloc = 0;
+	int area[4];
+	
+	if ((objc == 3) && (strcmp(Tcl_GetString(objv[2]), "all") == 0)) {
+	    DeleteAllItems(canvasPtr);
+	    break;
+	}
 	
 	/*
-	 * Since deletinga group item implicitly deletes all its children
+	 * Since deleting a group item implicitly deletes all its children
 	 * we may unintentionally try to delete an item more than once.
-	 * We therefore flatten (parent = root) all items first.
+	 * We therefore first collect the matching items and mark them,
+	 * and then delete only those which have no marked ancestor.
 	 */
 	for (i = 2; i < objc; i++) {
-	    FOR_EVERY_CANVAS_ITEM_MATCHING(objv[i], &searchPtr, goto done) {
+	    FOR_EVERY_CANVAS_ITEM_MATCHING(objv[i], &searchPtr, break) {
 	    
-	    /*
-	     * Silently ignoring the root item.
-	    */
-		if (itemPtr->id == 0) continue;
-		
 		/*
-		 * This will also delete all its descendants by 
-		 * recursive calls.
+		 * Silently ignoring the root item.
 		 */
-		ItemDelete(canvasPtr, itemPtr);
+		if ((itemPtr->id == 0) 
+			|| (itemPtr->redraw_flags & DELETE_PENDING)) {
+		    continue;
+		}
+		if (numItems == numAlloc) {
+		    numAlloc = MAX(2 * numAlloc, 16);
+		    itemsPtr = (Tk_PathItem **) ckrealloc((char *) itemsPtr, 
+			    (unsigned) numAlloc * sizeof(Tk_PathItem *));
+		}
+		itemPtr->redraw_flags |= DELETE_PENDING;
+		itemsPtr[numItems++] = itemPtr;
+	    }
+	    if (result != TCL_OK) {
+		break;
+	    }
+	}
+	if (result != TCL_OK) {
+	    for (i = 0; i < numItems; i++) {
+		itemsPtr[i]->redraw_flags &= ~DELETE_PENDING;
+	    }
+	    if (itemsPtr != NULL) {
+		ckfree((char *) itemsPtr);
+	    }
+	    goto done;
+	}
+	for (i = 0, j = 0; i < numItems; i++) {
+	    for (walkPtr = itemsPtr[i]->parentPtr; walkPtr != NULL; 
+		    walkPtr = walkPtr->parentPtr) {
+		if (walkPtr->redraw_flags & DELETE_PENDING) {
+		    break;
+		}
+	    }
+	    if (walkPtr == NULL) {
+		itemsPtr[j++] = itemsPtr[i];
 	    }
 	}
+	area[0] = area[1] = area[2] = area[3] = 0;
+	for (i = 0; i < j; i++) {
+	    itemPtr = itemsPtr[i];
+	    TkPathCanvasItemDetach(itemPtr);
+	    ItemDeleteTree(canvasPtr, itemPtr, area);
+	}
+	if (itemsPtr != NULL) {
+	    ckfree((char *) itemsPtr);
+	}
+	Tk_PathCanvasEventuallyRedraw((Tk_PathCanvas) canvasPtr,
+		area[0], area[1], area[2], area[3]);
 	break;
     }
     case CANV_DEPTH: {
@@ -1254,25 +1526,51 @@ CanvasWidgetCmd(
     }
     case CANV_DISTANCE: {
 	double point[2], dist;
+	double *points = NULL;
+	int numPoints = 0;
 	
-    	if (objc != 5) {
-	    Tcl_WrongNumArgs(interp, 2, objv, "tagOrId x y");
+    	if ((objc != 4) && (objc != 5)) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "tagOrId x y | tagOrId coordList");
 	    result = TCL_ERROR;
 	    goto done;
 	}
-	if ((Tcl_GetDoubleFromObj(interp, objv[3], &point[0]) != TCL_OK) ||
+	if (objc == 4) {
+	    if (GetPointsFromObj(interp, objv[3], &points, &numPoints) != TCL_OK) {
+		result = TCL_ERROR;
+		goto done;
+	    }
+	} else if ((Tcl_GetDoubleFromObj(interp, objv[3], &point[0]) != TCL_OK) ||
 		(Tcl_GetDoubleFromObj(interp, objv[4], &point[1]) != TCL_OK)) {
 	    result = TCL_ERROR;
 	    goto done;
 	}
-	FIRST_CANVAS_ITEM_MATCHING(objv[2], &searchPtr, goto done);
-	if (itemPtr != NULL) {
+	FIRST_CANVAS_ITEM_MATCHING(objv[2], &searchPtr, 
+		if (points != NULL) ckfree((char *) points); goto done);
+	if (itemPtr != NULL && objc == 4) {
+	    Tcl_Obj *listObj = Tcl_NewListObj(0, NULL);
+	    int i;
+
+	    /*
+	     * Batch variant: one distance per point of the coordinate list.
+	     */
+
+	    for (i = 0; i < numPoints; i++) {
+		HIT_STATS(canvasPtr);
+		dist = (*itemPtr->typePtr->pointProc)((Tk_PathCanvas) canvasPtr,
+			itemPtr, points + 2*i);
+		Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewDoubleObj(dist));
+	    }
+	    Tcl_SetObjResult(interp, listObj);
+	} else if (itemPtr != NULL) {
+	    HIT_STATS(canvasPtr);
 	    dist = (*itemPtr->typePtr->pointProc)((Tk_PathCanvas) canvasPtr, itemPtr, point);
 	    Tcl_SetObjResult(interp, Tcl_NewDoubleObj(dist));
 	} else {
 	    Tcl_AppendResult(interp, "tag \"", Tcl_GetString(objv[2]),
 		    "\" doesn't match any items", NULL);
-	    goto done;
+	}
+	if (points != NULL) {
+	    ckfree((char *) points);
 	}
 	break;
     }
@@ -1576,6 +1874,10 @@ CanvasWidgetCmd(
 	}	
 	break;
     }
+    case CANV_LOAD: {
+	result = TkPathCanvasLoadCmd(canvasPtr, interp, objc, objv);
+	break;
+    }
     case CANV_LOWER: {
 	Tk_PathItem *itemPtr;
 
@@ -1607,6 +1909,83 @@ CanvasWidgetCmd(
 #endif /* USE_OLD_TAG_SEARCH */
 	break;
     }
+    case CANV_MEMORY: {
+	Tk_PathItemType *typePtr;
+	Tk_PathItem *walkPtr;
+	Tcl_Obj *listObj;
+	Tcl_HashTable countTable;
+	Tcl_HashEntry *hPtr;
+	int count, isNew;
+
+	/*
+	 * Reports the item record size of each item type in use as
+	 * 'type count bytesPerItem'. Memory owned by the items
+	 * outside their records, such as coords, is not included.
+	 * With 'pools' the slot statistics of the slab pools instead.
+	 */
+	if ((objc != 2) && (objc != 3)) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "?pools?");
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	listObj = Tcl_NewListObj(0, NULL);
+	if (objc == 3) {
+	    Tcl_Obj *statsObj;
+	    
+	    if (strcmp(Tcl_GetString(objv[2]), "pools") != 0) {
+		Tcl_DecrRefCount(listObj);
+		Tcl_AppendResult(interp, "bad option \"", 
+			Tcl_GetString(objv[2]), "\": must be pools", NULL);
+		result = TCL_ERROR;
+		goto done;
+	    }
+	    Tcl_ListObjAppendElement(interp, listObj, Tcl_NewStringObj("items", -1));
+	    statsObj = Tcl_NewListObj(0, NULL);
+	    TkPathPoolStats(canvasPtr->itemPoolPtr, statsObj);
+	    Tcl_ListObjAppendElement(interp, listObj, statsObj);
+	    Tcl_ListObjAppendElement(interp, listObj, Tcl_NewStringObj("atoms", -1));
+	    statsObj = Tcl_NewListObj(0, NULL);
+	    TkPathPoolStats(TkPathAtomPool(), statsObj);
+	    Tcl_ListObjAppendElement(interp, listObj, statsObj);
+	    Tcl_ListObjAppendElement(interp, listObj, Tcl_NewStringObj("tags", -1));
+	    statsObj = Tcl_NewListObj(0, NULL);
+	    TkPathPoolStats(TkPathTagPool(), statsObj);
+	    Tcl_ListObjAppendElement(interp, listObj, statsObj);
+	    Tcl_SetObjResult(interp, listObj);
+	    break;
+	}
+
+	/*
+	 * Count the items of each type in one walk, then report them in
+	 * the order of the type list.
+	 */
+
+	Tcl_InitHashTable(&countTable, TCL_ONE_WORD_KEYS);
+	for (walkPtr = canvasPtr->rootItemPtr->firstChildPtr; walkPtr != NULL;
+		walkPtr = TkPathCanvasItemIteratorNext(walkPtr)) {
+	    hPtr = Tcl_CreateHashEntry(&countTable, (char *) walkPtr->typePtr,
+		    &isNew);
+	    count = isNew ? 0 : PTR2INT(Tcl_GetHashValue(hPtr));
+	    Tcl_SetHashValue(hPtr, INT2PTR(count + 1));
+	}
+	Tcl_MutexLock(&typeListMutex);
+	for (typePtr = typeList; typePtr != NULL; 
+		typePtr = typePtr->nextPtr) {
+	    hPtr = Tcl_FindHashEntry(&countTable, (char *) typePtr);
+	    if (hPtr != NULL) {
+		Tcl_ListObjAppendElement(interp, listObj, 
+			Tcl_NewStringObj(typePtr->name, -1));
+		Tcl_ListObjAppendElement(interp, listObj,
+			Tcl_NewIntObj(PTR2INT(Tcl_GetHashValue(hPtr))));
+		Tcl_ListObjAppendElement(interp, listObj, 
+			Tcl_NewIntObj(typePtr->itemSize));
+	    }
+	}
+	Tcl_MutexUnlock(&typeListMutex);
+	Tcl_DeleteHashTable(&countTable);
+	Tcl_SetObjResult(interp, listObj);
+	break;
+    }
     case CANV_MOVE: {
 	double xAmount, yAmount;
 
@@ -1736,6 +2115,10 @@ CanvasWidgetCmd(
 #endif /* USE_OLD_TAG_SEARCH */
 	break;
     }
+    case CANV_SAVE: {
+	result = TkPathCanvasSaveCmd(canvasPtr, interp, objc, objv);
+	break;
+    }
     case CANV_SCALE: {
 	double xOrigin, yOrigin, xScale, yScale;
 
@@ -1916,10 +2299,26 @@ CanvasWidgetCmd(
 	}
 	break;
     }
+    case CANV_SNAPSHOT: {
+	result = CanvasSnapshot(interp, canvasPtr, objc, objv);
+	break;
+    }
+    case CANV_STATS: {
+	result = TkPathCanvasStatsCmd(canvasPtr, interp, objc, objv);
+	break;
+    }
     case CANV_STYLE: {
 	result = CanvasStyleObjCmd(interp, canvasPtr, objc, objv);
 	break;
     }
+    case CANV_SVG: {
+	result = TkCanvSvgCmd(canvasPtr, interp, objc, objv);
+	break;
+    }
+    case CANV_SYMBOL: {
+	result = TkPathCanvasSymbolCmd(canvasPtr, interp, objc, objv);
+	break;
+    }
     case CANV_TYPE: {
 	if (objc != 3) {
 	    Tcl_WrongNumArgs(interp, 2, objv, "tag");
@@ -2081,6 +2480,8 @@ DestroyCanvas(
     Tk_PathItem *itemPtr, *prevItemPtr, *lastPtr = NULL;
 #ifndef USE_OLD_TAG_SEARCH
     TagSearchExpr *expr, *next;
+    Tcl_HashEntry *hPtr;
+    Tcl_HashSearch search;
 #endif
 
     /*
@@ -2097,9 +2498,12 @@ DestroyCanvas(
         prevItemPtr = TkPathCanvasItemIteratorPrev(itemPtr);
 	(*itemPtr->typePtr->deleteProc)((Tk_PathCanvas) canvasPtr, itemPtr,
 		canvasPtr->display);
-	ckfree((char *) itemPtr);
         itemPtr = prevItemPtr;
     }
+    
+    /* The item records go all at once. */
+    TkPathPoolDestroy(canvasPtr->itemPoolPtr);
+    canvasPtr->itemPoolPtr = NULL;
 
     /*
      * Free up all the stuff that requires special handling, then let
@@ -2114,6 +2518,8 @@ DestroyCanvas(
     
     CanvasGradientsFree(canvasPtr);
     Tcl_DeleteHashTable(&canvasPtr->gradientTable);
+    TkPathCanvasSymbolsFree(canvasPtr);
+    Tcl_DeleteHashTable(&canvasPtr->symbolTable);
     
     if (canvasPtr->pixmapGC != None) {
 	Tk_FreeGC(canvasPtr->display, canvasPtr->pixmapGC);
@@ -2125,7 +2531,19 @@ DestroyCanvas(
 	TagSearchExprDestroy(expr);
 	expr = next;
     }
+    for (hPtr = Tcl_FirstHashEntry(&canvasPtr->exprMatchTable, &search);
+	    hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	FreeTagExprMatches((TagExprMatches *) Tcl_GetHashValue(hPtr));
+    }
+    Tcl_DeleteHashTable(&canvasPtr->exprMatchTable);
+    TagSearchExprCacheFlush(canvasPtr);
+    Tcl_DeleteHashTable(&canvasPtr->exprCacheTable);
 #endif /* USE_OLD_TAG_SEARCH */
+    TkPathCanvasStatsFree(canvasPtr);
+    TkPathCanvasAnimateFree(canvasPtr);
+    if (canvasPtr->bufferPtr != NULL) {
+	TkPathBufferFree(canvasPtr->bufferPtr);
+    }
     Tcl_DeleteTimerHandler(canvasPtr->insertBlinkHandler);
     if (canvasPtr->bindingTable != NULL) {
 	Tk_DeleteBindingTable(canvasPtr->bindingTable);
@@ -2206,6 +2624,14 @@ ConfigureCanvas(
 	     */
 	    return TCL_ERROR;
 	}
+	if (canvasPtr->maxFps < 0) {
+	    char buf[TCL_INTEGER_SPACE];
+
+	    sprintf(buf, "%d", canvasPtr->maxFps);
+	    Tcl_AppendResult(interp, "bad -maxfps value \"", buf,
+		    "\": must be non-negative", NULL);
+	    continue;
+	}
    
 	/*
 	 * Recompute the scroll region.
@@ -2403,10 +2829,15 @@ DisplayCanvas(
     Pixmap pixmap;
     int screenX1, screenX2, screenY1, screenY2, width, height;
     int flags;
+    TkPathCanvasStats *statsPtr;
+    int visited = 0, drawn = 0, buffered = 0;
+    Tcl_Time frameStart;
 
     if (canvasPtr->flags & CANVAS_DELETED) {
 	return;
     }
+    canvasPtr->frameTimer = NULL;
+    Tcl_GetTime(&frameStart);
     if (!Tk_IsMapped(tkwin)) {
 	goto done;
     }
@@ -2471,6 +2902,10 @@ DisplayCanvas(
 
 	width = screenX2 - screenX1;
 	height = screenY2 - screenY1;
+	statsPtr = canvasPtr->statsPtr;
+	if (statsPtr != NULL) {
+	    TkPathStatsBeginFrame(canvasPtr);
+	}
 
 #ifndef TK_PATH_NO_DOUBLE_BUFFERING
 	/*
@@ -2507,6 +2942,9 @@ DisplayCanvas(
 	    (screenX2 + 30 - canvasPtr->drawableXOrigin),
 	    (screenY2 + 30 - canvasPtr->drawableYOrigin),
 	    Tk_Depth(tkwin));
+	if (statsPtr != NULL) {
+	    statsPtr->pixmaps++;
+	}
 #else
 	canvasPtr->drawableXOrigin = canvasPtr->xOrigin;
 	canvasPtr->drawableYOrigin = canvasPtr->yOrigin;
@@ -2525,6 +2963,28 @@ DisplayCanvas(
 		screenY1 - canvasPtr->drawableYOrigin, (unsigned int) width,
 		(unsigned int) height);
 
+#ifndef TK_PATH_NO_DOUBLE_BUFFERING
+	/*
+	 * With -shm the tkpath items are rendered client side into a shared
+	 * memory image instead, which is put on the screen at the end. Tk
+	 * items still draw into the pixmap, see TkPathBufferSync below.
+	 */
+
+	if (canvasPtr->shm && !canvasPtr->bufferFailed) {
+	    if (canvasPtr->bufferPtr == NULL) {
+		canvasPtr->bufferPtr = TkPathBufferNew(tkwin);
+		canvasPtr->bufferFailed = (canvasPtr->bufferPtr == NULL);
+	    }
+	    if (canvasPtr->bufferPtr != NULL) {
+		buffered = TkPathBufferBegin(canvasPtr->bufferPtr, pixmap,
+			canvasPtr->pixmapGC,
+			screenX2 + 30 - canvasPtr->drawableXOrigin,
+			screenY2 + 30 - canvasPtr->drawableYOrigin,
+			Tk_3DBorderColor(canvasPtr->bgBorder)->pixel);
+	    }
+	}
+#endif /* TK_PATH_NO_DOUBLE_BUFFERING */
+
 	/*
 	 * Scan through the item list, redrawing those items that need it. An
 	 * item must be redraw if either (a) it intersects the smaller
@@ -2535,6 +2995,7 @@ DisplayCanvas(
 
 	for (itemPtr = canvasPtr->rootItemPtr; itemPtr != NULL;
 		itemPtr = TkPathCanvasItemIteratorNext(itemPtr)) {
+	    visited++;
 	    if ((itemPtr->x1 >= screenX2)
 		    || (itemPtr->y1 >= screenY2)
 		    || (itemPtr->x2 < screenX1)
@@ -2552,9 +3013,24 @@ DisplayCanvas(
 		 canvasPtr->canvas_state == TK_PATHSTATE_HIDDEN)) {
 		continue;
 	    }
-	    (*itemPtr->typePtr->displayProc)((Tk_PathCanvas) canvasPtr, itemPtr,
-		    canvasPtr->display, pixmap, screenX1, screenY1, width,
-		    height);
+	    drawn++;
+	    if (buffered && !TkPathCanvasIsPathItem(itemPtr)) {
+		TkPathBufferSync(canvasPtr->bufferPtr);
+	    }
+	    if (statsPtr != NULL) {
+		Tcl_Time start;
+
+		Tcl_GetTime(&start);
+		(*itemPtr->typePtr->displayProc)((Tk_PathCanvas) canvasPtr,
+			itemPtr, canvasPtr->display, pixmap, screenX1, screenY1,
+			width, height);
+		TkPathStatsAddTime(TkPathStatsTypeTime(statsPtr,
+			itemPtr->typePtr), &start);
+	    } else {
+		(*itemPtr->typePtr->displayProc)((Tk_PathCanvas) canvasPtr,
+			itemPtr, canvasPtr->display, pixmap, screenX1, screenY1,
+			width, height);
+	    }
 	}
 
 #ifndef TK_PATH_NO_DOUBLE_BUFFERING
@@ -2563,16 +3039,28 @@ DisplayCanvas(
 	 * temporary pixmap.
 	 */
 
-	XCopyArea(Tk_Display(tkwin), pixmap, Tk_WindowId(tkwin),
-		canvasPtr->pixmapGC,
-		screenX1 - canvasPtr->drawableXOrigin,
-		screenY1 - canvasPtr->drawableYOrigin,
-		(unsigned int) width, (unsigned int) height,
-		screenX1 - canvasPtr->xOrigin, screenY1 - canvasPtr->yOrigin);
+	if (buffered) {
+	    TkPathBufferEnd(canvasPtr->bufferPtr, Tk_WindowId(tkwin),
+		    canvasPtr->pixmapGC,
+		    screenX1 - canvasPtr->drawableXOrigin,
+		    screenY1 - canvasPtr->drawableYOrigin, width, height,
+		    screenX1 - canvasPtr->xOrigin, screenY1 - canvasPtr->yOrigin);
+	} else {
+	    XCopyArea(Tk_Display(tkwin), pixmap, Tk_WindowId(tkwin),
+		    canvasPtr->pixmapGC,
+		    screenX1 - canvasPtr->drawableXOrigin,
+		    screenY1 - canvasPtr->drawableYOrigin,
+		    (unsigned int) width, (unsigned int) height,
+		    screenX1 - canvasPtr->xOrigin, screenY1 - canvasPtr->yOrigin);
+	}
 	Tk_FreePixmap(Tk_Display(tkwin), pixmap);
 #else
 	TkpClipDrawableToRect(Tk_Display(tkwin), pixmap, 0, 0, -1, -1);
 #endif /* TK_PATH_NO_DOUBLE_BUFFERING */
+	if (statsPtr != NULL) {
+	    TkPathStatsEndFrame(canvasPtr, visited, drawn,
+		    (Tcl_WideInt) width * height);
+	}
     }
 
     /*
@@ -2611,6 +3099,29 @@ DisplayCanvas(
     canvasPtr->flags &= ~(REDRAW_PENDING|BBOX_NOT_EMPTY);
     canvasPtr->redrawX1 = canvasPtr->redrawX2 = 0;
     canvasPtr->redrawY1 = canvasPtr->redrawY2 = 0;
+    if (canvasPtr->maxFps > 0) {
+	Tcl_Time now;
+	long budget, elapsed;
+
+	/*
+	 * The next frame is due one frame budget after this one started.
+	 * A frame that overran its budget is followed by an equally long
+	 * pause so that input is not starved by redraws.
+	 */
+
+	Tcl_GetTime(&now);
+	budget = 1000000 / canvasPtr->maxFps;
+	elapsed = (now.sec - frameStart.sec) * 1000000
+		+ (now.usec - frameStart.usec);
+	if (elapsed <= budget) {
+	    now = frameStart;
+	    elapsed = budget;
+	}
+	now.usec += elapsed;
+	now.sec += now.usec / 1000000;
+	now.usec %= 1000000;
+	canvasPtr->nextFrame = now;
+    }
     if (canvasPtr->flags & UPDATE_SCROLLBARS) {
 	CanvasUpdateScrollbars(canvasPtr);
     }
@@ -2619,32 +3130,496 @@ DisplayCanvas(
 /*
  *--------------------------------------------------------------
  *
- * CanvasEventProc --
+ * ScheduleRedraw --
  *
- *	This function is invoked by the Tk dispatcher for various events on
- *	canvases.
+ *	Arranges for DisplayCanvas to be called unless it already is.
+ *	Without -maxfps it runs at the next idle time. Else it waits for
+ *	the frame time set by the previous redraw, and all damage that
+ *	arrives until then is drawn in one go.
  *
  * Results:
  *	None.
  *
  * Side effects:
- *	When the window gets deleted, internal structures get cleaned up.
- *	When it gets exposed, it is redisplayed.
+ *	An idle or timer handler may be created.
  *
  *--------------------------------------------------------------
  */
 
 static void
-CanvasEventProc(
-    ClientData clientData,	/* Information about window. */
-    XEvent *eventPtr)		/* Information about event. */
+ScheduleRedraw(
+    TkPathCanvas *canvasPtr)
 {
-    TkPathCanvas *canvasPtr = (TkPathCanvas *) clientData;
+    Tcl_Time now;
+    long delay;
 
-    if (eventPtr->type == Expose) {
-	int x, y;
-
-	x = eventPtr->xexpose.x + canvasPtr->xOrigin;
+    if (canvasPtr->flags & REDRAW_PENDING) {
+	return;
+    }
+    canvasPtr->flags |= REDRAW_PENDING;
+    if (canvasPtr->maxFps > 0) {
+	Tcl_GetTime(&now);
+	delay = (canvasPtr->nextFrame.sec - now.sec) * 1000
+		+ (canvasPtr->nextFrame.usec - now.usec) / 1000;
+	if (delay > 0) {
+	    canvasPtr->frameTimer = Tcl_CreateTimerHandler((int) delay,
+		    FrameTimerProc, (ClientData) canvasPtr);
+	    return;
+	}
+    }
+    Tcl_DoWhenIdle(DisplayCanvas, (ClientData) canvasPtr);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * FrameTimerProc --
+ *
+ *	Starts a paced frame. The redraw itself is still done when idle
+ *	so that pending events are handled first.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	DisplayCanvas is scheduled.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+FrameTimerProc(
+    ClientData clientData)
+{
+    TkPathCanvas *canvasPtr = (TkPathCanvas *) clientData;
+
+    canvasPtr->frameTimer = NULL;
+    Tcl_DoWhenIdle(DisplayCanvas, clientData);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathCanvasIsPathItem --
+ *
+ *	Tells the tkpath items from the standard Tk items, which draw
+ *	with Xlib and have no Tk_PathStyle.
+ *
+ * Results:
+ *	1 for tkpath items, 0 else.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkPathCanvasIsPathItem(
+    Tk_PathItem *itemPtr)
+{
+    Tk_PathItemType *typePtr = itemPtr->typePtr;
+
+    return !((typePtr == &tkArcType) || (typePtr == &tkBitmapType)
+	    || (typePtr == &tkImageType) || (typePtr == &tkLineType)
+	    || (typePtr == &tkOvalType) || (typePtr == &tkPolygonType)
+	    || (typePtr == &tkRectangleType) || (typePtr == &tkTextType)
+	    || (typePtr == &tkWindowType));
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathCanvasGetRegion --
+ *
+ *	Parses the -region option of the commands that render the canvas
+ *	off-screen. Without a region the scroll region is used if set and
+ *	else the bounding box of all items.
+ *
+ * Results:
+ *	A standard Tcl result. The region is left in region as x1 y1 x2 y2
+ *	in canvas coordinates.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkPathCanvasGetRegion(
+    Tcl_Interp *interp,
+    TkPathCanvas *canvasPtr,
+    Tcl_Obj *regionObj,		/* List {x1 y1 x2 y2} or NULL. */
+    int region[4])
+{
+    Tcl_Obj **objv;
+    double coords[4];
+    int i, objc;
+
+    if (regionObj != NULL) {
+	if (Tcl_ListObjGetElements(interp, regionObj, &objc, &objv)
+		!= TCL_OK) {
+	    return TCL_ERROR;
+	}
+	if (objc != 4) {
+	    Tcl_AppendResult(interp, "region must have four coordinates", NULL);
+	    return TCL_ERROR;
+	}
+	for (i = 0; i < 4; i++) {
+	    if (Tk_PathCanvasGetCoordFromObj(interp, (Tk_PathCanvas) canvasPtr,
+		    objv[i], &coords[i]) != TCL_OK) {
+		return TCL_ERROR;
+	    }
+	}
+	region[0] = (int) floor(coords[0]), region[1] = (int) floor(coords[1]);
+	region[2] = (int) ceil(coords[2]), region[3] = (int) ceil(coords[3]);
+    } else if (canvasPtr->regionString != NULL) {
+	region[0] = canvasPtr->scrollX1, region[1] = canvasPtr->scrollY1;
+	region[2] = canvasPtr->scrollX2, region[3] = canvasPtr->scrollY2;
+    } else {
+	TkPathCanvasGroupBbox((Tk_PathCanvas) canvasPtr,
+		canvasPtr->rootItemPtr, &region[0], &region[1],
+		&region[2], &region[3]);
+    }
+    if ((region[0] >= region[2]) || (region[1] >= region[3])) {
+	Tcl_AppendResult(interp, "region is empty", NULL);
+	return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * CanvasSnapshot --
+ *
+ *	This function implements the "snapshot" widget command. The items
+ *	within the region are drawn by their displayProcs into an off-screen
+ *	pixmap, as DisplayCanvas does, which is then read back into a photo
+ *	image or written to a file through one. The window need not be
+ *	mapped.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	The photo is resized and overwritten, or the file is written.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+CanvasSnapshot(
+    Tcl_Interp *interp,
+    TkPathCanvas *canvasPtr,
+    int objc,
+    Tcl_Obj *CONST objv[])
+{
+    static CONST char *snapOptions[] = {
+	"-file", "-format", "-region", "-scale", NULL
+    };
+    enum {
+	SNAP_FILE, SNAP_FORMAT, SNAP_REGION, SNAP_SCALE
+    };
+    Tk_Window tkwin = canvasPtr->tkwin;
+    Tk_PathItem *itemPtr;
+    Tcl_Obj *photoObj = NULL, *fileObj = NULL, *formatObj = NULL;
+    Tcl_Obj *regionObj = NULL;
+    Tk_PhotoHandle photo = NULL;
+    Tk_PhotoImageBlock block;
+    Pixmap pixmap;
+    XImage *ximage;
+    Visual *visual;
+    unsigned long masks[3];
+    int shifts[3];
+    double scale = 1.0;
+    int region[4], x1, y1, x2, y2, width, height;
+    int saveX, saveY, i, j, k, index, buffered = 0;
+    int result = TCL_OK;
+    unsigned char *p;
+    double saveScale;
+
+    for (i = 2; i < objc; i++) {
+	if ((i == objc-1) && (Tcl_GetString(objv[i])[0] != '-')) {
+	    photoObj = objv[i];
+	    break;
+	}
+	if (Tcl_GetIndexFromObj(interp, objv[i], snapOptions, "option", 0,
+		&index) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	if (i+1 >= objc) {
+	    Tcl_AppendResult(interp, "value for \"", Tcl_GetString(objv[i]),
+		    "\" missing", NULL);
+	    return TCL_ERROR;
+	}
+	i++;
+	switch (index) {
+	case SNAP_FILE:
+	    fileObj = objv[i];
+	    break;
+	case SNAP_FORMAT:
+	    formatObj = objv[i];
+	    break;
+	case SNAP_REGION:
+	    regionObj = objv[i];
+	    break;
+	case SNAP_SCALE:
+	    if (Tcl_GetDoubleFromObj(interp, objv[i], &scale) != TCL_OK) {
+		return TCL_ERROR;
+	    }
+	    if (scale <= 0.0) {
+		Tcl_AppendResult(interp, "scale must be positive", NULL);
+		return TCL_ERROR;
+	    }
+	    break;
+	}
+    }
+    if ((photoObj == NULL) == (fileObj == NULL)) {
+	Tcl_WrongNumArgs(interp, 2, objv,
+		"?-region {x1 y1 x2 y2}? ?-scale s? photo|-file name ?-format fmt?");
+	return TCL_ERROR;
+    }
+    if (photoObj != NULL) {
+	photo = Tk_FindPhoto(interp, Tcl_GetString(photoObj));
+	if (photo == NULL) {
+	    Tcl_AppendResult(interp, "image \"", Tcl_GetString(photoObj),
+		    "\" doesn't exist or is not a photo image", NULL);
+	    return TCL_ERROR;
+	}
+    }
+
+    if (TkPathCanvasGetRegion(interp, canvasPtr, regionObj, region)
+	    != TCL_OK) {
+	return TCL_ERROR;
+    }
+    x1 = region[0], y1 = region[1];
+    x2 = region[2], y2 = region[3];
+    width = (int) ceil((x2 - x1) * scale);
+    height = (int) ceil((y2 - y1) * scale);
+
+    /*
+     * The tkpath items, ptext and pimage included, draw through the
+     * matrix of GetCanvasTMatrix and so follow the scale. The standard
+     * Tk items draw with Xlib at their own size and can't be scaled.
+     */
+
+    if (scale != 1.0) {
+	for (itemPtr = canvasPtr->rootItemPtr; itemPtr != NULL;
+		itemPtr = TkPathCanvasItemIteratorNext(itemPtr)) {
+	    if ((itemPtr->x1 >= x2) || (itemPtr->y1 >= y2)
+		    || (itemPtr->x2 < x1) || (itemPtr->y2 < y1)) {
+		continue;
+	    }
+	    if (itemPtr->state == TK_PATHSTATE_HIDDEN ||
+		(itemPtr->state == TK_PATHSTATE_NULL &&
+		 canvasPtr->canvas_state == TK_PATHSTATE_HIDDEN)) {
+		continue;
+	    }
+	    if (!TkPathCanvasIsPathItem(itemPtr)) {
+		char buf[TCL_INTEGER_SPACE];
+
+		sprintf(buf, "%d", itemPtr->id);
+		Tcl_AppendResult(interp, "can't scale item ", buf, ": ",
+			itemPtr->typePtr->name,
+			" items can only be drawn at scale 1", NULL);
+		return TCL_ERROR;
+	    }
+	}
+    }
+
+    Tk_MakeWindowExist(tkwin);
+    visual = Tk_Visual(tkwin);
+    if ((visual->class != TrueColor) && (visual->class != DirectColor)) {
+	Tcl_AppendResult(interp, "snapshot needs a TrueColor visual", NULL);
+	return TCL_ERROR;
+    }
+
+    /*
+     * Draw the items in the same way as DisplayCanvas does, with the
+     * drawable origin at the region's corner.
+     */
+
+    pixmap = Tk_GetPixmap(Tk_Display(tkwin), Tk_WindowId(tkwin),
+	    width, height, Tk_Depth(tkwin));
+    saveX = canvasPtr->drawableXOrigin;
+    saveY = canvasPtr->drawableYOrigin;
+    saveScale = canvasPtr->drawableScale;
+    canvasPtr->drawableXOrigin = x1;
+    canvasPtr->drawableYOrigin = y1;
+    canvasPtr->drawableScale = scale;
+    XFillRectangle(Tk_Display(tkwin), pixmap, canvasPtr->pixmapGC,
+	    0, 0, (unsigned int) width, (unsigned int) height);
+    if (canvasPtr->shm && !canvasPtr->bufferFailed) {
+	if (canvasPtr->bufferPtr == NULL) {
+	    canvasPtr->bufferPtr = TkPathBufferNew(tkwin);
+	    canvasPtr->bufferFailed = (canvasPtr->bufferPtr == NULL);
+	}
+	if (canvasPtr->bufferPtr != NULL) {
+	    buffered = TkPathBufferBegin(canvasPtr->bufferPtr, pixmap,
+		    canvasPtr->pixmapGC, width, height,
+		    Tk_3DBorderColor(canvasPtr->bgBorder)->pixel);
+	}
+    }
+
+    for (itemPtr = canvasPtr->rootItemPtr; itemPtr != NULL;
+	    itemPtr = TkPathCanvasItemIteratorNext(itemPtr)) {
+	if ((itemPtr->x1 >= x2) || (itemPtr->y1 >= y2)
+		|| (itemPtr->x2 < x1) || (itemPtr->y2 < y1)) {
+	    continue;
+	}
+	if (itemPtr->state == TK_PATHSTATE_HIDDEN ||
+	    (itemPtr->state == TK_PATHSTATE_NULL &&
+	     canvasPtr->canvas_state == TK_PATHSTATE_HIDDEN)) {
+	    continue;
+	}
+	if (buffered && !TkPathCanvasIsPathItem(itemPtr)) {
+	    TkPathBufferSync(canvasPtr->bufferPtr);
+	}
+	(*itemPtr->typePtr->displayProc)((Tk_PathCanvas) canvasPtr, itemPtr,
+		canvasPtr->display, pixmap, x1, y1, x2 - x1, y2 - y1);
+    }
+    if (buffered) {
+	TkPathBufferEnd(canvasPtr->bufferPtr, pixmap, canvasPtr->pixmapGC,
+		0, 0, width, height, 0, 0);
+    }
+    canvasPtr->drawableXOrigin = saveX;
+    canvasPtr->drawableYOrigin = saveY;
+    canvasPtr->drawableScale = saveScale;
+
+    ximage = XGetImage(Tk_Display(tkwin), pixmap, 0, 0,
+	    (unsigned int) width, (unsigned int) height, AllPlanes, ZPixmap);
+    Tk_FreePixmap(Tk_Display(tkwin), pixmap);
+    if (ximage == NULL) {
+	Tcl_AppendResult(interp, "failed reading back the snapshot", NULL);
+	return TCL_ERROR;
+    }
+
+    /*
+     * Convert the pixels to RGBA using the masks of the visual.
+     */
+
+    masks[0] = visual->red_mask;
+    masks[1] = visual->green_mask;
+    masks[2] = visual->blue_mask;
+    for (k = 0; k < 3; k++) {
+	for (shifts[k] = 0; (shifts[k] < 32) && !((masks[k] >> shifts[k]) & 1);
+		shifts[k]++) {
+	    /* Empty loop body. */
+	}
+    }
+    block.width = width;
+    block.height = height;
+    block.pixelSize = 4;
+    block.pitch = 4 * width;
+    block.offset[0] = 0;
+    block.offset[1] = 1;
+    block.offset[2] = 2;
+    block.offset[3] = 3;
+    block.pixelPtr = (unsigned char *) ckalloc((unsigned) (4*width*height));
+    p = block.pixelPtr;
+    for (j = 0; j < height; j++) {
+	for (i = 0; i < width; i++) {
+	    unsigned long pixel = XGetPixel(ximage, i, j);
+
+	    for (k = 0; k < 3; k++) {
+		unsigned long max = masks[k] >> shifts[k];
+
+		*p++ = (max == 0) ? 0 :
+			(unsigned char) (((pixel & masks[k]) >> shifts[k])*255/max);
+	    }
+	    *p++ = 255;
+	}
+    }
+    XDestroyImage(ximage);
+
+    if (fileObj != NULL) {
+	/*
+	 * Go through a temporary photo so that any format known to the
+	 * photo image can be written.
+	 */
+
+	if (Tcl_Eval(interp, "image create photo") != TCL_OK) {
+	    ckfree((char *) block.pixelPtr);
+	    return TCL_ERROR;
+	}
+	photoObj = Tcl_GetObjResult(interp);
+	Tcl_IncrRefCount(photoObj);
+	photo = Tk_FindPhoto(interp, Tcl_GetString(photoObj));
+    }
+    Tk_PhotoBlank(photo);
+#ifdef USE_PANIC_ON_PHOTO_ALLOC_FAILURE
+    Tk_PhotoPutBlock(photo, &block, 0, 0, width, height,
+	    TK_PHOTO_COMPOSITE_SET);
+#else
+    result = Tk_PhotoPutBlock(interp, photo, &block, 0, 0, width, height,
+	    TK_PHOTO_COMPOSITE_SET);
+#endif
+    ckfree((char *) block.pixelPtr);
+
+    if (fileObj != NULL) {
+	Tcl_Obj *cmdObj, *errObj = NULL;
+
+	if (result == TCL_OK) {
+	    cmdObj = Tcl_NewListObj(0, NULL);
+	    Tcl_IncrRefCount(cmdObj);
+	    Tcl_ListObjAppendElement(NULL, cmdObj, photoObj);
+	    Tcl_ListObjAppendElement(NULL, cmdObj, Tcl_NewStringObj("write", -1));
+	    Tcl_ListObjAppendElement(NULL, cmdObj, fileObj);
+	    Tcl_ListObjAppendElement(NULL, cmdObj, Tcl_NewStringObj("-format", -1));
+	    Tcl_ListObjAppendElement(NULL, cmdObj, (formatObj != NULL) ?
+		    formatObj : Tcl_NewStringObj("png", -1));
+	    result = Tcl_EvalObjEx(interp, cmdObj, TCL_EVAL_DIRECT);
+	    Tcl_DecrRefCount(cmdObj);
+	}
+	if (result != TCL_OK) {
+	    errObj = Tcl_GetObjResult(interp);
+	    Tcl_IncrRefCount(errObj);
+	}
+	Tk_DeleteImage(interp, Tcl_GetString(photoObj));
+	Tcl_DecrRefCount(photoObj);
+	if (errObj != NULL) {
+	    Tcl_SetObjResult(interp, errObj);
+	    Tcl_DecrRefCount(errObj);
+	} else {
+	    Tcl_ResetResult(interp);
+	}
+    } else if (result == TCL_OK) {
+	Tcl_SetObjResult(interp, photoObj);
+    }
+    return result;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * CanvasEventProc --
+ *
+ *	This function is invoked by the Tk dispatcher for various events on
+ *	canvases.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	When the window gets deleted, internal structures get cleaned up.
+ *	When it gets exposed, it is redisplayed.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+CanvasEventProc(
+    ClientData clientData,	/* Information about window. */
+    XEvent *eventPtr)		/* Information about event. */
+{
+    TkPathCanvas *canvasPtr = (TkPathCanvas *) clientData;
+
+    if (eventPtr->type == Expose) {
+	int x, y;
+
+	x = eventPtr->xexpose.x + canvasPtr->xOrigin;
 	y = eventPtr->xexpose.y + canvasPtr->yOrigin;
 	Tk_PathCanvasEventuallyRedraw((Tk_PathCanvas) canvasPtr, x, y,
 		x + eventPtr->xexpose.width,
@@ -2664,6 +3639,7 @@ CanvasEventProc(
 		    canvasPtr->widgetCmd);
 	    if (canvasPtr->flags & REDRAW_PENDING) {
 		Tcl_CancelIdleCall(DisplayCanvas, (ClientData) canvasPtr);
+		Tcl_DeleteTimerHandler(canvasPtr->frameTimer);
 	    }
 	    Tcl_EventuallyFree((ClientData) canvasPtr,
 		    (Tcl_FreeProc *) DestroyCanvas);
@@ -2802,10 +3778,7 @@ Tk_PathCanvasEventuallyRedraw(
 	canvasPtr->redrawY2 = y2;
 	canvasPtr->flags |= BBOX_NOT_EMPTY;
     }
-    if (!(canvasPtr->flags & REDRAW_PENDING)) {
-	Tcl_DoWhenIdle(DisplayCanvas, (ClientData) canvasPtr);
-	canvasPtr->flags |= REDRAW_PENDING;
-    }
+    ScheduleRedraw(canvasPtr);
 }
 
 /*
@@ -2831,6 +3804,12 @@ EventuallyRedrawItem(
     Tk_PathItem *itemPtr)		/* Item to be redrawn. */
 {
     TkPathCanvas *canvasPtr = (TkPathCanvas *) canvas;
+    
+    /*
+     * Let the parent group know about our bbox also when we are
+     * off screen.
+     */
+    TkPathCanvasGroupChildChanged(itemPtr);
     if ((itemPtr->x1 >= itemPtr->x2) || (itemPtr->y1 >= itemPtr->y2) ||
  	    (itemPtr->x2 < canvasPtr->xOrigin) ||
 	    (itemPtr->y2 < canvasPtr->yOrigin) ||
@@ -2863,11 +3842,77 @@ EventuallyRedrawItem(
 	}
 	itemPtr->redraw_flags |= FORCE_REDRAW;
     }
-    SetAncestorsDirtyBbox(itemPtr);
-    if (!(canvasPtr->flags & REDRAW_PENDING)) {
-	Tcl_DoWhenIdle(DisplayCanvas, (ClientData) canvasPtr);
-	canvasPtr->flags |= REDRAW_PENDING;
+    ScheduleRedraw(canvasPtr);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathCanvasEventuallyRedrawItem --
+ *
+ *	Lets code outside this file that changes items behind the back
+ *	of configProc schedule them for redisplay.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The item is redrawn and the current item repicked eventually.
+ *
+ *--------------------------------------------------------------
+ */
+
+void
+TkPathCanvasEventuallyRedrawItem(
+    Tk_PathCanvas canvas,		/* Information about widget. */
+    Tk_PathItem *itemPtr)		/* Item to be redrawn. */
+{
+    EventuallyRedrawItem(canvas, itemPtr);
+    ((TkPathCanvas *) canvas)->flags |= REPICK_NEEDED;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathCanvasFindWithTag --
+ *
+ *	Appends the ids of all items matching tagOrId, in stacking order,
+ *	to listObj. The same tag expressions as for 'find withtag' are
+ *	accepted.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkPathCanvasFindWithTag(
+    Tcl_Interp *interp,
+    TkPathCanvas *canvasPtr,
+    Tcl_Obj *tagObj,
+    Tcl_Obj *listObj)
+{
+    Tk_PathItem *itemPtr;
+    int result = TCL_OK;
+#ifdef USE_OLD_TAG_SEARCH
+    TagSearch search;
+#else /* USE_OLD_TAG_SEARCH */
+    TagSearch *searchPtr = NULL;
+#endif /* USE_OLD_TAG_SEARCH */
+
+    FOR_EVERY_CANVAS_ITEM_MATCHING(tagObj, &searchPtr, goto done) {
+	Tcl_ListObjAppendElement(interp, listObj, Tcl_NewIntObj(itemPtr->id));
     }
+    
+  done:
+#ifndef USE_OLD_TAG_SEARCH
+    TagSearchDestroy(searchPtr);
+#endif /* not USE_OLD_TAG_SEARCH */
+    return result;
 }
 
 /*
@@ -3126,6 +4171,143 @@ CanvasScaleGroup(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * CanvasTransformGroup --
+ *
+ *	Moves or scales a group by concatenating tPtr to its own -matrix
+ *	instead of changing the coordinates of all its descendants. The
+ *	transform is applied in the coordinate system of the group's
+ *	parent. The descendants are untouched except for their bounding
+ *	boxes which are transformed the same way, and may therefore be
+ *	a pixel larger than needed until the items compute them again.
+ *
+ * Results:
+ *	TCL_ERROR if the group's matrix is given by its -style and can't
+ *	be changed, or if the inherited matrix is singular. The caller
+ *	should then fall back to transforming the children.
+ *
+ * Side effects:
+ *	The group's -matrix changes and the group is redrawn.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+CanvasTransformGroup(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
+	TMatrix *tPtr)
+{
+    TkPathCanvas *canvasPtr = (TkPathCanvas *) canvas;
+    Tk_PathItemEx *itemExPtr = (Tk_PathItemEx *) itemPtr;
+    Tk_PathStyle *stylePtr = &itemExPtr->style;
+    Tk_PathItem *walkPtr;
+    TMatrix m, mi, d, unit = kPathUnitTMatrix;
+    int exact;
+    
+    if ((itemExPtr->styleInst != NULL) 
+	    && (itemExPtr->styleInst->masterPtr->mask & PATH_STYLE_OPTION_MATRIX)) {
+	return TCL_ERROR;
+    }
+    
+    /*
+     * The device space bboxes move by d = mi * t * m where m is the
+     * inherited matrix of the group (apply first to the left).
+     */
+    m = TkPathCanvasInheritTMatrix(itemPtr);
+    if (fabs(m.a*m.d - m.b*m.c) < 1e-12) {
+	return TCL_ERROR;
+    }
+    PathInverseTMatrix(&m, &mi);
+    d = *tPtr;
+    MMulTMatrix(&mi, &d);
+    MMulTMatrix(&d, &m);
+    d = m;
+    
+    if (stylePtr->matrixPtr == NULL) {
+	stylePtr->matrixPtr = (TMatrix *) ckalloc(sizeof(TMatrix));
+	*stylePtr->matrixPtr = unit;
+    }
+    m = *tPtr;
+    MMulTMatrix(stylePtr->matrixPtr, &m);
+    *stylePtr->matrixPtr = m;
+    stylePtr->mask |= PATH_STYLE_OPTION_MATRIX;
+
+    /*
+     * An integer translation keeps all bboxes exact, so the groups
+     * inside stay valid. Else they must be rescanned when needed.
+     */
+    exact = ((fabs(d.a - 1.0) < 1e-12) && (fabs(d.d - 1.0) < 1e-12)
+	    && (fabs(d.b) < 1e-12) && (fabs(d.c) < 1e-12)
+	    && (fabs(d.tx - floor(d.tx + 0.5)) < 1e-9)
+	    && (fabs(d.ty - floor(d.ty + 0.5)) < 1e-9));
+
+    TkPathCanvasGroupBbox(canvas, itemPtr, 
+	    &itemPtr->x1, &itemPtr->y1, &itemPtr->x2, &itemPtr->y2);
+    Tk_PathCanvasEventuallyRedraw(canvas, 
+	    itemPtr->x1, itemPtr->y1, itemPtr->x2, itemPtr->y2);
+    if (itemPtr->firstChildPtr != NULL) {
+	for (walkPtr = itemPtr->firstChildPtr; walkPtr != NULL; 
+		walkPtr = ItemIteratorSubNext(walkPtr, itemPtr)) {
+	    TransformBbox(&d, &walkPtr->x1, &walkPtr->y1, 
+		    &walkPtr->x2, &walkPtr->y2);
+	    if (exact) {
+		int *rectPtr = TkPathCanvasGroupChildBbox(walkPtr);
+
+		if (rectPtr != NULL) {
+		    TransformBbox(&d, rectPtr, rectPtr+1, rectPtr+2, rectPtr+3);
+		}
+	    } else if (walkPtr->typePtr == &tkGroupType) {
+		TkPathCanvasSetGroupDirtyBbox(walkPtr);
+	    }
+	}
+    }
+    TransformBbox(&d, &itemPtr->x1, &itemPtr->y1, &itemPtr->x2, &itemPtr->y2);
+    Tk_PathCanvasEventuallyRedraw(canvas, 
+	    itemPtr->x1, itemPtr->y1, itemPtr->x2, itemPtr->y2);
+    if (exact) {
+	TkPathCanvasGroupChildChanged(itemPtr);
+    } else {
+	TkPathCanvasSetGroupDirtyBbox(itemPtr);
+	SetAncestorsDirtyBbox(itemPtr);
+    }
+    canvasPtr->flags |= REPICK_NEEDED;
+    return TCL_OK;
+}
+
+static void
+TransformBbox(TMatrix *mPtr, int *x1Ptr, int *y1Ptr, int *x2Ptr, int *y2Ptr)
+{
+    double x[4], y[4];
+    double x1, y1, x2, y2;
+    int i;
+    
+    if ((*x1Ptr >= *x2Ptr) || (*y1Ptr >= *y2Ptr)) {
+	return;
+    }
+    x[0] = x[3] = *x1Ptr;
+    x[1] = x[2] = *x2Ptr;
+    y[0] = y[1] = *y1Ptr;
+    y[2] = y[3] = *y2Ptr;
+    for (i = 0; i < 4; i++) {
+	PathApplyTMatrix(mPtr, x+i, y+i);
+    }
+    x1 = x2 = x[0];
+    y1 = y2 = y[0];
+    for (i = 1; i < 4; i++) {
+	x1 = MIN(x1, x[i]);
+	y1 = MIN(y1, y[i]);
+	x2 = MAX(x2, x[i]);
+	y2 = MAX(y2, y[i]);
+    }
+    
+    /* Tiny slack so that exact integer moves stay exact. */
+    *x1Ptr = (int) floor(x1 + 1e-9);
+    *y1Ptr = (int) floor(y1 + 1e-9);
+    *x2Ptr = (int) ceil(x2 - 1e-9);
+    *y2Ptr = (int) ceil(y2 - 1e-9);
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -3156,42 +4338,35 @@ SetAncestorsDirtyBbox(Tk_PathItem *itemPtr)
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkPathCanvasGroupBbox --
+ *
+ *	Gets the bbox of a group. It is kept up to date incrementally
+ *	as its children change and only rescanned when needed, see
+ *	tkCanvGroup.c.
+ *
+ * Results:
+ *	The bbox, which is -1 -1 -1 -1 if empty.
+ *
+ * Side effects:
+ *	The group and its sub groups may be rescanned.
+ *
+ *----------------------------------------------------------------------
+ */
+
 void
 TkPathCanvasGroupBbox(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
 	int *x1Ptr, int *y1Ptr, int *x2Ptr, int *y2Ptr)
 {
-    int gotAny = 0;
-    Tk_PathItem *walkPtr;
-    int x1 = -1, y1 = -1, x2 = -1, y2 = -1;
-   
-    for (walkPtr = itemPtr->firstChildPtr; walkPtr != NULL; 
-	    walkPtr = walkPtr->nextPtr) {
-
-	/* 
-	 * Make sure sub groups have its bbox updated. 
-	 * We may be called recursively.
-	 */
-	if (walkPtr->firstChildPtr != NULL) {
-	    TkPathCanvasUpdateGroupBbox(canvas, walkPtr);
-	}
-	if ((walkPtr->x1 >= walkPtr->x2)
-		|| (walkPtr->y1 >= walkPtr->y2)) {
-	    continue;
-	}
-	if (!gotAny) {
-	    x1 = walkPtr->x1;
-	    y1 = walkPtr->y1;
-	    x2 = walkPtr->x2;
-	    y2 = walkPtr->y2;
-	    gotAny = 1;
-	} else {
-	    if (walkPtr->x1 < x1) { x1 = walkPtr->x1; }
-	    if (walkPtr->y1 < y1) { y1 = walkPtr->y1; }
-	    if (walkPtr->x2 > x2) { x2 = walkPtr->x2; }
-	    if (walkPtr->y2 > y2) { y2 = walkPtr->y2; }
-	}
+    TkPathCanvasUpdateGroupBbox(canvas, itemPtr);
+    if ((itemPtr->x1 >= itemPtr->x2) || (itemPtr->y1 >= itemPtr->y2)) {
+	*x1Ptr = *y1Ptr = *x2Ptr = *y2Ptr = -1;
+    } else {
+	*x1Ptr = itemPtr->x1, *y1Ptr = itemPtr->y1;
+	*x2Ptr = itemPtr->x2, *y2Ptr = itemPtr->y2;
     }
-    *x1Ptr = x1, *y1Ptr = y1, *x2Ptr = x2, *y2Ptr = y2;
 }
 
 /*
@@ -3241,9 +4416,15 @@ InitCanvas(void)
     tkPolylineType.nextPtr = &tkPpolygonType;
     tkPpolygonType.nextPtr = &tkCircleType;
     tkCircleType.nextPtr = &tkEllipseType;
-    tkEllipseType.nextPtr = &tkPimageType;
+    tkEllipseType.nextPtr = &tkCirclesType;
+    tkCirclesType.nextPtr = &tkPrectsType;
+    tkPrectsType.nextPtr = &tkLcircleType;
+    tkLcircleType.nextPtr = &tkLrectType;
+    tkLrectType.nextPtr = &tkLlineType;
+    tkLlineType.nextPtr = &tkPimageType;
     tkPimageType.nextPtr = &tkPtextType;
-    tkPtextType.nextPtr = &tkGroupType;
+    tkPtextType.nextPtr = &tkUseType;
+    tkUseType.nextPtr = &tkGroupType;
     tkGroupType.nextPtr = NULL;
    
     Tcl_MutexUnlock(&typeListMutex);
@@ -3278,7 +4459,8 @@ ItemCreate(Tcl_Interp *interp, TkPathCanvas *canvasPtr,
     int isNew = 0;
     int result;
 
-    itemPtr = (Tk_PathItem *) ckalloc((unsigned) typePtr->itemSize);
+    itemPtr = (Tk_PathItem *) TkPathPoolAlloc(canvasPtr->itemPoolPtr, 
+	    (unsigned) typePtr->itemSize);
     if (isRoot) {
 	itemPtr->id = 0;
     } else {
@@ -3294,6 +4476,7 @@ ItemCreate(Tcl_Interp *interp, TkPathCanvas *canvasPtr,
     itemPtr->prevPtr = NULL;
     itemPtr->firstChildPtr = NULL;
     itemPtr->lastChildPtr = NULL;
+    itemPtr->x1 = itemPtr->y1 = itemPtr->x2 = itemPtr->y2 = -1;
     
     /* 
      * This is just to be able to detect if createProc processes
@@ -3307,7 +4490,8 @@ ItemCreate(Tcl_Interp *interp, TkPathCanvas *canvasPtr,
     result = (*typePtr->createProc)(interp, (Tk_PathCanvas) canvasPtr,
 	    itemPtr, objc, objv);
     if (result != TCL_OK) {
-	ckfree((char *) itemPtr);
+	TkPathPoolFree(canvasPtr->itemPoolPtr, (char *) itemPtr, 
+		(unsigned) typePtr->itemSize);
 	return TCL_ERROR;
     }
     entryPtr = Tcl_CreateHashEntry(&canvasPtr->idTable,
@@ -3328,6 +4512,173 @@ ItemCreate(Tcl_Interp *interp, TkPathCanvas *canvasPtr,
     return TCL_OK;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * GetItemTypeFromObj --
+ *
+ *	Finds the item type from its name or a unique abbreviation.
+ *
+ * Results:
+ *	Standard Tcl result. The type is put in *typePtrPtr.
+ *
+ * Side effects:
+ *	Error message left in interp.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+GetItemTypeFromObj(Tcl_Interp *interp, Tcl_Obj *objPtr, 
+	Tk_PathItemType **typePtrPtr)
+{
+    Tk_PathItemType *typePtr;
+    Tk_PathItemType *matchPtr = NULL;
+    int ambiguous = 0;
+    char *arg;
+    int length;
+
+    arg = Tcl_GetStringFromObj(objPtr, &length);
+    Tcl_MutexLock(&typeListMutex);
+    for (typePtr = typeList; typePtr != NULL; typePtr = typePtr->nextPtr) {
+	if ((arg[0] == typePtr->name[0])
+		&& (strncmp(arg, typePtr->name, (unsigned)length) == 0)) {
+	    /*
+	     * An exact name always wins, since some type names
+	     * (circle, circles) are prefixes of others.
+	     */
+	    if (typePtr->name[length] == '\0') {
+		matchPtr = typePtr;
+		ambiguous = 0;
+		break;
+	    }
+	    if (matchPtr != NULL) {
+		ambiguous = 1;
+	    }
+	    matchPtr = typePtr;
+	}
+    }
+    /*
+     * Can unlock now because we no longer look at the fields of
+     * the matched item type that are potentially modified by
+     * other threads.
+     */
+    Tcl_MutexUnlock(&typeListMutex);
+    if ((matchPtr == NULL) || ambiguous) {
+	Tcl_AppendResult(interp,
+		"unknown or ambiguous item type \"",arg,"\"",NULL);
+	return TCL_ERROR;
+    }
+    *typePtrPtr = matchPtr;
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPathCanvasCreateItem, TkPathCanvasDeleteItem --
+ *
+ *	Create and delete items for code that makes many of them at a
+ *	time, as the load command does. The item is given the id asked
+ *	for if it is free, else the next id. Coords given as packed
+ *	doubles go before objv, as a single byte array for types that
+ *	take -binary coords. Unless the item type always redraws nothing
+ *	is scheduled for redisplay; it is up to the caller to redraw the
+ *	area of all items made.
+ *
+ * Results:
+ *	TkPathCanvasCreateItem returns a standard Tcl result and the new
+ *	item in itemPtrPtr.
+ *
+ * Side effects:
+ *	Item allocated, configured, and linked into display list, or
+ *	deleted.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkPathCanvasCreateItem(
+    Tcl_Interp *interp,
+    TkPathCanvas *canvasPtr,
+    Tcl_Obj *typeObj,		/* Name of item type. */
+    int id,			/* Wanted id, or 0 for the next one. */
+    CONST char *coords,		/* Native doubles, not necessarily
+				 * aligned, or NULL. */
+    int numCoords,		/* Number of doubles at coords. */
+    int objc,
+    Tcl_Obj *CONST objv[],	/* Coords unless given above, and
+				 * options. */
+    Tk_PathItem **itemPtrPtr)
+{
+    Tk_PathItemType *typePtr;
+    Tk_PathItem *itemPtr;
+    Tcl_Obj **coordv = NULL;
+    int nextId = canvasPtr->nextId;
+    int i, numCoordv = 0, result;
+
+    if (GetItemTypeFromObj(interp, typeObj, &typePtr) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    if (coords != NULL) {
+	coordv = (Tcl_Obj **) ckalloc((unsigned)
+		(MAX(numCoords, 2) + objc) * sizeof(Tcl_Obj *));
+	if (typePtr->flags & TK_PATH_ITEMTYPE_BINARY_COORDS) {
+	    coordv[numCoordv++] = Tcl_NewStringObj("-binary", -1);
+	    coordv[numCoordv++] = Tcl_NewByteArrayObj(
+		    (CONST unsigned char *) coords,
+		    numCoords * (int) sizeof(double));
+	} else {
+	    for (i = 0; i < numCoords; i++) {
+		double d;
+
+		memcpy(&d, coords + i * sizeof(double), sizeof(double));
+		coordv[numCoordv++] = Tcl_NewDoubleObj(d);
+	    }
+	}
+	for (i = 0; i < numCoordv; i++) {
+	    Tcl_IncrRefCount(coordv[i]);
+	}
+	memcpy(coordv + numCoordv, objv, objc * sizeof(Tcl_Obj *));
+	objv = coordv;
+	objc += numCoordv;
+    }
+    if ((id > 0) && (Tcl_FindHashEntry(&canvasPtr->idTable,
+	    (char *) INT2PTR(id)) == NULL)) {
+	canvasPtr->nextId = id;
+    }
+    result = ItemCreate(interp, canvasPtr, typePtr, 0, &itemPtr, 
+	    objc, objv);
+    if (coordv != NULL) {
+	for (i = 0; i < numCoordv; i++) {
+	    Tcl_DecrRefCount(coordv[i]);
+	}
+	ckfree((char *) coordv);
+    }
+    if (result != TCL_OK) {
+	canvasPtr->nextId = nextId;
+	return TCL_ERROR;
+    }
+    canvasPtr->nextId = MAX(nextId, itemPtr->id + 1);
+    itemPtr->redraw_flags &= ~FORCE_REDRAW;
+    TkPathCanvasGroupChildChanged(itemPtr);
+    if (itemPtr->typePtr->alwaysRedraw & 1) {
+	EventuallyRedrawItem((Tk_PathCanvas) canvasPtr, itemPtr);
+    }
+    canvasPtr->hotPtr = itemPtr;
+    canvasPtr->hotPrevPtr = itemPtr->prevPtr;
+    *itemPtrPtr = itemPtr;
+    return TCL_OK;
+}
+
+void
+TkPathCanvasDeleteItem(
+    TkPathCanvas *canvasPtr,
+    Tk_PathItem *itemPtr)
+{
+    ItemDelete(canvasPtr, itemPtr);
+}
+
 static Tcl_Obj *UnshareObj(Tcl_Obj *objPtr)
 {
     if (Tcl_IsShared(objPtr)) {
@@ -3457,6 +4808,9 @@ TkPathCanvasItemDetach(Tk_PathItem *itemPtr)
 {
     Tk_PathItem *parentPtr;
     
+    if (itemPtr->parentPtr != NULL) {
+	TkPathCanvasGroupChildRemoved(itemPtr);
+    }
     if (itemPtr->prevPtr != NULL) {
 	itemPtr->prevPtr->nextPtr = itemPtr->nextPtr;
     }
@@ -3481,73 +4835,220 @@ TkPathCanvasItemDetach(Tk_PathItem *itemPtr)
 }
 
 /*
- *--------------------------------------------------------------
+ *--------------------------------------------------------------
+ *
+ * ItemAddToParent --
+ *
+ *	Appends an item as the last sibling to a parent item.
+ *	It doesn't do any unlinking from a previous tree position.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Display list updated.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void		
+ItemAddToParent(Tk_PathItem *parentPtr, Tk_PathItem *itemPtr)
+{
+    itemPtr->nextPtr = NULL;
+    itemPtr->prevPtr = parentPtr->lastChildPtr;
+    if (parentPtr->lastChildPtr != NULL) {
+	parentPtr->lastChildPtr->nextPtr = itemPtr;
+    } else {
+	parentPtr->firstChildPtr = itemPtr;
+    }
+    parentPtr->lastChildPtr = itemPtr;
+    itemPtr->parentPtr = parentPtr;
+    TkPathCanvasGroupChildChanged(itemPtr);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ItemDelete --
+ *
+ *	Recursively frees all resources associated with an Item and its
+ *	descendants and removes it from display list.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Items are removed from their parent and freed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ItemDelete(TkPathCanvas *canvasPtr, Tk_PathItem *itemPtr)
+{
+    Tcl_HashEntry *entryPtr;
+    
+    /*
+     * Remove any children by recursively calling us.
+     * NB: This is very tricky code! Children updates
+     *     the itemPtr->firstChildPtr here via calls
+     *     to TkPathCanvasItemDetach.
+     */
+    while (itemPtr->firstChildPtr != NULL) {
+	ItemDelete(canvasPtr, itemPtr->firstChildPtr);
+    }
+
+    EventuallyRedrawItem((Tk_PathCanvas) canvasPtr, itemPtr);
+    entryPtr = Tcl_FindHashEntry(&canvasPtr->idTable,
+				 (char *) INT2PTR(itemPtr->id));
+    Tcl_DeleteHashEntry(entryPtr);
+    TkPathCanvasItemDetach(itemPtr);
+    ItemRelease(canvasPtr, itemPtr);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ItemDeleteTree --
+ *
+ *	Frees an item and all its descendants without unlinking them
+ *	one by one. The caller must already have detached the item.
+ *	Instead of scheduling a redraw for each item their bounding
+ *	boxes are added to area, {x1 y1 x2 y2}, which is empty as
+ *	long as x1 >= x2.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Items are freed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ItemDeleteTree(TkPathCanvas *canvasPtr, Tk_PathItem *itemPtr, int area[4])
+{
+    Tk_PathItem *childPtr, *nextPtr;
+    Tcl_HashEntry *entryPtr;
+    
+    for (childPtr = itemPtr->firstChildPtr; childPtr != NULL; 
+	    childPtr = nextPtr) {
+	nextPtr = childPtr->nextPtr;
+	ItemDeleteTree(canvasPtr, childPtr, area);
+    }
+    if ((itemPtr->x1 < itemPtr->x2) && (itemPtr->y1 < itemPtr->y2)) {
+	if (area[0] < area[2]) {
+	    area[0] = MIN(area[0], itemPtr->x1);
+	    area[1] = MIN(area[1], itemPtr->y1);
+	    area[2] = MAX(area[2], itemPtr->x2);
+	    area[3] = MAX(area[3], itemPtr->y2);
+	} else {
+	    area[0] = itemPtr->x1;
+	    area[1] = itemPtr->y1;
+	    area[2] = itemPtr->x2;
+	    area[3] = itemPtr->y2;
+	}
+    }
+    entryPtr = Tcl_FindHashEntry(&canvasPtr->idTable,
+				 (char *) INT2PTR(itemPtr->id));
+    Tcl_DeleteHashEntry(entryPtr);
+    ItemRelease(canvasPtr, itemPtr);
+}
+
+/*
+ *----------------------------------------------------------------------
  *
- * ItemAddToParent --
+ * DeleteAllItems --
  *
- *	Appends an item as the last sibling to a parent item.
- *	It doesn't do any unlinking from a previous tree position.
+ *	Frees all items but the root in one sweep. The id table is
+ *	rebuilt instead of removing each entry and the tree is not
+ *	unlinked at all.
  *
  * Results:
  *	None.
  *
  * Side effects:
- *	Display list updated.
+ *	The canvas is emptied and redrawn.
  *
- *--------------------------------------------------------------
+ *----------------------------------------------------------------------
  */
 
-static void		
-ItemAddToParent(Tk_PathItem *parentPtr, Tk_PathItem *itemPtr)
+static void
+DeleteAllItems(TkPathCanvas *canvasPtr)
 {
-    itemPtr->nextPtr = NULL;
-    itemPtr->prevPtr = parentPtr->lastChildPtr;
-    if (parentPtr->lastChildPtr != NULL) {
-	parentPtr->lastChildPtr->nextPtr = itemPtr;
-    } else {
-	parentPtr->firstChildPtr = itemPtr;
+    Tk_PathItem *rootPtr = canvasPtr->rootItemPtr;
+    Tk_PathItem *itemPtr, *prevItemPtr;
+    Tcl_HashEntry *entryPtr;
+    int isNew;
+
+    if (rootPtr->firstChildPtr == NULL) {
+	return;
     }
-    parentPtr->lastChildPtr = itemPtr;
-    itemPtr->parentPtr = parentPtr;
+    
+    /*
+     * Walk backwards from the last item so that children go before
+     * their parents and no freed record is visited again.
+     */
+    itemPtr = rootPtr->lastChildPtr;
+    while (itemPtr->lastChildPtr != NULL) {
+	itemPtr = itemPtr->lastChildPtr;
+    }
+    while (itemPtr != rootPtr) {
+	prevItemPtr = TkPathCanvasItemIteratorPrev(itemPtr);
+	ItemRelease(canvasPtr, itemPtr);
+	itemPtr = prevItemPtr;
+    }
+    rootPtr->firstChildPtr = rootPtr->lastChildPtr = NULL;
+    TkPathCanvasSetGroupDirtyBbox(rootPtr);
+    
+    Tcl_DeleteHashTable(&canvasPtr->idTable);
+    Tcl_InitHashTable(&canvasPtr->idTable, TCL_ONE_WORD_KEYS);
+    entryPtr = Tcl_CreateHashEntry(&canvasPtr->idTable,
+	    (char *) INT2PTR(rootPtr->id), &isNew);
+    Tcl_SetHashValue(entryPtr, rootPtr);
+
+    Tk_PathCanvasEventuallyRedraw((Tk_PathCanvas) canvasPtr,
+	    canvasPtr->xOrigin, canvasPtr->yOrigin,
+	    canvasPtr->xOrigin + Tk_Width(canvasPtr->tkwin),
+	    canvasPtr->yOrigin + Tk_Height(canvasPtr->tkwin));
 }
 
 /*
  *----------------------------------------------------------------------
  *
- * ItemDelete --
+ * ItemRelease --
  *
- *	Recursively frees all resources associated with an Item and its
- *	descendants and removes it from display list.
+ *	Frees the resources of a single item and its record. It is not
+ *	unlinked from the tree nor removed from the id table.
  *
  * Results:
  *	None.
  *
  * Side effects:
- *	Items are removed from their parent and freed.
+ *	Item is freed.
  *
  *----------------------------------------------------------------------
  */
 
 static void
-ItemDelete(TkPathCanvas *canvasPtr, Tk_PathItem *itemPtr)
+ItemRelease(TkPathCanvas *canvasPtr, Tk_PathItem *itemPtr)
 {
-    Tcl_HashEntry *entryPtr;
-    
-    /*
-     * Remove any children by recursively calling us.
-     * NB: This is very tricky code! Children updates
-     *     the itemPtr->firstChildPtr here via calls
-     *     to TkPathCanvasItemDetach.
-     */
-    while (itemPtr->firstChildPtr != NULL) {
-	ItemDelete(canvasPtr, itemPtr->firstChildPtr);
-    }
-
-    EventuallyRedrawItem((Tk_PathCanvas) canvasPtr, itemPtr);
     if (canvasPtr->bindingTable != NULL) {
 	Tk_DeleteAllBindings(canvasPtr->bindingTable,
 			     (ClientData) itemPtr);
     }
+#ifndef USE_OLD_TAG_SEARCH
+    if (canvasPtr->exprMatchTable.numEntries > 0) {
+	Tcl_HashEntry *hPtr = Tcl_FindHashEntry(&canvasPtr->exprMatchTable,
+		(char *) INT2PTR(itemPtr->id));
+
+	if (hPtr != NULL) {
+	    FreeTagExprMatches((TagExprMatches *) Tcl_GetHashValue(hPtr));
+	    Tcl_DeleteHashEntry(hPtr);
+	}
+    }
+#endif /* not USE_OLD_TAG_SEARCH */
     
     /*
      * The item type deleteProc is responsible for calling 
@@ -3557,11 +5058,6 @@ ItemDelete(TkPathCanvas *canvasPtr, Tk_PathItem *itemPtr)
     (*itemPtr->typePtr->deleteProc)((Tk_PathCanvas) canvasPtr, itemPtr,
 				    canvasPtr->display);
 
-    entryPtr = Tcl_FindHashEntry(&canvasPtr->idTable,
-				 (char *) INT2PTR(itemPtr->id));
-    Tcl_DeleteHashEntry(entryPtr);
-    TkPathCanvasItemDetach(itemPtr);
-    
     if (itemPtr == canvasPtr->currentItemPtr) {
 	canvasPtr->currentItemPtr = NULL;
 	canvasPtr->flags |= REPICK_NEEDED;
@@ -3580,7 +5076,8 @@ ItemDelete(TkPathCanvas *canvasPtr, Tk_PathItem *itemPtr)
 	    || (itemPtr == canvasPtr->hotPrevPtr)) {
 	canvasPtr->hotPtr = NULL;
     }
-    ckfree((char *) itemPtr);
+    TkPathPoolFree(canvasPtr->itemPoolPtr, (char *) itemPtr, 
+	    (unsigned) itemPtr->typePtr->itemSize);
 }
 
 static void
@@ -3921,6 +5418,37 @@ TagSearchExprDestroy(
     }
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * TagSearchExprCacheFlush --
+ *
+ *	This function empties the cache of compiled tag expressions.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Deallocates memory.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+TagSearchExprCacheFlush(
+    TkPathCanvas *canvasPtr)
+{
+    Tcl_HashEntry *hPtr;
+    Tcl_HashSearch search;
+
+    for (hPtr = Tcl_FirstHashEntry(&canvasPtr->exprCacheTable, &search);
+	    hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	TagSearchExprDestroy((TagSearchExpr *) Tcl_GetHashValue(hPtr));
+    }
+    Tcl_DeleteHashTable(&canvasPtr->exprCacheTable);
+    Tcl_InitHashTable(&canvasPtr->exprCacheTable, TCL_ONE_WORD_KEYS);
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -4070,8 +5598,34 @@ TagSearchScan(
 	 * expression into array of Tk_Uid flagging any syntax errors found.
 	 */
 
+	TagSearchExpr *expr = searchPtr->expr;
+	TagSearchExpr *cachedPtr;
+	Tcl_HashEntry *hPtr;
+	int isNew;
+
+	hPtr = Tcl_FindHashEntry(&canvasPtr->exprCacheTable,
+		(char *) expr->uid);
+	if (hPtr != NULL) {
+	    /*
+	     * Compiled before; the uids are kept forever so copy them.
+	     */
+
+	    cachedPtr = (TagSearchExpr *) Tcl_GetHashValue(hPtr);
+	    if (expr->allocated < cachedPtr->length) {
+		expr->allocated = cachedPtr->length;
+		if (expr->uids) {
+		    ckfree((char *) expr->uids);
+		}
+		expr->uids = (Tk_Uid *)
+			ckalloc(expr->allocated * sizeof(Tk_Uid));
+	    }
+	    memcpy(expr->uids, cachedPtr->uids,
+		    cachedPtr->length * sizeof(Tk_Uid));
+	    expr->length = cachedPtr->length;
+	    return TCL_OK;
+	}
 	if (TagSearchScanExpr(canvasPtr->interp, searchPtr,
-		searchPtr->expr) != TCL_OK) {
+		expr) != TCL_OK) {
 	    /*
 	     * Syntax error in tag expression. The result message was set by
 	     * TagSearchScanExpr.
@@ -4079,7 +5633,26 @@ TagSearchScan(
 
 	    return TCL_ERROR;
 	}
-	searchPtr->expr->length = searchPtr->expr->index;
+	expr->length = expr->index;
+
+	/*
+	 * Keep a copy for the next command using the same expression. The
+	 * cache is simply emptied when full since scripts tend to use only
+	 * a handful of expressions over and over.
+	 */
+
+	if (canvasPtr->exprCacheTable.numEntries >= TAG_EXPR_CACHE_SIZE) {
+	    TagSearchExprCacheFlush(canvasPtr);
+	}
+	cachedPtr = NULL;
+	TagSearchExprInit(&cachedPtr);
+	cachedPtr->uid = expr->uid;
+	cachedPtr->allocated = cachedPtr->length = expr->length;
+	cachedPtr->uids = (Tk_Uid *) ckalloc(expr->length * sizeof(Tk_Uid));
+	memcpy(cachedPtr->uids, expr->uids, expr->length * sizeof(Tk_Uid));
+	hPtr = Tcl_CreateHashEntry(&canvasPtr->exprCacheTable,
+		(char *) expr->uid, &isNew);
+	Tcl_SetHashValue(hPtr, cachedPtr);
     } else if (searchPtr->expr->uid == GetStaticUids()->allUid) {
 	/*
 	 * All items match.
@@ -4629,8 +6202,10 @@ TagSearchFirst(
 	 */
 
 	uid = searchPtr->expr->uid;
+	SEARCH_STATS_BEGIN(searchPtr);
 	for (lastPtr = NULL, itemPtr = searchPtr->canvasPtr->rootItemPtr;
 		itemPtr != NULL; lastPtr = itemPtr, itemPtr = TkPathCanvasItemIteratorNext(itemPtr)) {
+	    SEARCH_STATS_SCAN(searchPtr);
 	    ptagsPtr = itemPtr->pathTagsPtr;
 	    if (ptagsPtr != NULL) {
 		for (tagPtr = ptagsPtr->tagPtr, count = ptagsPtr->numTags;
@@ -4649,8 +6224,10 @@ TagSearchFirst(
 	 * None of the above. Search for an item matching the tag expression.
 	 */
 
+	SEARCH_STATS_BEGIN(searchPtr);
 	for (lastPtr = NULL, itemPtr = searchPtr->canvasPtr->rootItemPtr;
 		itemPtr != NULL; lastPtr = itemPtr, itemPtr = TkPathCanvasItemIteratorNext(itemPtr)) {
+	    SEARCH_STATS_SCAN(searchPtr);
 	    searchPtr->expr->index = 0;
 	    if (TagSearchEvalExpr(searchPtr->expr, itemPtr)) {
 		searchPtr->lastPtr = lastPtr;
@@ -4738,6 +6315,7 @@ TagSearchNext(
 
 	uid = searchPtr->expr->uid;
 	for (; itemPtr != NULL; lastPtr = itemPtr, itemPtr = TkPathCanvasItemIteratorNext(itemPtr)) {
+	    SEARCH_STATS_SCAN(searchPtr);
 	    ptagsPtr = itemPtr->pathTagsPtr;
 	    if (ptagsPtr != NULL) {
 		for (tagPtr = ptagsPtr->tagPtr, count = ptagsPtr->numTags;
@@ -4760,6 +6338,7 @@ TagSearchNext(
      */
 
     for ( ; itemPtr != NULL; lastPtr = itemPtr, itemPtr = TkPathCanvasItemIteratorNext(itemPtr)) {
+	SEARCH_STATS_SCAN(searchPtr);
 	searchPtr->expr->index = 0;
 	if (TagSearchEvalExpr(searchPtr->expr, itemPtr)) {
 	    searchPtr->lastPtr = lastPtr;
@@ -4844,11 +6423,12 @@ DoItem(
 	    Tk_Uid *newTagPtr;
 
 	    ptagsPtr->tagSpace += 5;
-	    newTagPtr = (Tk_Uid *)
-		    ckalloc((unsigned) (ptagsPtr->tagSpace * sizeof(Tk_Uid)));
+	    newTagPtr = (Tk_Uid *) TkPathPoolAlloc(TkPathTagPool(),
+		    (unsigned) (ptagsPtr->tagSpace * sizeof(Tk_Uid)));
 	    memcpy((void *) newTagPtr, ptagsPtr->tagPtr,
 		    ptagsPtr->numTags * sizeof(Tk_Uid));
-	    ckfree((char *) ptagsPtr->tagPtr);
+	    TkPathPoolFree(TkPathTagPool(), (char *) ptagsPtr->tagPtr,
+		    (unsigned) (ptagsPtr->numTags * sizeof(Tk_Uid)));
 	    ptagsPtr->tagPtr = newTagPtr;
 	}
 	
@@ -4915,11 +6495,11 @@ FindItems(
     Tk_Uid uid;
     int index, result;
     static CONST char *optionStrings[] = {
-	"above", "all", "below", "closest",
+	"above", "all", "atpoints", "below", "closest",
 	"enclosed", "overlapping", "withtag", NULL
     };
     enum options {
-	CANV_ABOVE, CANV_ALL, CANV_BELOW, CANV_CLOSEST,
+	CANV_ABOVE, CANV_ALL, CANV_ATPOINTS, CANV_BELOW, CANV_CLOSEST,
 	CANV_ENCLOSED, CANV_OVERLAPPING, CANV_WITHTAG
     };
 
@@ -4962,6 +6542,44 @@ FindItems(
 	}
 	break;
 
+    case CANV_ATPOINTS: {
+	Tk_PathItem **items = NULL;
+	int numItems = 0, itemSpace = 0;
+
+	if (objc != first+3) {
+	    Tcl_WrongNumArgs(interp, first+1, objv, "tagOrId coordList");
+	    return TCL_ERROR;
+	}
+
+	/*
+	 * Collect the candidates once, in display order, so that each point
+	 * only needs a bbox test and a pointProc call per candidate. Hidden
+	 * and disabled items are passed over as in find closest.
+	 */
+
+	FOR_EVERY_CANVAS_ITEM_MATCHING(objv[first+1], searchPtrPtr,
+		return TCL_ERROR) {
+	    if (itemPtr->state == TK_PATHSTATE_HIDDEN ||
+		    itemPtr->state == TK_PATHSTATE_DISABLED ||
+		    (itemPtr->state == TK_PATHSTATE_NULL &&
+		    (canvasPtr->canvas_state == TK_PATHSTATE_HIDDEN ||
+		    canvasPtr->canvas_state == TK_PATHSTATE_DISABLED))) {
+		continue;
+	    }
+	    if (numItems == itemSpace) {
+		itemSpace = (itemSpace == 0) ? 16 : 2*itemSpace;
+		items = (Tk_PathItem **) ckrealloc((char *) items,
+			(unsigned) (itemSpace * sizeof(Tk_PathItem *)));
+	    }
+	    items[numItems++] = itemPtr;
+	}
+	result = FindAtPoints(interp, canvasPtr, objv[first+2], items,
+		numItems, uid);
+	if (items != NULL) {
+	    ckfree((char *) items);
+	}
+	return result;
+    }
     case CANV_BELOW:
 	if (objc != first+2) {
 	    Tcl_WrongNumArgs(interp, first+1, objv, "tagOrId");
@@ -5036,6 +6654,7 @@ FindItems(
 	if (itemPtr == NULL) {
 	    return TCL_OK;
 	}
+	HIT_STATS(canvasPtr);
 	closestDist = (*itemPtr->typePtr->pointProc)((Tk_PathCanvas) canvasPtr,
 		itemPtr, coords) - halo;
 	if (closestDist < 0.0) {
@@ -5079,6 +6698,7 @@ FindItems(
 			|| (itemPtr->y1 >= y2) || (itemPtr->y2 <= y1)) {
 		    continue;
 		}
+		HIT_STATS(canvasPtr);
 		newDist = (*itemPtr->typePtr->pointProc)((Tk_PathCanvas) canvasPtr,
 			itemPtr, coords) - halo;
 		if (newDist < 0.0) {
@@ -5194,6 +6814,7 @@ FindArea(
 		|| (itemPtr->y1 >= y2) || (itemPtr->y2 <= y1)) {
 	    continue;
 	}
+	HIT_STATS(canvasPtr);
 	if ((*itemPtr->typePtr->areaProc)((Tk_PathCanvas) canvasPtr, itemPtr, rect)
 		>= enclosed) {
 	    DoItem(interp, itemPtr, uid);
@@ -5202,6 +6823,142 @@ FindArea(
     return TCL_OK;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * GetPointsFromObj --
+ *
+ *	Parses a flat list {x y x y ...} of plain doubles as used by the
+ *	batch query commands "find atpoints" and "distance".
+ *
+ * Results:
+ *	A standard Tcl return value. On success *pointsPtr points to a
+ *	ckalloc'ed array of 2 * *numPointsPtr doubles which the caller must
+ *	free (it is NULL if the list is empty).
+ *
+ * Side effects:
+ *	Memory may be allocated.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+GetPointsFromObj(
+    Tcl_Interp *interp,		/* Interpreter for error reporting. */
+    Tcl_Obj *listObj,		/* The flat coordinate list. */
+    double **pointsPtr,		/* Returns the coordinate array. */
+    int *numPointsPtr)		/* Returns number of points. */
+{
+    Tcl_Obj **objv;
+    double *points;
+    int objc, i;
+
+    *pointsPtr = NULL;
+    *numPointsPtr = 0;
+    if (Tcl_ListObjGetElements(interp, listObj, &objc, &objv) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    if (objc & 1) {
+	Tcl_AppendResult(interp, "wrong # coordinates: expected an even number",
+		" of values, got ", Tcl_GetString(listObj), NULL);
+	return TCL_ERROR;
+    }
+    if (objc == 0) {
+	return TCL_OK;
+    }
+    points = (double *) ckalloc((unsigned) (objc * sizeof(double)));
+    for (i = 0; i < objc; i++) {
+	if (Tcl_GetDoubleFromObj(interp, objv[i], &points[i]) != TCL_OK) {
+	    ckfree((char *) points);
+	    return TCL_ERROR;
+	}
+    }
+    *pointsPtr = points;
+    *numPointsPtr = objc/2;
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * FindAtPoints --
+ *
+ *	This function implements the "find atpoints" and "addtag atpoints"
+ *	batch hit tests. For each point the candidate items are searched
+ *	from the top of the display list down, and the search stops at the
+ *	first item within closeEnough of the point. Only items whose bbox
+ *	is near the point get a pointProc call.
+ *
+ * Results:
+ *	A standard Tcl return value. If uid is NULL, the interp's result is
+ *	a list with one element per point, the id of the topmost item hit or
+ *	an empty string if none.
+ *
+ * Side effects:
+ *	If uid is non-NULL, then all the items hit by any of the points get
+ *	that tag added to their lists of tags.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+FindAtPoints(
+    Tcl_Interp *interp,		/* Interpreter for error reporting and result
+				 * storing. */
+    TkPathCanvas *canvasPtr,	/* Canvas whose items are to be searched. */
+    Tcl_Obj *pointsObj,		/* Flat list of point coordinates. */
+    Tk_PathItem **items,	/* Candidate items in display order. */
+    int numItems,		/* Number of candidate items. */
+    Tk_Uid uid)			/* If non-NULL, gives new tag to set on all
+				 * items hit; if NULL, then ids are returned
+				 * in the interp's result. */
+{
+    Tcl_Obj *listObj = NULL;
+    Tk_PathItem *itemPtr;
+    double *points, *coords;
+    double halo = canvasPtr->closeEnough;
+    int numPoints, i, j;
+
+    if (GetPointsFromObj(interp, pointsObj, &points, &numPoints) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    if (uid == NULL) {
+	listObj = Tcl_NewListObj(0, NULL);
+    }
+    for (i = 0, coords = points; i < numPoints; i++, coords += 2) {
+	for (j = numItems-1; j >= 0; j--) {
+	    itemPtr = items[j];
+	    if ((itemPtr->x1 > coords[0] + halo) || (itemPtr->x2 < coords[0] - halo)
+		    || (itemPtr->y1 > coords[1] + halo)
+		    || (itemPtr->y2 < coords[1] - halo)) {
+		continue;
+	    }
+	    HIT_STATS(canvasPtr);
+	    if ((*itemPtr->typePtr->pointProc)((Tk_PathCanvas) canvasPtr,
+		    itemPtr, coords) <= halo) {
+		break;
+	    }
+	}
+	if (uid != NULL) {
+	    if (j >= 0) {
+		DoItem(interp, items[j], uid);
+	    }
+	} else if (j >= 0) {
+	    Tcl_ListObjAppendElement(NULL, listObj,
+		    Tcl_NewIntObj(items[j]->id));
+	} else {
+	    Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewObj());
+	}
+    }
+    if (points != NULL) {
+	ckfree((char *) points);
+    }
+    if (listObj != NULL) {
+	Tcl_SetObjResult(interp, listObj);
+    }
+    return TCL_OK;
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -5507,6 +7264,10 @@ PickCurrentItem(
     SearchUids *searchUids = GetStaticUids();
 #endif
 
+    if (canvasPtr->statsPtr != NULL) {
+	canvasPtr->statsPtr->picks++;
+    }
+
     /*
      * Check whether or not a button is down. If so, we'll log entry and exit
      * into and out of the current item, but not entry into any other item.
@@ -5700,7 +7461,9 @@ PickCurrentItem(
  *
  *	Given x and y coordinates, find the topmost canvas item that is
  *	"close" to the coordinates. Canvas items that are hidden or disabled
- *	are ignored.
+ *	are ignored. The item tree is walked in reverse display order so the
+ *	search stops at the first hit instead of testing every item that
+ *	overlaps the point.
  *
  * Results:
  *	The return value is a pointer to the topmost item that is close to
@@ -5719,7 +7482,6 @@ CanvasFindClosest(
 				 * coordinates.) */
 {
     Tk_PathItem *itemPtr;
-    Tk_PathItem *bestPtr;
     int x1, y1, x2, y2;
 
     x1 = (int) (coords[0] - canvasPtr->closeEnough);
@@ -5727,9 +7489,16 @@ CanvasFindClosest(
     x2 = (int) (coords[0] + canvasPtr->closeEnough);
     y2 = (int) (coords[1] + canvasPtr->closeEnough);
 
-    bestPtr = NULL;
-    for (itemPtr = canvasPtr->rootItemPtr; itemPtr != NULL;
-	    itemPtr = TkPathCanvasItemIteratorNext(itemPtr)) {
+    /*
+     * The topmost item is the last one in iterator order, that is, the
+     * deepest last child of the root.
+     */
+
+    itemPtr = canvasPtr->rootItemPtr;
+    while (itemPtr->lastChildPtr != NULL) {
+	itemPtr = itemPtr->lastChildPtr;
+    }
+    for (; itemPtr != NULL; itemPtr = TkPathCanvasItemIteratorPrev(itemPtr)) {
 	if (itemPtr->state == TK_PATHSTATE_HIDDEN || itemPtr->state==TK_PATHSTATE_DISABLED ||
 		(itemPtr->state == TK_PATHSTATE_NULL && (canvasPtr->canvas_state == TK_PATHSTATE_HIDDEN ||
 		canvasPtr->canvas_state == TK_PATHSTATE_DISABLED))) {
@@ -5739,13 +7508,141 @@ CanvasFindClosest(
 		|| (itemPtr->y1 > y2) || (itemPtr->y2 < y1)) {
 	    continue;
 	}
+	HIT_STATS(canvasPtr);
 	if ((*itemPtr->typePtr->pointProc)((Tk_PathCanvas) canvasPtr,
 		itemPtr, coords) <= canvasPtr->closeEnough) {
-	    bestPtr = itemPtr;
+	    return itemPtr;
 	}
     }
-    return bestPtr;
+    return NULL;
+}
+
+#ifndef USE_OLD_TAG_SEARCH
+/*
+ *--------------------------------------------------------------
+ *
+ * FreeTagExprMatches --
+ *
+ *	Frees the binding expression matches of an item.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Memory is freed.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+FreeTagExprMatches(
+    TagExprMatches *matchesPtr)
+{
+    if (matchesPtr->tags != NULL) {
+	ckfree((char *) matchesPtr->tags);
+    }
+    ckfree((char *) matchesPtr);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * GetTagExprMatches --
+ *
+ *	Returns the binding expressions that match the tags of an item.
+ *	They are kept per item and only evaluated again when the item's
+ *	tags or the set of expressions has changed. The "current" tag is
+ *	left out of the comparison unless a binding expression uses it,
+ *	since it comes and goes with the mouse.
+ *
+ * Results:
+ *	The matches of itemPtr, owned by the canvas.
+ *
+ * Side effects:
+ *	The matches may be made or remade.
+ *
+ *--------------------------------------------------------------
+ */
+
+static TagExprMatches *
+GetTagExprMatches(
+    TkPathCanvas *canvasPtr,
+    Tk_PathItem *itemPtr)
+{
+    Tcl_HashEntry *hPtr;
+    TagExprMatches *matchesPtr;
+    TagSearchExpr *expr;
+    Tk_PathTags *ptagsPtr = itemPtr->pathTagsPtr;
+    Tk_Uid currentUid = GetStaticUids()->currentUid;
+    int isNew, numExprs, numTags, i, j;
+
+    numTags = (ptagsPtr != NULL) ? ptagsPtr->numTags : 0;
+    hPtr = Tcl_CreateHashEntry(&canvasPtr->exprMatchTable,
+	    (char *) INT2PTR(itemPtr->id), &isNew);
+    if (!isNew) {
+	matchesPtr = (TagExprMatches *) Tcl_GetHashValue(hPtr);
+	if (matchesPtr->bindExprGen == canvasPtr->bindExprGen) {
+	    for (i = 0, j = 0; i < numTags; i++) {
+		if (!canvasPtr->bindExprCurrent
+			&& (ptagsPtr->tagPtr[i] == currentUid)) {
+		    continue;
+		}
+		if ((j >= matchesPtr->numTags)
+			|| (matchesPtr->tags[j] != ptagsPtr->tagPtr[i])) {
+		    break;
+		}
+		j++;
+	    }
+	    if ((i == numTags) && (j == matchesPtr->numTags)) {
+		return matchesPtr;
+	    }
+	}
+    } else {
+	matchesPtr = NULL;
+    }
+
+    numExprs = 0;
+    for (expr = canvasPtr->bindTagExprs; expr != NULL; expr = expr->next) {
+	numExprs++;
+    }
+    if ((matchesPtr == NULL) || (matchesPtr->space < numExprs)) {
+	if (matchesPtr != NULL) {
+	    FreeTagExprMatches(matchesPtr);
+	}
+	matchesPtr = (TagExprMatches *) ckalloc((unsigned)
+		(sizeof(TagExprMatches) + (numExprs-1) * sizeof(Tk_Uid)));
+	matchesPtr->space = numExprs;
+	matchesPtr->tags = NULL;
+	matchesPtr->tagSpace = 0;
+	Tcl_SetHashValue(hPtr, matchesPtr);
+    }
+    if (matchesPtr->tagSpace < numTags) {
+	if (matchesPtr->tags != NULL) {
+	    ckfree((char *) matchesPtr->tags);
+	}
+	matchesPtr->tags = (Tk_Uid *) ckalloc((unsigned)
+		(numTags * sizeof(Tk_Uid)));
+	matchesPtr->tagSpace = numTags;
+    }
+    matchesPtr->numTags = 0;
+    for (i = 0; i < numTags; i++) {
+	if (canvasPtr->bindExprCurrent
+		|| (ptagsPtr->tagPtr[i] != currentUid)) {
+	    matchesPtr->tags[matchesPtr->numTags++] = ptagsPtr->tagPtr[i];
+	}
+    }
+    matchesPtr->bindExprGen = canvasPtr->bindExprGen;
+    matchesPtr->numMatches = 0;
+    for (expr = canvasPtr->bindTagExprs; expr != NULL; expr = expr->next) {
+	expr->index = 0;
+	expr->match = TagSearchEvalExpr(expr, itemPtr);
+	if (expr->match) {
+	    matchesPtr->uids[matchesPtr->numMatches++] = expr->uid;
+	}
+    }
+    return matchesPtr;
 }
+#endif /* not USE_OLD_TAG_SEARCH */
 
 /*
  *--------------------------------------------------------------
@@ -5780,7 +7677,7 @@ CanvasDoEvent(
     Tk_PathItem *itemPtr;
     Tk_PathTags *ptagsPtr;
 #ifndef USE_OLD_TAG_SEARCH
-    TagSearchExpr *expr;
+    TagExprMatches *matchesPtr;
     int numExprs;
     SearchUids *searchUids = GetStaticUids();
 #endif /* not USE_OLD_TAG_SEARCH */
@@ -5823,18 +7720,16 @@ CanvasDoEvent(
      */
 
     /*
-     * Flag and count all expressions that match item's tags.
+     * Find the expressions that match item's tags, reusing those from
+     * the last event on the item if neither its tags nor the bindings
+     * changed since.
      */
 
+    matchesPtr = NULL;
     numExprs = 0;
-    expr = canvasPtr->bindTagExprs;
-    while (expr) {
-	expr->index = 0;
-    	expr->match = TagSearchEvalExpr(expr, itemPtr);
-	if (expr->match) {
-	    numExprs++;
-	}
-	expr = expr->next;
+    if (canvasPtr->bindTagExprs != NULL) {
+	matchesPtr = GetTagExprMatches(canvasPtr, itemPtr);
+	numExprs = matchesPtr->numMatches;
     }
     numObjects = numTags + numExprs + 2;
 
@@ -5864,13 +7759,8 @@ CanvasDoEvent(
      * Copy uids of matching expressions into object array
      */
 
-    i = numTags + 2;
-    expr = canvasPtr->bindTagExprs;
-    while (expr) {
-    	if (expr->match) {
-	    objectPtr[i++] = (int *) expr->uid;
-	}
-	expr = expr->next;
+    for (i = 0; i < numExprs; i++) {
+	objectPtr[numTags + 2 + i] = (ClientData) matchesPtr->uids[i];
     }
 #endif /* not USE_OLD_TAG_SEARCH */
 
@@ -5976,10 +7866,7 @@ CanvasFocusProc(
     }
     if (canvasPtr->highlightWidth > 0) {
 	canvasPtr->flags |= REDRAW_BORDERS;
-	if (!(canvasPtr->flags & REDRAW_PENDING)) {
-	    Tcl_DoWhenIdle(DisplayCanvas, (ClientData) canvasPtr);
-	    canvasPtr->flags |= REDRAW_PENDING;
-	}
+	ScheduleRedraw(canvasPtr);
     }
 }
 
@@ -38,8 +38,85 @@ struct TagSearchExpr_s {
     int match;			/* This expression matches event's item's
 				 * tags. */
 };
+
+/*
+ * The binding expressions that matched an item the last time it got an
+ * event. Valid while the item's tags and the canvas' bindExprGen are
+ * the same as when it was made; the tags are kept here to tell.
+ */
+
+typedef struct TagExprMatches {
+    Tk_Uid *tags;		/* Copy of the item's tags, without "current"
+				 * unless a binding expression uses it. */
+    int numTags;
+    int tagSpace;		/* Number of slots in tags. */
+    int bindExprGen;
+    int numMatches;
+    int space;			/* Number of slots in uids. */
+    Tk_Uid uids[1];		/* The uids of the matching expressions;
+				 * actually space long. */
+} TagExprMatches;
 #endif /* not USE_OLD_TAG_SEARCH */
 
+/*
+ * Render statistics of a canvas, see tkCanvStats.c. They are only
+ * collected while the stats command has them enabled.
+ */
+
+#define TK_PATH_STATS_FRAMES	16
+
+typedef struct TkPathStatsTime {
+    int count;			/* Number of calls. */
+    Tcl_WideInt usec;		/* Total time spent in them. */
+} TkPathStatsTime;
+
+typedef struct TkPathStatsFrame {
+    int visited;		/* Items looked at by DisplayCanvas. */
+    int drawn;			/* Items whose displayProc was called. */
+    Tcl_WideInt pixels;		/* Area repainted. */
+    Tcl_WideInt usec;		/* Time for the whole redraw. */
+} TkPathStatsFrame;
+
+typedef struct TkPathCanvasStats {
+    TkPathStatsFrame frames[TK_PATH_STATS_FRAMES];
+				/* The last frames drawn, a ring indexed
+				 * by numFrames. */
+    int numFrames;		/* Frames drawn since the last reset. */
+    Tcl_Time frameStart;	/* When the frame being drawn began. */
+    Tcl_HashTable typeTable;	/* Tk_PathItemType* -> TkPathStatsTime of its
+				 * displayProc. */
+    TkPathStatsTime context;	/* Time in TkPathInit and TkPathFree. */
+    int pixmaps;		/* Pixmaps allocated for drawing. */
+    int picks;			/* Calls to PickCurrentItem. */
+    int hitTests;		/* pointProc and areaProc calls of picks,
+				 * find, addtag and distance. */
+    int searches;		/* Tag searches that had to scan items. */
+    Tcl_WideInt scanned;	/* Items scanned by those searches. */
+} TkPathCanvasStats;
+
+/*
+ * Running animations of the animate command, opaque outside
+ * tkCanvAnimate.c.
+ */
+
+typedef struct TkPathAnimation TkPathAnimation;
+
+/*
+ * Path geometry defined once with the symbol command and drawn by any
+ * number of use items, see tkCanvUse.c.
+ */
+
+typedef struct TkPathSymbol {
+    Tcl_Obj *pathObj;		/* The path spec it was made from. */
+    PathAtom *atomPtr;		/* The atoms shared by all use items. */
+    int pathLen;		/* Length of the path spec. */
+    int maxNumSegments;		/* Max segments in a subpath, for hit tests. */
+    PathRect bbox;		/* Bare bbox of the atoms. */
+    struct PathPolys *polysPtr;	/* The atoms as polygons for hit tests,
+				 * made when first needed. */
+    int refCount;		/* Use items, plus one while it is named. */
+} TkPathSymbol;
+
 /*
  * The record below describes a canvas widget. It is made available to the
  * item functions so they can access certain shared fields such as the overall
@@ -116,6 +193,26 @@ typedef struct TkPathCanvas {
 				/* Timer handler used to blink cursor on and
 				 * off. */
 
+    /*
+     * Information used for frame pacing:
+     */
+
+    int maxFps;			/* Most redraws per second, or 0 to redraw
+				 * whenever idle. */
+    Tcl_TimerToken frameTimer;	/* Timer handler that starts the next frame
+				 * when redraws are paced, else NULL. */
+    Tcl_Time nextFrame;		/* Earliest time for the next paced redraw. */
+
+    /*
+     * Information used for the client side redraw buffer:
+     */
+
+    int shm;			/* Non-zero to render into a shared memory
+				 * image if the display allows it. */
+    struct TkPathBuffer_ *bufferPtr;
+				/* The buffer, NULL until first used. */
+    int bufferFailed;		/* Set if the display has no buffer. */
+
     /*
      * Transformation applied to canvas as a whole: to compute screen
      * coordinates (X,Y) from canvas coordinates (x,y), do the following:
@@ -133,6 +230,9 @@ typedef struct TkPathCanvas {
 				 * upper-left corner of the drawable where
 				 * items are actually being drawn (typically a
 				 * pixmap smaller than the whole window). */
+    double drawableScale;	/* Scale from canvas to drawable units for
+				 * path items; 1.0 except while a snapshot
+				 * is being rendered. */
 
     /*
      * Information used for event bindings associated with items.
@@ -236,9 +336,13 @@ typedef struct TkPathCanvas {
 				 * This defines the namespace for style names. */
     Tcl_HashTable gradientTable;/* Table for gradients. 
 				 * This defines the namespace for gradient names. */
+    Tcl_HashTable symbolTable;	/* Table for symbols drawn by use items;
+				 * see tkCanvUse.c. */
     int styleUid;		/* Running integer used to number style tokens. */
     int gradientUid;		/* Running integer used to number gradient tokens. */
     int tagStyle;
+    struct TkPathPool *itemPoolPtr;
+				/* Slab pool for the item records. */
     
     /*
      * Additional information, added by the 'dash'-patch
@@ -252,7 +356,20 @@ typedef struct TkPathCanvas {
 #ifndef USE_OLD_TAG_SEARCH
     TagSearchExpr *bindTagExprs;/* Linked list of tag expressions used in
 				 * bindings. */
+    int bindExprGen;		/* Changed each time an expression is added
+				 * to bindTagExprs. */
+    int bindExprCurrent;	/* Non-zero if any of bindTagExprs uses the
+				 * "current" tag. */
+    Tcl_HashTable exprMatchTable;
+				/* Maps item id's to their TagExprMatches. */
+    Tcl_HashTable exprCacheTable;
+				/* Maps expression uids to their compiled
+				 * TagSearchExpr. */
 #endif
+    TkPathCanvasStats *statsPtr;/* Render statistics, NULL unless enabled
+				 * with the stats command. */
+    TkPathAnimation *animPtr;	/* Running animations, newest first. */
+    Tcl_TimerToken animTimer;	/* Timer handler stepping the animations. */
 } TkPathCanvas;
 
 /*
@@ -302,9 +419,12 @@ typedef struct TkPathCanvas {
  *				are not yet registered using
  *				Tk_PathCanvasEventuallyRedraw(). It should still
  *				be done by the general canvas code.
+ * DELETE_PENDING -		Item matched a delete command and is about
+ *				to be deleted.
  */
 
 #define FORCE_REDRAW		8
+#define DELETE_PENDING		16
 
 /*
  * This is an extended item record that is used for the new
@@ -316,10 +436,12 @@ typedef struct Tk_PathItemEx  {
     Tk_PathItem header;	    /* Generic stuff that's the same for all
                              * types.  MUST BE FIRST IN STRUCTURE. */
     Tk_PathCanvas canvas;   /* Canvas containing item. */
-    Tk_PathStyle style;	    /* Contains most drawing info. */
     Tcl_Obj *styleObj;	    /* Object with style name. */
     TkPathStyleInst *styleInst;
 			    /* The referenced style instance from styleObj. */
+    Tk_PathStyle style;	    /* Contains most drawing info.
+			     * Must come after the fields shared with
+			     * Tk_PathItemLight. */
 
     /*
      *------------------------------------------------------------------
@@ -331,6 +453,31 @@ typedef struct Tk_PathItemEx  {
      */
 } Tk_PathItemEx;
 
+/*
+ * Lightweight items have no style options of their own but only a
+ * reference to a named style. Their record is the same as the start of
+ * Tk_PathItemEx, so code that only deals with the canvas and the style
+ * reference can handle both. Their item types have the bit below set
+ * in the flags field.
+ */
+
+typedef struct Tk_PathItemLight  {
+    Tk_PathItem header;	    /* Generic stuff that's the same for all
+                             * types.  MUST BE FIRST IN STRUCTURE. */
+    Tk_PathCanvas canvas;   /* Canvas containing item. */
+    Tcl_Obj *styleObj;	    /* Object with style name. */
+    TkPathStyleInst *styleInst;
+			    /* The referenced style instance from styleObj. */
+} Tk_PathItemLight;
+
+#define TK_PATH_ITEMTYPE_LIGHT	    1
+#define TK_PATH_ITEMTYPE_BINARY_COORDS 2    /* Coords can be given as
+					     * -binary and a byte array
+					     * of doubles. */
+
+#define TkPathItemIsLight(itemPtr) \
+    ((itemPtr)->typePtr->flags & TK_PATH_ITEMTYPE_LIGHT)
+
 /*
  * Canvas-related functions that are shared among Tk modules but not exported
  * to the outside world:
@@ -338,6 +485,45 @@ typedef struct Tk_PathItemEx  {
 
 MODULE_SCOPE int	    TkCanvPostscriptCmd(TkPathCanvas *canvasPtr,
 				Tcl_Interp *interp, int objc, Tcl_Obj *const objv[]);
+MODULE_SCOPE int	    TkCanvSvgCmd(TkPathCanvas *canvasPtr,
+				Tcl_Interp *interp, int objc, Tcl_Obj *const objv[]);
+MODULE_SCOPE int	    TkPathCanvasAnimateCmd(TkPathCanvas *canvasPtr,
+				Tcl_Interp *interp, int objc, Tcl_Obj *const objv[]);
+MODULE_SCOPE void	    TkPathCanvasAnimateFree(TkPathCanvas *canvasPtr);
+MODULE_SCOPE void	    TkPathCanvasEventuallyRedrawItem(Tk_PathCanvas canvas,
+				Tk_PathItem *itemPtr);
+MODULE_SCOPE int	    TkPathCanvasFindWithTag(Tcl_Interp *interp,
+				TkPathCanvas *canvasPtr, Tcl_Obj *tagObj, Tcl_Obj *listObj);
+MODULE_SCOPE int	    TkPathCanvasCreateItem(Tcl_Interp *interp,
+				TkPathCanvas *canvasPtr, Tcl_Obj *typeObj, int id,
+				CONST char *coords, int numCoords,
+				int objc, Tcl_Obj *CONST objv[],
+				Tk_PathItem **itemPtrPtr);
+MODULE_SCOPE void	    TkPathCanvasDeleteItem(TkPathCanvas *canvasPtr,
+				Tk_PathItem *itemPtr);
+MODULE_SCOPE int	    TkPathCanvasLoadCmd(TkPathCanvas *canvasPtr,
+				Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]);
+MODULE_SCOPE int	    TkPathCanvasSaveCmd(TkPathCanvas *canvasPtr,
+				Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]);
+MODULE_SCOPE int	    TkPathCanvasSymbolCreate(Tcl_Interp *interp,
+				TkPathCanvas *canvasPtr, CONST char *name,
+				Tcl_Obj *pathObj);
+MODULE_SCOPE int	    TkPathCanvasSymbolCmd(TkPathCanvas *canvasPtr,
+				Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]);
+MODULE_SCOPE void	    TkPathCanvasSymbolsFree(TkPathCanvas *canvasPtr);
+MODULE_SCOPE int	    TkPathCanvasStatsCmd(TkPathCanvas *canvasPtr,
+				Tcl_Interp *interp, int objc, Tcl_Obj *const objv[]);
+MODULE_SCOPE void	    TkPathCanvasStatsFree(TkPathCanvas *canvasPtr);
+MODULE_SCOPE void	    TkPathStatsBeginFrame(TkPathCanvas *canvasPtr);
+MODULE_SCOPE void	    TkPathStatsEndFrame(TkPathCanvas *canvasPtr,
+				int visited, int drawn, Tcl_WideInt pixels);
+MODULE_SCOPE void	    TkPathStatsAddTime(TkPathStatsTime *timePtr,
+				Tcl_Time *startPtr);
+MODULE_SCOPE TkPathStatsTime * TkPathStatsTypeTime(TkPathCanvasStats *statsPtr,
+				Tk_PathItemType *typePtr);
+MODULE_SCOPE int	    TkPathCanvasIsPathItem(Tk_PathItem *itemPtr);
+MODULE_SCOPE int	    TkPathCanvasGetRegion(Tcl_Interp *interp,
+				TkPathCanvas *canvasPtr, Tcl_Obj *regionObj, int region[4]);
 MODULE_SCOPE int	    TkPathCanvTranslatePath(TkPathCanvas *canvPtr,
 				int numVertex, double *coordPtr, int closed,
 				XPoint *outPtr);
@@ -357,10 +543,15 @@ MODULE_SCOPE void	    TkPathCanvasGroupBbox(Tk_PathCanvas canvas, Tk_PathItem *i
 				int *x1Ptr, int *y1Ptr, int *x2Ptr, int *y2Ptr);
 MODULE_SCOPE void	    TkPathCanvasUpdateGroupBbox(Tk_PathCanvas canvas, Tk_PathItem *itemPtr);
 MODULE_SCOPE void	    TkPathCanvasSetGroupDirtyBbox(Tk_PathItem *itemPtr);
+MODULE_SCOPE void	    TkPathCanvasGroupChildChanged(Tk_PathItem *itemPtr);
+MODULE_SCOPE void	    TkPathCanvasGroupChildRemoved(Tk_PathItem *itemPtr);
+MODULE_SCOPE int *	    TkPathCanvasGroupChildBbox(Tk_PathItem *itemPtr);
 MODULE_SCOPE Tk_PathItem *  TkPathCanvasItemIteratorNext(Tk_PathItem *itemPtr);
 MODULE_SCOPE Tk_PathItem *  TkPathCanvasItemIteratorPrev(Tk_PathItem *itemPtr);
 MODULE_SCOPE int	    TkPathCanvasItemExConfigure(Tcl_Interp *interp, Tk_PathCanvas canvas, 
 				    Tk_PathItemEx *itemExPtr, int mask);
+MODULE_SCOPE int	    TkPathCanvasItemLightConfigure(Tcl_Interp *interp, Tk_PathCanvas canvas, 
+				    Tk_PathItemLight *itemLightPtr, int mask);
 MODULE_SCOPE void	    TkPathCanvasItemDetach(Tk_PathItem *itemPtr);
 	
 MODULE_SCOPE void	    GroupItemConfigured(Tk_PathCanvas canvas, Tk_PathItem *itemPtr, int mask);
@@ -368,6 +559,8 @@ MODULE_SCOPE void	    CanvasTranslateGroup(Tk_PathCanvas canvas,
 				Tk_PathItem *itemPtr, double deltaX, double deltaY);
 MODULE_SCOPE void	    CanvasScaleGroup(Tk_PathCanvas canvas, Tk_PathItem *itemPtr,
 				double originX, double originY, double scaleX, double scaleY);
+MODULE_SCOPE int	    CanvasTransformGroup(Tk_PathCanvas canvas, 
+				Tk_PathItem *itemPtr, TMatrix *tPtr);
 MODULE_SCOPE int	    CanvasGradientObjCmd(Tcl_Interp* interp, TkPathCanvas *canvasPtr, 
 				int objc, Tcl_Obj* CONST objv[]);
 MODULE_SCOPE int	    CanvasStyleObjCmd(Tcl_Interp* interp, TkPathCanvas *canvasPtr, 
@@ -398,8 +591,14 @@ MODULE_SCOPE Tk_PathItemType tkPolylineType;
 MODULE_SCOPE Tk_PathItemType tkPpolygonType;
 MODULE_SCOPE Tk_PathItemType tkCircleType;
 MODULE_SCOPE Tk_PathItemType tkEllipseType;
+MODULE_SCOPE Tk_PathItemType tkCirclesType;
+MODULE_SCOPE Tk_PathItemType tkPrectsType;
+MODULE_SCOPE Tk_PathItemType tkLcircleType;
+MODULE_SCOPE Tk_PathItemType tkLrectType;
+MODULE_SCOPE Tk_PathItemType tkLlineType;
 MODULE_SCOPE Tk_PathItemType tkPimageType;
 MODULE_SCOPE Tk_PathItemType tkPtextType;
+MODULE_SCOPE Tk_PathItemType tkUseType;
 MODULE_SCOPE Tk_PathItemType tkGroupType;
 
 #endif /* _TKPCANVAS */
@@ -554,6 +554,39 @@ TkPathInit(Tk_Window tkwin, Drawable d)
     return (TkPathContext) context;
 }
 
+/*
+ * There is no client side buffer for canvas redraws here.
+ */
+
+TkPathBuffer *
+TkPathBufferNew(Tk_Window tkwin)
+{
+    return NULL;
+}
+
+int
+TkPathBufferBegin(TkPathBuffer *bufPtr, Drawable d, GC gc, int width, int height,
+        unsigned long background)
+{
+    return 0;
+}
+
+void
+TkPathBufferSync(TkPathBuffer *bufPtr)
+{
+}
+
+void
+TkPathBufferEnd(TkPathBuffer *bufPtr, Drawable dst, GC gc, int srcX, int srcY,
+        int width, int height, int dstX, int dstY)
+{
+}
+
+void
+TkPathBufferFree(TkPathBuffer *bufPtr)
+{
+}
+
 TkPathContext
 TkPathInitSurface(int width, int height)
 {
@@ -0,0 +1,200 @@
+# bench.tcl --
+#
+# Times common canvas operations and writes the results as JSON, one
+# object with an entry per benchmark, so runs of different releases can
+# be compared. Run it with "make bench" or directly with wish:
+#
+#	wish bench.tcl ?-match pattern? ?-out file? ?-scale factor?
+#
+# All drawing is done off-screen with the snapshot command and
+# surfaces, so the canvas never needs to be mapped; a display is still
+# needed by Tk, which may well be Xvfb. Random scenes use a fixed seed
+# to be the same for every run. The -scale factor multiplies the item
+# counts, for a quick run use something like 0.1.
+#
+# $Id$
+
+package require Tk
+package require tkpath 0.3.0
+
+namespace eval ::bench {
+    variable opts
+    array set opts {-match * -out {} -scale 1.0}
+    variable results {}
+    variable dir [file dirname [file normalize [info script]]]
+}
+
+# bench::run --
+#
+#	Times script, which is run iterations times after one warm up
+#	run, and records the mean time per iteration under name.
+
+proc ::bench::run {name iterations script} {
+    variable opts
+    variable results
+
+    if {![string match $opts(-match) $name]} {
+	return
+    }
+    uplevel 1 $script
+    set usec [lindex [uplevel 1 [list time $script $iterations]] 0]
+    lappend results $name [list $usec $iterations]
+    puts stderr [format "%-28s %12.1f usec" $name $usec]
+}
+
+# bench::count --
+#
+#	Scales an item count by the -scale option.
+
+proc ::bench::count {n} {
+    variable opts
+    return [expr {max(1, int($n * $opts(-scale)))}]
+}
+
+proc ::bench::randitems {w n} {
+    expr {srand(1)}
+    for {set i 0} {$i < $n} {incr i} {
+	set x [expr {800*rand()}]
+	set y [expr {800*rand()}]
+	set color [format "#%06x" [expr {int(0xffffff*rand())}]]
+	switch -- [expr {$i % 3}] {
+	    0 {
+		$w create pline $x $y [expr {$x+40*rand()}] [expr {$y+40*rand()}] \
+			-stroke $color -tags [list line t[expr {$i % 10}]]
+	    }
+	    1 {
+		$w create prect $x $y [expr {$x+20}] [expr {$y+20}] \
+			-fill $color -tags [list rect t[expr {$i % 10}]]
+	    }
+	    2 {
+		$w create circle $x $y -r 10 -fill $color -stroke black \
+			-tags [list circle t[expr {$i % 10}]]
+	    }
+	}
+    }
+}
+
+proc ::bench::json {results} {
+    set entries {}
+    foreach {name value} $results {
+	lassign $value usec iterations
+	lappend entries [format {    "%s": {"usec": %.1f, "iterations": %d}} \
+		$name $usec $iterations]
+    }
+    set json "\{\n"
+    append json [format {  "tkpath": "%s",} [package provide tkpath]] \n
+    append json [format {  "tcl": "%s",} [info patchlevel]] \n
+    append json [format {  "platform": "%s %s",} \
+	    $::tcl_platform(os) $::tcl_platform(machine)] \n
+    append json "  \"benchmarks\": \{\n" [join $entries ",\n"] "\n  \}\n\}"
+    return $json
+}
+
+proc ::bench::main {argv} {
+    variable opts
+    variable results
+    variable dir
+
+    array set opts $argv
+    wm withdraw .
+    set img [image create photo]
+
+    # Item creation.
+    set w [tkp::canvas .c -width 800 -height 800]
+    set n [count 10000]
+    run create-prect 1 {
+	for {set i 0} {$i < $n} {incr i} {
+	    $w create prect $i $i [expr {$i+10}] [expr {$i+10}] -fill red
+	}
+	$w delete all
+    }
+    run create-path 1 {
+	for {set i 0} {$i < $n} {incr i} {
+	    $w create path "M $i $i l 10 0 l 0 10 z" -fill blue
+	}
+	$w delete all
+    }
+    destroy $w
+
+    # Full redraw of the tiger, sourced as the demo makes it.
+    source [file join $dir .. demos tiger.tcl]
+    set w .c_tiger.c
+    wm withdraw .c_tiger
+    run redraw-tiger 20 {
+	$w snapshot -region {0 0 600 600} $img
+    }
+    destroy .c_tiger
+
+    foreach n [list [count 10000] [count 100000]] {
+	set w [tkp::canvas .c -width 800 -height 800]
+	randitems $w $n
+	run redraw-random-$n 3 {
+	    $w snapshot -region {0 0 800 800} $img
+	}
+	run find-withtag-$n 10 {
+	    $w find withtag t3
+	}
+	run find-expr-$n 10 {
+	    $w find withtag {rect && !t3}
+	}
+	run find-overlapping-$n 100 {
+	    $w find overlapping 300 300 340 340
+	}
+
+	destroy $w
+
+	# The pick is made from the current mouse position, so let
+	# synthetic motion events sweep across the scene. The canvas
+	# sits in a toplevel of its own; "." is withdrawn and would
+	# leave it unmapped.
+	toplevel .pick
+	set w [tkp::canvas .pick.c -width 800 -height 800]
+	randitems $w $n
+	pack $w
+	tkwait visibility $w
+	update
+	set x 0
+	run pick-motion-$n 200 {
+	    event generate $w <Motion> -x [incr x 3] -y [expr {($x * 7) % 800}]
+	    if {$x >= 800} {set x 0}
+	}
+	destroy .pick
+    }
+
+    # Replacing the coords of a large polyline.
+    set w [tkp::canvas .c]
+    set coords {}
+    for {set i 0} {$i < [count 20000]} {incr i} {
+	lappend coords [expr {$i % 800}] [expr {($i * 7) % 800}]
+    }
+    set id [$w create polyline $coords]
+    run coords-polyline 20 {
+	$w coords $id $coords
+    }
+    destroy $w
+
+    # Copying a surface to a photo.
+    set s [tkp::surface new 800 800]
+    expr {srand(1)}
+    for {set i 0} {$i < 500} {incr i} {
+	$s create circle [expr {800*rand()}] [expr {800*rand()}] -r 20 \
+		-fill [format "#%06x" [expr {int(0xffffff*rand())}]]
+    }
+    run surface-copy 20 {
+	$s copy $img
+    }
+    $s destroy
+
+    image delete $img
+    set json [json $results]
+    if {$opts(-out) eq ""} {
+	puts $json
+    } else {
+	set f [open $opts(-out) w]
+	puts $f $json
+	close $f
+    }
+}
+
+::bench::main $argv
+exit
@@ -18,6 +18,11 @@
 #include <cairo.h>
 #include <cairo-xlib.h>
 #include <tkUnixInt.h>
+#ifdef HAVE_XSHM
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <X11/extensions/XShm.h>
+#endif
 #include "tkIntPath.h"
 
 #define TINT_INT_CALCULATION
@@ -62,6 +67,51 @@ typedef struct TkPathContext_ {
                                  * 2: even integer width */
 } TkPathContext_;
 
+/*
+ * Client side buffer for canvas redraws, an image in MIT-SHM shared
+ * memory that Cairo renders into without any server round trips.
+ * What is in the buffer is put in the pixmap before other drawing is
+ * done there, and what is in the pixmap is read back before rendering
+ * again, so the order of items is kept when Tk items are mixed in.
+ */
+
+#ifdef HAVE_XSHM
+enum {
+    kPathBufferIdle,		/* No frame is drawn. */
+    kPathBufferCleared,		/* Pixmap has the background only. */
+    kPathBufferInPixmap,	/* Pixmap has the latest drawing. */
+    kPathBufferInImage		/* Image has the latest drawing. */
+};
+
+struct TkPathBuffer_ {
+    Display *display;
+    Visual *visual;
+    int depth;
+    XShmSegmentInfo shminfo;
+    size_t size;		/* Size of the segment, 0 if none. */
+    XImage *image;		/* Image of the current frame. */
+    cairo_surface_t *surface;	/* Surface on the image data. */
+    Drawable drawable;		/* Pixmap of the current frame. */
+    GC gc;			/* For putting the image in it. */
+    unsigned long background;
+    int state;
+    int pending;		/* Server may still read the segment. */
+};
+
+/*
+ * The buffer of the frame being drawn, whose pixmap TkPathInit renders
+ * into the image instead. Each thread draws its own canvases.
+ */
+
+typedef struct ThreadSpecificData {
+    TkPathBuffer *activePtr;
+} ThreadSpecificData;
+
+static Tcl_ThreadDataKey dataKey;
+
+static TkPathContext BufferInit(TkPathBuffer *bufPtr);
+#endif /* HAVE_XSHM */
+
 static void TkPathPrepareForStroke(TkPathContext ctx, Tk_PathStyle *style);
 
 void CairoSetFill(TkPathContext ctx, Tk_PathStyle *style)
@@ -94,10 +144,19 @@ TkPathContext TkPathInit(Tk_Window tkwin, Drawable d)
     //printf("TkPathInit(Tk_Window %p, Drawable %p)...\n", tkwin, d);
     cairo_t *c;
     cairo_surface_t *surface;
-    TkPathContext_ *context = (TkPathContext_ *) ckalloc((unsigned) (sizeof(TkPathContext_)));
+    TkPathContext_ *context;
     Window dummy;
     int x, y;
     unsigned int width, height, borderWidth, depth;
+#ifdef HAVE_XSHM
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+            Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    if ((tsdPtr->activePtr != NULL) && (tsdPtr->activePtr->drawable == d)) {
+        return BufferInit(tsdPtr->activePtr);
+    }
+#endif
+    context = (TkPathContext_ *) ckalloc((unsigned) (sizeof(TkPathContext_)));
 
     /* Find size of Drawable */
     XGetGeometry(Tk_Display(tkwin), d,
@@ -144,6 +203,265 @@ TkPathContext TkPathInitSurface(int width, int height)
     return (TkPathContext) context;
 }
 
+#ifdef HAVE_XSHM
+static int
+BufferErrorProc(ClientData clientData, XErrorEvent *errEventPtr)
+{
+    *((int *) clientData) = 1;
+    return 0;
+}
+
+static void
+BufferDetach(TkPathBuffer *bufPtr)
+{
+    if (bufPtr->size > 0) {
+        XShmDetach(bufPtr->display, &bufPtr->shminfo);
+        XSync(bufPtr->display, False);
+        shmdt(bufPtr->shminfo.shmaddr);
+        bufPtr->size = 0;
+        bufPtr->pending = 0;
+    }
+}
+
+/*
+ * Makes a segment of the given size and attaches it in the server.
+ * Attaching fails on remote displays even if they have the extension.
+ */
+
+static int
+BufferAttach(TkPathBuffer *bufPtr, size_t size)
+{
+    Tk_ErrorHandler handler;
+    int failed = 0;
+
+    bufPtr->shminfo.shmid = shmget(IPC_PRIVATE, size, IPC_CREAT | 0600);
+    if (bufPtr->shminfo.shmid < 0) {
+        return 0;
+    }
+    bufPtr->shminfo.shmaddr = (char *) shmat(bufPtr->shminfo.shmid, NULL, 0);
+    if (bufPtr->shminfo.shmaddr == (char *) -1) {
+        shmctl(bufPtr->shminfo.shmid, IPC_RMID, NULL);
+        return 0;
+    }
+    bufPtr->shminfo.readOnly = False;
+    handler = Tk_CreateErrorHandler(bufPtr->display, -1, -1, -1,
+            BufferErrorProc, (ClientData) &failed);
+    if (!XShmAttach(bufPtr->display, &bufPtr->shminfo)) {
+        failed = 1;
+    }
+    XSync(bufPtr->display, False);
+    Tk_DeleteErrorHandler(handler);
+
+    /* Removed as soon as both sides have detached. */
+    shmctl(bufPtr->shminfo.shmid, IPC_RMID, NULL);
+    if (failed) {
+        shmdt(bufPtr->shminfo.shmaddr);
+        return 0;
+    }
+    bufPtr->size = size;
+    return 1;
+}
+
+TkPathBuffer *
+TkPathBufferNew(Tk_Window tkwin)
+{
+    Display *display = Tk_Display(tkwin);
+    Visual *visual = Tk_Visual(tkwin);
+    int depth = Tk_Depth(tkwin);
+    int one = 1;
+    TkPathBuffer *bufPtr;
+
+    /*
+     * Cairo image formats are 32 bit native endian xRGB or ARGB pixels,
+     * the visual and server must use the same.
+     */
+    if (!XShmQueryExtension(display)
+            || (visual->class != TrueColor)
+            || ((depth != 24) && (depth != 32))
+            || (visual->red_mask != 0xFF0000)
+            || (visual->green_mask != 0xFF00)
+            || (visual->blue_mask != 0xFF)
+            || (ImageByteOrder(display) != (*((char *) &one) ? LSBFirst : MSBFirst))) {
+        return NULL;
+    }
+    bufPtr = (TkPathBuffer *) ckalloc(sizeof(TkPathBuffer));
+    memset(bufPtr, 0, sizeof(TkPathBuffer));
+    bufPtr->display = display;
+    bufPtr->visual = visual;
+    bufPtr->depth = depth;
+    bufPtr->state = kPathBufferIdle;
+    if (!BufferAttach(bufPtr, 256*256*4)) {
+        ckfree((char *) bufPtr);
+        return NULL;
+    }
+    return bufPtr;
+}
+
+int
+TkPathBufferBegin(TkPathBuffer *bufPtr, Drawable d, GC gc, int width, int height,
+        unsigned long background)
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+            Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    size_t size = (size_t) width * height * 4;
+    XImage *image;
+
+    if (size > bufPtr->size) {
+        BufferDetach(bufPtr);
+        if (!BufferAttach(bufPtr, size + size/4)) {
+            return 0;
+        }
+    }
+    image = XShmCreateImage(bufPtr->display, bufPtr->visual, bufPtr->depth,
+            ZPixmap, bufPtr->shminfo.shmaddr, &bufPtr->shminfo, width, height);
+    if (image == NULL) {
+        return 0;
+    }
+    if ((image->bits_per_pixel != 32)
+            || ((size_t) image->bytes_per_line * height > bufPtr->size)) {
+        image->data = NULL;
+        XDestroyImage(image);
+        return 0;
+    }
+    bufPtr->image = image;
+    bufPtr->surface = cairo_image_surface_create_for_data(
+            (unsigned char *) image->data,
+            (bufPtr->depth == 32) ? CAIRO_FORMAT_ARGB32 : CAIRO_FORMAT_RGB24,
+            width, height, image->bytes_per_line);
+    bufPtr->drawable = d;
+    bufPtr->gc = gc;
+    bufPtr->background = background;
+    bufPtr->state = kPathBufferCleared;
+    tsdPtr->activePtr = bufPtr;
+    return 1;
+}
+
+/*
+ * Makes a context that renders into the image of the current frame,
+ * bringing the image up to date first.
+ */
+
+static TkPathContext
+BufferInit(TkPathBuffer *bufPtr)
+{
+    TkPathContext_ *context = (TkPathContext_ *) ckalloc((unsigned) (sizeof(TkPathContext_)));
+    XImage *image = bufPtr->image;
+
+    if (bufPtr->state == kPathBufferCleared) {
+        unsigned int pixel = (unsigned int) bufPtr->background | 0xFF000000;
+        int i, j;
+
+        if (bufPtr->pending) {
+            XSync(bufPtr->display, False);
+            bufPtr->pending = 0;
+        }
+        for (j = 0; j < image->height; j++) {
+            unsigned int *row = (unsigned int *) (image->data + j*image->bytes_per_line);
+
+            for (i = 0; i < image->width; i++) {
+                row[i] = pixel;
+            }
+        }
+        cairo_surface_mark_dirty(bufPtr->surface);
+    } else if (bufPtr->state == kPathBufferInPixmap) {
+        XShmGetImage(bufPtr->display, bufPtr->drawable, image, 0, 0, AllPlanes);
+        bufPtr->pending = 0;
+        cairo_surface_mark_dirty(bufPtr->surface);
+    }
+    bufPtr->state = kPathBufferInImage;
+    context->c = cairo_create(bufPtr->surface);
+    context->surface = cairo_surface_reference(bufPtr->surface);
+    context->record = NULL;
+    context->widthCode = 0;
+    return (TkPathContext) context;
+}
+
+void
+TkPathBufferSync(TkPathBuffer *bufPtr)
+{
+    if (bufPtr->state == kPathBufferInImage) {
+        cairo_surface_flush(bufPtr->surface);
+        XShmPutImage(bufPtr->display, bufPtr->drawable, bufPtr->gc,
+                bufPtr->image, 0, 0, 0, 0,
+                bufPtr->image->width, bufPtr->image->height, False);
+        bufPtr->pending = 1;
+    }
+    if (bufPtr->state != kPathBufferIdle) {
+        bufPtr->state = kPathBufferInPixmap;
+    }
+}
+
+void
+TkPathBufferEnd(TkPathBuffer *bufPtr, Drawable dst, GC gc, int srcX, int srcY,
+        int width, int height, int dstX, int dstY)
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+            Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    if (bufPtr->state == kPathBufferInImage) {
+        cairo_surface_flush(bufPtr->surface);
+        XShmPutImage(bufPtr->display, dst, gc, bufPtr->image,
+                srcX, srcY, dstX, dstY, width, height, False);
+        bufPtr->pending = 1;
+    } else {
+        XCopyArea(bufPtr->display, bufPtr->drawable, dst, gc,
+                srcX, srcY, width, height, dstX, dstY);
+    }
+    cairo_surface_destroy(bufPtr->surface);
+    bufPtr->surface = NULL;
+    bufPtr->image->data = NULL;
+    XDestroyImage(bufPtr->image);
+    bufPtr->image = NULL;
+    bufPtr->drawable = None;
+    bufPtr->state = kPathBufferIdle;
+    tsdPtr->activePtr = NULL;
+}
+
+void
+TkPathBufferFree(TkPathBuffer *bufPtr)
+{
+    if (bufPtr != NULL) {
+        BufferDetach(bufPtr);
+        ckfree((char *) bufPtr);
+    }
+}
+#else /* HAVE_XSHM */
+
+/*
+ * Without the shared memory extension there is no buffer and all
+ * drawing goes to the pixmap.
+ */
+
+TkPathBuffer *
+TkPathBufferNew(Tk_Window tkwin)
+{
+    return NULL;
+}
+
+int
+TkPathBufferBegin(TkPathBuffer *bufPtr, Drawable d, GC gc, int width, int height,
+        unsigned long background)
+{
+    return 0;
+}
+
+void
+TkPathBufferSync(TkPathBuffer *bufPtr)
+{
+}
+
+void
+TkPathBufferEnd(TkPathBuffer *bufPtr, Drawable dst, GC gc, int srcX, int srcY,
+        int width, int height, int dstX, int dstY)
+{
+}
+
+void
+TkPathBufferFree(TkPathBuffer *bufPtr)
+{
+}
+#endif /* HAVE_XSHM */
+
 void TkPathPushTMatrix(TkPathContext ctx, TMatrix *m)
 {
     TkPathContext_ *context = (TkPathContext_ *) ctx;
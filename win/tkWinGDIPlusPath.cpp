@@ -219,6 +219,10 @@ inline void PathC::RestoreState()
 
 inline void PathC::BeginPath(Tk_PathStyle *style)
 {
+    /* A context may build several paths, e.g. a line and its arrows. */
+    if (mPath) {
+        delete mPath;
+    }
     mPath = new GraphicsPath((style->fillRule == WindingRule) ? FillModeWinding : FillModeAlternate);
 }
 
@@ -823,6 +827,34 @@ TkPathContext TkPathInit(Tk_Window tkwin, Drawable d)
     return (TkPathContext) context;
 }
 
+/*
+ * There is no client side buffer for canvas redraws with GDI+.
+ */
+
+TkPathBuffer *TkPathBufferNew(Tk_Window tkwin)
+{
+    return NULL;
+}
+
+int TkPathBufferBegin(TkPathBuffer *bufPtr, Drawable d, GC gc, int width, int height,
+        unsigned long background)
+{
+    return 0;
+}
+
+void TkPathBufferSync(TkPathBuffer *bufPtr)
+{
+}
+
+void TkPathBufferEnd(TkPathBuffer *bufPtr, Drawable dst, GC gc, int srcX, int srcY,
+        int width, int height, int dstX, int dstY)
+{
+}
+
+void TkPathBufferFree(TkPathBuffer *bufPtr)
+{
+}
+
 TkPathContext TkPathInitSurface(int width, int height)
 {
     TkPathContext_ *context = reinterpret_cast<TkPathContext_ *> (ckalloc((unsigned) (sizeof(TkPathContext_))));